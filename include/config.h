@@ -136,6 +136,10 @@ public:
     bool eventOverlayEnabled;
     bool checkForUpdates;
     bool showProjectLoadingScreen;
+    bool preloadTilesets;
+    int mapPrefetchLimit;
+    int cacheMemoryLimit;
+    int tilesetEditorHistoryLimit;
     QDateTime lastUpdateCheckTime;
     QVersionNumber lastUpdateCheckVersion;
     QMap<QUrl, QDateTime> rateLimitTimes;
@@ -16,6 +16,10 @@ class Blockdata;
 class Event;
 class EventPixmapItem;
 class Editor;
+class QUndoStack;
+
+// Approximate number of bytes held by the commands in an edit history (mostly copies of block data).
+qint64 editHistoryMemoryUsage(const QUndoStack *history);
 
 enum CommandId {
     ID_PaintMetatile = 0,
@@ -68,6 +72,8 @@ public:
     bool mergeWith(const QUndoCommand *command) override;
     int id() const override { return CommandId::ID_PaintMetatile; }
 
+    qint64 memoryUsage() const;
+
 private:
     Layout *layout;
 
@@ -108,6 +114,8 @@ public:
     bool mergeWith(const QUndoCommand *) override { return false; };
     int id() const override { return CommandId::ID_PaintBorder; }
 
+    qint64 memoryUsage() const;
+
 private:
     Layout *layout;
 
@@ -197,6 +205,8 @@ public:
     bool mergeWith(const QUndoCommand *command) override;
     int id() const override { return CommandId::ID_ShiftMetatiles; }
 
+    qint64 memoryUsage() const;
+
 private:
     Layout *layout= nullptr;
 
@@ -223,6 +233,8 @@ public:
     bool mergeWith(const QUndoCommand *) override { return false; }
     int id() const override { return CommandId::ID_ResizeLayout; }
 
+    qint64 memoryUsage() const;
+
 private:
     Layout *layout = nullptr;
 
@@ -373,6 +385,8 @@ public:
     bool mergeWith(const QUndoCommand *) override { return false; }
     int id() const override { return CommandId::ID_ScriptEditLayout; }
 
+    qint64 memoryUsage() const;
+
 private:
     Layout *layout = nullptr;
 
@@ -128,6 +128,7 @@ public:
     virtual EventFrame *getEventFrame();
     virtual EventFrame *createEventFrame() = 0;
     void destroyEventFrame();
+    bool hasEventFrame() const { return !this->eventFrame.isNull(); }
 
     Event::Group getEventGroup() const { return this->eventGroup; }
     Event::Type getEventType() const { return this->eventType; }
@@ -0,0 +1,92 @@
+#pragma once
+#ifndef FILEWATCHER_H
+#define FILEWATCHER_H
+
+#include <QObject>
+#include <QFileSystemWatcher>
+#include <QFutureWatcher>
+#include <QDateTime>
+#include <QHash>
+#include <QSet>
+#include <QThreadPool>
+#include <QTimer>
+
+/*
+    FileWatcher monitors a set of files for changes to their contents, using as few system file watches as possible.
+
+    QFileSystemWatcher needs a system watch (an inotify watch on Linux) for every path it watches, and
+    large projects can exhaust the limit. FileWatcher instead only watches the directories of its files, which
+    catches files being replaced, created, or deleted (e.g. by git, or by editors that save to a temporary file).
+    When a directory changes, its files are compared against the size and modification time recorded for them.
+    If a watched directory is deleted, its nearest existing parent is watched until the directory is recreated.
+
+    Each file is hashed when it's added, and a changed file is only reported if its hash no longer matches.
+    Touching a file or checking out the same version of it is ignored. Hashing and checks run on a worker thread.
+
+    Notifications are collected for a short period and then checked all at once.
+    Each check emits at most one 'filesChanged' signal, so a large checkout produces a single notification.
+*/
+class FileWatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FileWatcher(QObject *parent = nullptr);
+    ~FileWatcher();
+
+    // The watcher shared by the project and its maps. It's created the first time it's needed.
+    static FileWatcher *instance();
+
+    // Files may be added more than once, and are watched until they've been removed as many times.
+    bool addFile(const QString &filepath);
+    bool removeFile(const QString &filepath);
+    bool isWatching(const QString &filepath) const { return m_files.contains(filepath); }
+    QStringList files() const { return m_files.keys(); }
+
+    int numWatchedFiles() const { return m_files.count(); }
+    int numWatchedDirectories() const { return m_dirs.count(); }
+    int numSystemWatches() const { return m_watcher.directories().count(); }
+
+    // How long to wait after a notification for more notifications before checking for changes.
+    void setDebounceInterval(int msecs) { m_debounceTimer.setInterval(msecs); }
+
+signals:
+    void filesChanged(const QStringList &filepaths);
+
+private:
+    struct FileState {
+        bool exists = false;
+        qint64 size = 0;
+        QDateTime lastModified;
+        QByteArray hash; // Empty until the file has been hashed on the worker thread
+    };
+    struct FileCheck {
+        QString filepath;
+        FileState state;
+        bool changed = false;
+    };
+
+    QFileSystemWatcher m_watcher;
+    QHash<QString, FileState> m_files;
+    QHash<QString, int> m_refCounts;
+    QHash<QString, QSet<QString>> m_dirs; // Directory -> watched files in that directory
+    QHash<QString, QSet<QString>> m_missingDirs; // Existing parent directory -> deleted directories below it
+    QSet<QString> m_pendingDirs;
+    QSet<QString> m_unhashedFiles;
+    QTimer m_debounceTimer;
+    QThreadPool m_checkPool;
+    QFutureWatcher<QList<FileCheck>> *m_check = nullptr;
+
+    static QString dirPath(const QString &filepath);
+    static FileState readState(const QString &filepath);
+    static QByteArray hashFile(const QString &filepath);
+    static QList<FileCheck> checkFiles(const QHash<QString, FileState> &files);
+
+    void recordDirectoryChange(const QString &dirpath);
+    void watchDirectory(const QString &dir);
+    void forgetMissingDirectory(const QString &dir);
+    void checkPendingChanges();
+    void finishCheck();
+};
+
+#endif // FILEWATCHER_H
@@ -47,6 +47,24 @@ public:
         head++;
     }
 
+    // Deletes the oldest commit, so it can no longer be undone. The remaining commits shift down by one,
+    // so index() is one lower afterwards (it still refers to the same commit). Fails if the oldest commit
+    // has been undone, because it's still needed to redo.
+    bool removeOldest() {
+        if (head < 0 || history.isEmpty()) {
+            return false;
+        }
+        delete history.takeFirst();
+        head--;
+        // If the saved state was before the removed commit it can no longer be reached.
+        saved = (saved >= 0) ? saved - 1 : -2;
+        return true;
+    }
+
+    T at(int i) const {
+        return history.at(i);
+    }
+
     T current() const {
         if (head < 0 || history.length() == 0) {
             return NULL;
@@ -4,6 +4,23 @@
 
 #include <QImage>
 #include <QString>
+#include <QIODevice>
+
+// The filter applied to each row of pixels before compression. See the PNG spec, section 9.
+// 'Adaptive' chooses the filter for each row that's likely to compress best.
+enum class PngRowFilter {
+    None = 0,
+    Sub = 1,
+    Up = 2,
+    Average = 3,
+    Paeth = 4,
+    Adaptive,
+};
+
+// Write an indexed image to 'device' as a PNG with a bit depth of 4.
+// 'compressionLevel' is 0-9, or -1 for the default level. Returns false if writing failed.
+// The image is filtered and compressed a batch of rows at a time, so memory use doesn't grow with the image's size.
+bool writeIndexed4BPPPng(const QImage &image, QIODevice *device, int compressionLevel = -1, PngRowFilter filter = PngRowFilter::None, QString *errorString = nullptr);
 
 void exportIndexed4BPPPng(QImage image, QString filepath);
 
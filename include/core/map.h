@@ -113,6 +113,8 @@ public:
     bool hasUnsavedChanges() const;
     void pruneEditHistory();
 
+    MemoryUsage memoryBreakdown() const;
+
     void setCustomAttributes(const QJsonObject &attributes) { m_customAttributes = attributes; }
     QJsonObject customAttributes() const { return m_customAttributes; }
 
@@ -149,7 +151,10 @@ private:
     QSet<MapConnection*> m_ownedConnections;
 
     QPointer<QUndoStack> m_editHistory;
-    QPointer<QFileSystemWatcher> m_scriptFileWatcher;
+    QString m_watchedScriptsFilepath;
+
+    void stopWatchingScripts();
+    void checkScriptsFileChanged(const QStringList &filepaths);
 
 signals:
     void modified();
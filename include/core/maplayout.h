@@ -4,10 +4,12 @@
 
 #include "blockdata.h"
 #include "tileset.h"
+#include "memoryusage.h"
 #include <QImage>
 #include <QPixmap>
 #include <QString>
 #include <QUndoStack>
+#include <QCache>
 
 class Map;
 class LayoutPixmapItem;
@@ -133,6 +135,21 @@ public:
     uint16_t getMetatileId(int x, int y) const;
     bool setMetatileId(int x, int y, uint16_t metatileId, bool enableScriptCallback = false);
 
+    // Positions of the blocks with the given metatile ID, or the given collision and elevation, in row order.
+    // These are answered from an index of the blockdata, which is built the first time it's needed and is
+    // then kept up to date by setBlock and setBlockdata. Code that modifies 'blockdata' directly without
+    // changing the layout's dimensions should call invalidateBlockIndex, which also marks every block as changed.
+    QList<QPoint> getMetatilePositions(uint16_t metatileId);
+    QList<QPoint> getCollisionPositions(uint16_t collision, uint16_t elevation);
+    void invalidateBlockIndex();
+
+    // setBlock and setBlockdata record the index of each block they change, so that views can redraw only those blocks.
+    // A view remembers 'blockChangeCount' when it draws, and next time asks for the blocks changed since then.
+    // getChangedBlocks returns false if those aren't known (e.g. every block was marked as changed), and everything should be redrawn.
+    quint64 blockChangeCount() const { return m_blockChangesStart + m_blockChanges.length(); }
+    bool getChangedBlocks(quint64 since, QVector<int> *changedBlocks) const;
+
+    void shiftBlocks(int xDelta, int yDelta);
     void adjustDimensions(const QMargins &margins, bool setNewBlockdata = true);
     void setDimensions(int newWidth, int newHeight, bool setNewBlockdata = true);
     void setBorderDimensions(int newWidth, int newHeight, bool setNewBlockdata = true, bool enableScriptCallback = false);
@@ -148,11 +165,17 @@ public:
     bool saveBorder(const QString &root);
     bool saveBlockdata(const QString &root);
 
-    bool loadBorder(const QString &root);
-    bool loadBlockdata(const QString &root);
+    // If the file contents were already read (e.g. in the background) they can be given to skip reading the file again.
+    bool loadBorder(const QString &root, const Blockdata *data = nullptr);
+    bool loadBlockdata(const QString &root, const Blockdata *data = nullptr);
+    static Blockdata readBlockdata(const QString &path, QString *error);
 
     bool layoutBlockChanged(int i, const Blockdata &curData, const Blockdata &cache);
 
+    qint64 memoryUsage() const;
+    MemoryUsage memoryBreakdown() const;
+    void unload();
+
     uint16_t getBorderMetatileId(int x, int y);
     void setBorderMetatileId(int x, int y, uint16_t metatileId, bool enableScriptCallback = false);
     void setBorderBlockData(Blockdata blockdata, bool enableScriptCallback = false);
@@ -165,6 +188,19 @@ public:
     QPixmap renderCollision(bool ignoreCache);
     QPixmap renderBorder(bool ignoreCache = false);
 
+    // Render only the given area of the layout (in metatile coordinates) to a new image.
+    // Unlike the functions above these don't touch the layout's full-size images or block caches.
+    QImage renderArea(const QRect &area, Layout *fromLayout = nullptr);
+    QImage renderCollisionArea(const QRect &area);
+
+    // Render a small preview of the layout, e.g. for icons. Large layouts are sampled rather than rendered in full,
+    // drawing at most 'maxMetatiles' metatiles along each side.
+    QImage renderThumbnail(int maxMetatiles = 16);
+
+    // Same as renderArea, but the image is kept until the area's blocks, the tilesets, or the metatile layer settings change.
+    // Map connections use this, because they're rendered again each time one of their maps is displayed.
+    QImage renderAreaCached(const QRect &area, Layout *fromLayout = nullptr);
+
     QPixmap getLayoutItemPixmap();
 
     void setLayoutItem(LayoutPixmapItem *item) { layoutItem = item; }
@@ -175,12 +211,44 @@ public:
 
 private:
     void setNewDimensionsBlockdata(int newWidth, int newHeight);
+    static Blockdata resizeBlockdata(const Blockdata &blocks, const QSize &oldSize, const QSize &newSize, const QPoint &offset = QPoint(0, 0));
     void setNewBorderDimensionsBlockdata(int newWidth, int newHeight);
     bool writeBlockdata(const QString &path, const Blockdata &blockdata) const;
-    static Blockdata readBlockdata(const QString &path, QString *error);
 
     static int getBorderDrawDistance(int dimension, qreal minimum);
 
+    Blockdata getAreaBlocks(const QRect &area) const;
+
+    // Sorted block indexes (into 'blockdata') for each metatile ID, and for each collision/elevation pair.
+    // Changed blocks are appended to 'added' and 'removed', and 'indexes' is only brought up to date the next
+    // time it's queried. This way changing many blocks with the same ID doesn't shift the list for each block.
+    struct BlockIndexEntry {
+        QVector<int> indexes;
+        QVector<int> added;
+        QVector<int> removed;
+    };
+    QHash<uint16_t, BlockIndexEntry> m_metatileIndex;
+    QHash<quint32, BlockIndexEntry> m_collisionIndex;
+    bool m_blockIndexValid = false;
+    static quint32 collisionIndexKey(uint16_t collision, uint16_t elevation) { return (static_cast<quint32>(collision) << 16) | elevation; }
+    bool updateBlockIndex();
+    void updateBlockIndex(int i, const Block &prevBlock, const Block &newBlock);
+    QList<QPoint> getIndexedPositions(BlockIndexEntry *entry) const;
+
+    QVector<int> m_blockChanges;
+    quint64 m_blockChangesStart = 0; // The change count of the first entry in 'm_blockChanges'
+    void recordBlockChange(int i);
+    void markAllBlocksChanged();
+
+    struct AreaRender {
+        QImage image;
+        Blockdata blocks;
+        QList<int> layerOrder;
+        QList<float> layerOpacity;
+    };
+    static constexpr int areaRenderCacheLimit = 8 * 1024; // KiB
+    QCache<QString, AreaRender> m_areaRenderCache{areaRenderCacheLimit};
+
     QList<int> m_metatileLayerOrder;
     QList<float> m_metatileLayerOpacity;
     static QList<int> s_globalMetatileLayerOrder;
@@ -0,0 +1,35 @@
+#pragma once
+#ifndef MEMORYUSAGE_H
+#define MEMORYUSAGE_H
+
+#include <QString>
+#include <QList>
+#include <QJsonObject>
+
+/*
+    An estimate of the memory retained by some part of the project, broken down by component.
+
+    The sizes are estimates of the data each object holds (block data, images, etc.), not exact heap usage.
+    They're meant for finding which layouts, tilesets, or caches are using the most memory.
+*/
+struct MemoryUsage {
+    QString name;
+    qint64 bytes = 0;     // Memory used by this entry itself, excluding its children
+    int count = -1;       // Number of items this entry represents, if applicable
+    QString note;
+    QList<MemoryUsage> children;
+
+    MemoryUsage() = default;
+    explicit MemoryUsage(const QString &name, qint64 bytes = 0, int count = -1)
+        : name(name), bytes(bytes), count(count) {}
+
+    // Adds a child entry and returns it so that it can be broken down further.
+    MemoryUsage &add(const QString &name, qint64 bytes, int count = -1);
+    MemoryUsage &add(const MemoryUsage &child);
+
+    qint64 total() const;
+    void sortBySize();
+    QJsonObject toJson() const;
+};
+
+#endif // MEMORYUSAGE_H
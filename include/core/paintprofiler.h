@@ -0,0 +1,83 @@
+#pragma once
+#ifndef PAINTPROFILER_H
+#define PAINTPROFILER_H
+
+#include <QString>
+#include <QList>
+#include <QJsonObject>
+#include <QElapsedTimer>
+
+/*
+    PaintProfiler measures how long it takes for an edit in the map view to appear on screen.
+
+    An interaction begins when the map view receives an input event, and ends when the map view
+    finishes its next repaint. The time in between is broken down into phases by placing a
+    PaintProfiler::Scope in the code for each phase. Scopes can be nested, and each phase is only
+    charged for the time not spent in the scopes nested inside it. Time that isn't covered by any scope
+    (e.g. waiting in the event loop for the repaint) is reported as 'Waiting'.
+
+    The most recent samples of each phase are kept, so the statistics reflect recent editing.
+    Profiling is disabled by default, and Scopes do nothing while it's disabled. Only the main thread is measured.
+*/
+class PaintProfiler
+{
+public:
+    enum class Phase {
+        Input,     // Handling the input event, excluding the other phases
+        Command,   // Applying edit commands
+        Render,    // Rendering layout images
+        Scripts,   // Running script callbacks
+        Repaint,   // Repainting the map view
+        Waiting,   // Time between handling the input and the repaint
+        Count,
+    };
+
+    struct Stats {
+        int count = 0;
+        double mean = 0; // All times are in milliseconds
+        double p50 = 0;
+        double p95 = 0;
+        double p99 = 0;
+        double max = 0;
+        QList<int> histogram; // Number of samples in each of 'histogramBounds()'
+    };
+
+    class Scope {
+    public:
+        explicit Scope(Phase phase);
+        ~Scope();
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        Phase phase;
+        bool active = false;
+        qint64 childNsecs = 0;
+        Scope *parent = nullptr;
+        QElapsedTimer timer;
+    };
+
+    static void setEnabled(bool enabled);
+    static bool isEnabled() { return s_enabled; }
+    static void reset();
+
+    static void beginInteraction();
+
+    static QString phaseName(Phase phase);
+    static QList<double> histogramBounds();
+    static Stats latencyStats();
+    static Stats phaseStats(Phase phase);
+    static Stats frameStats();
+    static int numInteractions();
+
+    static QJsonObject toJson();
+    static bool writeJson(const QString &filepath, QString *error = nullptr);
+
+private:
+    static bool s_enabled;
+
+    static void endScope(Phase phase, qint64 exclusiveNsecs, qint64 totalNsecs, bool outermost);
+    static void endInteraction();
+};
+
+#endif // PAINTPROFILER_H
@@ -0,0 +1,106 @@
+#pragma once
+#ifndef PROJECTVALIDATOR_H
+#define PROJECTVALIDATOR_H
+
+#include <QObject>
+#include <QFutureWatcher>
+#include <QJsonDocument>
+#include <QElapsedTimer>
+#include <memory>
+
+class Project;
+
+/*
+    ProjectValidator checks the whole project for broken references without opening any maps.
+
+    The project's parsed constants (map names, layouts, flags, vars, script labels, etc.) are copied when
+    the validator starts, and each map and layout file is then read and checked on a worker thread.
+    Warp destinations are checked against the other maps once every map has been read.
+
+    The files on disk are validated, so unsaved changes aren't included.
+*/
+class ProjectValidator : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Issue {
+        enum class Severity {
+            Warning,
+            Error,
+        };
+        Severity severity = Severity::Warning;
+        QString source;  // The name of the map or layout, or "Wild Encounters"
+        QString file;    // Filepath relative to the project root, if any
+        QString message;
+    };
+
+    explicit ProjectValidator(Project *project, QObject *parent = nullptr);
+    ~ProjectValidator();
+
+    void start();
+    void cancel();
+    bool isRunning() const { return m_watcher.isRunning(); }
+
+    QList<Issue> issues() const { return m_issues; }
+    int numErrors() const;
+    int numWarnings() const;
+    int numMapsChecked() const { return m_numMaps; }
+    int numLayoutsChecked() const { return m_numLayouts; }
+    qint64 elapsedMs() const { return m_elapsedMs; }
+
+    static QString severityToString(Issue::Severity severity);
+    QJsonDocument toJson() const;
+    bool writeJson(const QString &filepath, QString *error = nullptr) const;
+
+signals:
+    void progressChanged(int done, int total);
+    void finished();
+
+private:
+    // A copy of everything the worker threads need from the project. Workers never touch the project itself.
+    struct Snapshot;
+
+    struct Task {
+        enum class Kind {
+            Map,
+            Layout,
+            WildEncounters,
+        };
+        Kind kind;
+        QString name;
+        std::shared_ptr<const Snapshot> snapshot;
+    };
+
+    struct WarpReference {
+        QString destMap;
+        QString destWarpId;
+        int index;
+    };
+
+    struct TaskResult {
+        QList<Issue> issues;
+        QString mapName;
+        int numWarps = -1; // -1 if the map's file couldn't be read
+        QList<WarpReference> warps;
+    };
+
+    Project *m_project;
+    QFutureWatcher<TaskResult> m_watcher;
+    QElapsedTimer m_timer;
+    std::shared_ptr<const Snapshot> m_snapshot;
+    QList<Issue> m_issues;
+    int m_numMaps = 0;
+    int m_numLayouts = 0;
+    qint64 m_elapsedMs = 0;
+
+    std::shared_ptr<const Snapshot> takeSnapshot() const;
+    void finish();
+
+    static TaskResult runTask(const Task &task);
+    static TaskResult validateMap(const QString &mapName, const Snapshot &snapshot);
+    static TaskResult validateLayout(const QString &layoutId, const Snapshot &snapshot);
+    static TaskResult validateWildEncounters(const Snapshot &snapshot);
+};
+
+#endif // PROJECTVALIDATOR_H
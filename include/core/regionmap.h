@@ -78,6 +78,7 @@ public:
     shared_ptr<TilemapTile> getTile(int index);
     unsigned getTileId(int x, int y);
     shared_ptr<TilemapTile> getTile(int x, int y);
+    unsigned getTileValue(int index);
     bool squareHasMap(int index);
     QString squareMapSection(int index);
     void setSquareMapSection(int index, QString section);
@@ -89,6 +90,8 @@ public:
     void setTileId(int index, unsigned id);
     void setTile(int index, TilemapTile &tile);
     void setTileData(int index, unsigned id, bool hFlip, bool vFlip, int palette);
+    void setTileValue(int index, unsigned value);
+    unsigned tileValue(unsigned id, bool hFlip, bool vFlip, int palette);
     int getMapSquareIndex(int x, int y);
 
     QString getAlias() { return this->alias; }
@@ -181,11 +184,8 @@ private:
     QStringList layout_constants;
     QString layout_qualifiers;
 
-#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
-    QVector<shared_ptr<TilemapTile>> tilemap;
-#else
-    QList<shared_ptr<TilemapTile>> tilemap;
-#endif
+    // Each tile's value as it appears in the tilemap file, in the tilemap's format.
+    QVector<unsigned> tilemap;
 
     QStringList layout_layers;
     QString current_layer;
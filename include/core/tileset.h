@@ -4,9 +4,12 @@
 
 #include "metatile.h"
 #include "tile.h"
+#include "memoryusage.h"
 #include <QImage>
 #include <QHash>
 
+class QThreadPool;
+
 struct MetatileLabelPair {
     QString owned;
     QString shared;
@@ -59,7 +62,9 @@ public:
     static QString getExpectedDir(QString tilesetName, bool isSecondary);
     QString getExpectedDir();
 
-    bool load();
+    // If a 'pool' is given, the palettes and tiles image are decoded on it while the metatiles are read on the calling thread.
+    // Without one (e.g. when already running on a worker thread) everything is loaded on the calling thread.
+    bool load(QThreadPool *pool = nullptr);
     bool loadMetatiles();
     bool loadMetatileAttributes();
     bool loadTilesImage(QImage *importedImage = nullptr);
@@ -104,6 +109,15 @@ public:
     QSet<int> getUnusedColorIds(int paletteId, const Tileset *pairedTileset, const QSet<int> &searchColors = {}) const;
     QList<uint16_t> findMetatilesUsingColor(int paletteId, int colorId, const Tileset *pairedTileset) const;
 
+    bool hasUnsavedTilesImage() const { return m_hasUnsavedTilesImage; }
+    qint64 memoryUsage() const;
+    MemoryUsage memoryBreakdown() const;
+
+    // A number that's unique to the tileset's current tiles, metatiles, and palettes.
+    // Anything that modifies these outside of the Tileset's own functions should call markChanged.
+    quint64 revision() const { return m_revision; }
+    void markChanged();
+
     static constexpr int maxPalettes() { return 16; }
     static constexpr int numColorsPerPalette() { return 16; }
 
@@ -113,6 +127,9 @@ private:
     QList<QImage> m_tiles;
     QImage m_tilesImage;
     bool m_hasUnsavedTilesImage = false;
+    quint64 m_revision = nextRevision();
+
+    static quint64 nextRevision();
 };
 
 #endif // TILESET_H
@@ -5,6 +5,8 @@
 #include <QString>
 #include <QLineEdit>
 #include <QColorSpace>
+#include <QImage>
+#include <QPixmap>
 
 namespace Util {
     void numericalModeSort(QStringList &list);
@@ -20,6 +22,8 @@ namespace Util {
     void show(QWidget *w);
     QColorSpace toColorSpace(int colorSpaceInt);
     QString mkpath(const QString& dirPath);
+    qint64 memoryUsage(const QImage &image);
+    qint64 memoryUsage(const QPixmap &pixmap);
 }
 
 #endif // UTILITY_H
@@ -25,6 +25,7 @@
 #include "layoutpixmapitem.h"
 #include "settings.h"
 #include "gridsettings.h"
+#include "mapgrid.h"
 #include "movablerect.h"
 #include "cursortilerect.h"
 #include "mapruler.h"
@@ -116,6 +117,7 @@ public:
     void duplicateSelectedEvents();
     void redrawAllEvents();
     void redrawEvents(const QList<Event*> &events);
+    void redrawDefaultSpriteEvents(const QStringList &gfxNames);
     void redrawEventPixmapItem(EventPixmapItem *item);
     void updateEventPixmapItemZValue(EventPixmapItem *item);
     qreal getEventOpacity(const Event *event) const;
@@ -140,7 +142,7 @@ public:
     QGraphicsItemGroup *events_group = nullptr;
 
     QList<QGraphicsPixmapItem*> borderItems;
-    QGraphicsItemGroup *mapGrid = nullptr;
+    MapGrid *mapGrid = nullptr;
     QPointer<MapRuler> map_ruler = nullptr;
 
     MovableRect *playerViewRect = nullptr;
@@ -177,6 +179,7 @@ public:
     int scaleIndex = 2;
     qreal collisionOpacity = 0.5;
     static QList<QList<const QImage*>> collisionIcons;
+    static QImage collisionAtlas;
 
     int eventShiftActionId = 0;
     int eventMoveActionId = 0;
@@ -243,6 +246,7 @@ private:
     void updateBorderVisibility();
     void removeConnectionPixmap(MapConnection *connection);
     void displayConnection(MapConnection *connection);
+    void updateDisplayedLayouts();
     void displayDivingConnection(MapConnection *connection);
     void removeDivingMapPixmap(MapConnection *connection);
     void onDivingMapEditingFinished(NoScrollComboBox* combo, const QString &direction);
@@ -23,7 +23,25 @@ void logError(const QString &message);
 void log(const QString &message, LogType type);
 QString getLogPath();
 QString getMostRecentError();
+void flushLog();
 void addLogStatusBar(QStatusBar *statusBar, const QSet<LogType> &types = {});
 bool removeLogStatusBar(QStatusBar *statusBar);
 
+// While a LogCapture exists, messages logged on the thread that created it are counted and discarded rather than logged.
+// This is used to load data speculatively (e.g. prefetching maps), where any problems should only be reported
+// if the data is loaded again because the user needs it.
+class LogCapture
+{
+public:
+    LogCapture();
+    ~LogCapture();
+    int numMessages() const { return m_numMessages; }
+
+private:
+    LogCapture *m_previous;
+    int m_numMessages = 0;
+
+    friend bool captureLogMessage();
+};
+
 #endif // LOG_H
@@ -11,6 +11,7 @@
 #include <QGraphicsSceneMouseEvent>
 #include <QCloseEvent>
 #include <QAbstractItemModel>
+#include <QTimer>
 #include "project.h"
 #include "orderedjson.h"
 #include "config.h"
@@ -35,6 +36,8 @@
 #include "message.h"
 #include "resizelayoutpopup.h"
 #include "unlockableicon.h"
+#include "projectvalidatordialog.h"
+#include "memoryinspector.h"
 
 #if __has_include(<QJSValue>)
 #include <QJSValue>
@@ -211,6 +214,8 @@ private slots:
     void onNewLayoutCreated(Layout *layout);
     void onNewTilesetCreated(Tileset *tileset);
     void onMapLoaded(Map *map);
+    void onLayoutUnloaded(const QString &layoutId);
+    void updateCacheStatus();
     void onMapRulerStatusChanged(const QString &);
     void applyUserShortcuts();
     void markMapEdited(Map*);
@@ -295,6 +300,8 @@ private slots:
     void on_spinBox_SelectedElevation_valueChanged(int elevation);
     void on_spinBox_SelectedCollision_valueChanged(int collision);
     void on_actionRegion_Map_Editor_triggered();
+    void on_actionValidate_Project_triggered();
+    void on_actionMemory_Usage_triggered();
     void on_actionPreferences_triggered();
     void on_actionOpen_Manual_triggered();
     void on_actionCheck_for_Updates_triggered();
@@ -303,6 +310,8 @@ private slots:
     void on_actionCustom_Scripts_triggered();
     void reloadScriptEngine();
     void on_actionShow_Grid_triggered();
+    void on_actionShow_Paint_Latency_toggled(bool enabled);
+    void on_actionExport_Paint_Latency_Report_triggered();
     void on_actionGrid_Settings_triggered();
     void openWildMonTable(const QString &mapName, const QString &groupName, const QString &fieldName);
 
@@ -316,6 +325,7 @@ signals:
 
 private:
     QLabel *label_MapRulerStatus = nullptr;
+    QLabel *label_CacheStatus = nullptr;
     QPointer<TilesetEditor> tilesetEditor = nullptr;
     QPointer<RegionMapEditor> regionMapEditor = nullptr;
     QPointer<ShortcutsEditor> shortcutsEditor = nullptr;
@@ -340,6 +350,8 @@ private:
     QPointer<AboutPorymap> aboutWindow = nullptr;
     QPointer<WildMonChart> wildMonChart = nullptr;
     QPointer<WildMonSearch> wildMonSearch = nullptr;
+    QPointer<ProjectValidatorDialog> projectValidatorDialog = nullptr;
+    QPointer<MemoryInspector> memoryInspector = nullptr;
     QPointer<QuestionMessage> fileWatcherWarning = nullptr;
     QPointer<ResizeLayoutPopup> resizeLayoutPopup = nullptr;
 
@@ -356,6 +368,7 @@ private:
     bool ignoreNavigationRecords = false;
 
     UnlockableIcon unlockableMainTabIcon;
+    QTimer mapTabIconTimer;
 
     QAction *copyAction = nullptr;
     QAction *pasteAction = nullptr;
@@ -429,6 +442,7 @@ private:
     void setEditActionUi(Editor::EditAction editAction);
 
     void updateWindowTitle();
+    void updateMapTabIcon();
 
     void initWindow();
     void initLogStatusBar();
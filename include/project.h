@@ -8,6 +8,7 @@
 #include "parseutil.h"
 #include "orderedjson.h"
 #include "regionmap.h"
+#include "filewatcher.h"
 
 #include <QStringList>
 #include <QList>
@@ -16,6 +17,11 @@
 #include <QStandardItem>
 #include <QVariant>
 #include <QFileSystemWatcher>
+#include <QFutureWatcher>
+#include <QThreadPool>
+#include <QCache>
+#include <QStringListModel>
+#include <QDateTime>
 
 class Project : public QObject
 {
@@ -70,6 +76,8 @@ public:
     void setRoot(const QString&);
 
     const QStringList& mapNames() const { return this->alphabeticalMapNames; }
+    QStringListModel *getStringListModel(const QString &key, const QStringList &items);
+    void updateStringListModel(const QString &key, const QStringList &items);
     QStringList getMapNamesByGroup() const;
     bool isKnownMap(const QString &mapName) const { return this->maps.contains(mapName); }
     bool isErroredMap(const QString &mapName) const { return this->erroredMaps.contains(mapName); }
@@ -84,6 +92,7 @@ public:
     const QStringList& layoutIdsOrdered() const { return this->orderedLayoutIds; }
     bool isKnownLayout(const QString &layoutId) const { return this->mapLayouts.contains(layoutId); }
     bool isLoadedLayout(const QString &layoutId) const { return this->loadedLayoutIds.contains(layoutId); }
+    int numLoadedLayouts() const { return this->loadedLayoutIds.size(); }
     bool isUnsavedLayout(const QString &layoutId) const;
     QString getLayoutName(const QString &layoutId) const;
     QStringList getLayoutNames() const;
@@ -110,6 +119,18 @@ public:
 
     QMap<QString, Tileset*> tilesetCache;
     Tileset* getTileset(const QString&, bool forceLoad = false);
+    void preloadTilesets();
+    void cancelTilesetPreloads();
+    void prefetchMapNeighbors(const Map *map);
+    void cancelMapPrefetches();
+
+    void setDisplayedLayouts(const QSet<QString> &layoutIds);
+    void blockCacheEviction();
+    void unblockCacheEviction();
+    qint64 getLayoutCacheSize() const;
+    qint64 getTilesetCacheSize() const;
+    MemoryUsage getMemoryUsage() const;
+    int numLoadedTilesets() const;
     QStringList primaryTilesetLabels;
     QStringList secondaryTilesetLabels;
     QStringList tilesetLabelsOrdered;
@@ -156,6 +177,7 @@ public:
     bool readSpeciesIconPaths();
     QString getDefaultSpeciesIconPath(const QString &species);
     QPixmap getSpeciesIcon(const QString &species);
+    void preloadSpeciesIcons();
 
     bool addNewMapsec(const QString &idName, const QString &displayName = QString());
     void removeMapsec(const QString &idName);
@@ -214,7 +236,9 @@ public:
     QPixmap getEventPixmap(const QString &gfxName, const QString &movementName);
     QPixmap getEventPixmap(const QString &gfxName, int frame, bool hFlip);
     QPixmap getEventPixmap(Event::Group group);
+    QString getEventGraphicsName(const QString &gfxName) const;
     void loadEventPixmap(Event *event, bool forceLoad = false);
+    bool finishEventGraphicsLoads();
 
     QString fixPalettePath(const QString &path) const;
     QString fixGraphicPath(const QString &path) const;
@@ -276,10 +300,29 @@ public:
     static QString getMapGroupPrefix();
 
 private:
-    QPointer<QFileSystemWatcher> fileWatcher;
+    // Files this project has added to the shared FileWatcher.
+    QSet<QString> watchedFiles;
     QMap<QString, qint64> modifiedFileTimestamps;
     QMap<QString, QString> facingDirections;
     QHash<QString, QString> speciesToIconPath;
+    // Directories under the Pokémon graphics folder that contain an icon, relative to that folder.
+    // Keys are lowercase so that lookups ignore case, values are the directories as they appear on disk.
+    QHash<QString, QString> speciesIconDirs;
+    bool speciesIconDirsIndexed = false;
+    // Species icons, including placeholders for species without an icon. The cost of each entry is its size in bytes.
+    QCache<QString, QPixmap> speciesIconCache;
+    // Species whose icon is a placeholder, and that haven't been warned about yet.
+    QSet<QString> missingSpeciesIcons;
+    struct SpeciesIconLoad {
+        QString species;
+        QString filepath;
+        bool findDefaultPath = false; // 'filepath' isn't known yet, and should be searched for in the icon directories
+        QImage image;
+    };
+    QFutureWatcher<QList<SpeciesIconLoad>> *speciesIconLoader = nullptr;
+    // Species icons are decoded on a single low-priority thread, so they don't hold up tileset or map loading.
+    QThreadPool speciesIconPool;
+    bool speciesIconsPreloaded = false;
     QHash<QString, Map*> maps;
     QHash<QString, QString> erroredMaps;
     QStringList alphabeticalMapNames;
@@ -316,19 +359,81 @@ private:
 
     QSet<QString> failedFileWatchPaths;
 
+    // Tilesets that are being loaded in the background. They're moved into 'tilesetCache' once they finish loading.
+    struct TilesetPreload {
+        Tileset *tileset = nullptr;
+        QFutureWatcher<bool> *watcher = nullptr;
+        bool operator==(const TilesetPreload &other) const { return this->watcher == other.watcher; }
+    };
+    QHash<QString, TilesetPreload> tilesetPreloads;
+    // Preloads that were canceled while running. They're deleted once they finish.
+    QList<TilesetPreload> canceledTilesetPreloads;
+    QStringList tilesetPreloadQueue;
+    QThreadPool tilesetPreloadPool;
+    // Incremented to cancel the preloads that have been started. Preloads that haven't begun loading by then are skipped.
+    QAtomicInt tilesetPreloadGeneration;
+
+    // The members of each tileset's header (named as in Tileset::getHeaderMemberMap), parsed from the headers file once.
+    QHash<QString, QHash<QString, QString>> tilesetHeaders;
+    bool tilesetHeadersRead = false;
+
+    // Maps that are being loaded in the background. Their files are read on worker threads,
+    // and they're finished by loadPrefetchedMap once their files and tilesets are ready.
+    // Each file's modification time is recorded before it's read, so that data which is stale by the time it's used can be discarded.
+    struct MapJsonData {
+        QJsonDocument doc;
+        QString filepath;
+        QDateTime lastModified;
+        bool isCurrent() const;
+    };
+    struct LayoutFileData {
+        Blockdata blockdata;
+        Blockdata border;
+        QString blockdataPath;
+        QString borderPath;
+        QDateTime blockdataModified;
+        QDateTime borderModified;
+        bool isValid = false;
+        bool isCurrent() const;
+    };
+    QStringList mapPrefetchQueue;
+    QHash<QString, QFuture<MapJsonData>> mapJsonPrefetches;
+    QHash<QString, QFuture<LayoutFileData>> layoutFilePrefetches;
+
+    // Used to unload the least recently used layouts and tilesets when the cache memory limit is exceeded.
+    QHash<QString, quint64> layoutLastUsed;
+    QHash<QString, quint64> tilesetLastUsed;
+    quint64 cacheUseCounter = 0;
+    QHash<QString, qint64> layoutCacheSizes;
+    QHash<QString, qint64> tilesetCacheSizes;
+    qint64 layoutCacheSize = 0;
+    qint64 tilesetCacheSize = 0;
+    QSet<QString> displayedLayoutIds;
+    int cacheEvictionBlockers = 0;
+    bool cacheEvictionScheduled = false;
+
     const QRegularExpression re_gbapalExtension;
     const QRegularExpression re_bppExtension;
 
     struct EventGraphics
     {
+        QString name;
         QString filepath;
         bool loaded = false;
-        QImage spritesheet;
+        QList<QImage> frames;
         int spriteWidth = -1;
         int spriteHeight = -1;
         bool inanimate = false;
+        // Set while the spritesheet is being decoded in the background.
+        QFutureWatcher<QList<QImage>> *loader = nullptr;
     };
     QMap<QString, EventGraphics*> eventGraphicsMap;
+    // Event sprites are decoded on their own pool, so that they aren't stuck behind background loading.
+    QThreadPool eventGraphicsPool;
+    // Event sprites, keyed by graphics name, frame, and flip. The cost of each entry is its size in bytes.
+    QCache<QString, QPixmap> eventPixmapCache;
+    // Models shared by every dropdown that lists the same project data (flags, vars, map names, etc.)
+    QHash<QString, QStringListModel*> stringListModels;
 
     // The extra data that can be associated with each MAPSEC name.
     struct LocationData
@@ -346,11 +451,33 @@ private:
 
     void ignoreWatchedFileTemporarily(const QString &filepath);
     void ignoreWatchedFilesTemporarily(const QStringList &filepaths);
-    void recordFileChange(const QString &filepath);
+    void recordFileChanges(const QStringList &filepaths);
     void resetFileCache();
     void resetFileWatcher();
     void logFileWatchStatus();
     void cacheTileset(const QString &label, Tileset *tileset);
+    bool readTilesetHeader(const QString &label, Tileset *tileset, QString *error);
+    void readTilesetHeaders();
+    void preloadNextTileset();
+    void finishTilesetPreload(const QString &label);
+    void prioritizeTilesetPreload(const QString &label);
+    bool isTilesetPreloadPending(const QString &label) const;
+    void prefetchMap(const QString &mapName);
+    void watchMapPrefetch(const QFuture<void> &future);
+    void processMapPrefetches();
+    bool loadPrefetchedMap(const QString &mapName);
+    void pruneMapPrefetches();
+    void startEventGraphicsLoad(EventGraphics *gfx);
+    void finishEventGraphicsLoad(EventGraphics *gfx);
+    void touchLayout(const Layout *layout);
+    void touchTileset(const QString &label);
+    void setLayoutCacheSize(const QString &layoutId, qint64 size);
+    void setTilesetCacheSize(const QString &label, qint64 size);
+    void updateDisplayedCacheSizes();
+    bool canUnloadLayout(const Layout *layout) const;
+    bool isOverCacheMemoryLimit() const;
+    void scheduleCacheEviction();
+    void enforceCacheMemoryLimit();
 
     bool saveMapLayouts();
     bool saveMapGroups();
@@ -358,7 +485,14 @@ private:
     bool saveHealLocations();
     bool appendTextFile(const QString &path, const QString &text);
 
-    QString findSpeciesIconPath(const QStringList &names) const;
+    QString findSpeciesIconPath(const QStringList &names);
+    static QString findSpeciesIconPath(const QStringList &names, const QString &basePath, const QHash<QString, QString> &iconDirs);
+    static QHash<QString, QString> readSpeciesIconDirs(const QString &basePath);
+    QString getSpeciesIconBasePath() const;
+    void indexSpeciesIconDirs();
+    QString getSpeciesIconFilepath(const QString &species);
+    void recordSpeciesIcon(const QString &species, const QImage &image);
+    void clearSpeciesIcons();
 
     int maxObjectEvents;
     int maxMapDataSize;
@@ -375,7 +509,7 @@ private:
     static int num_pals_total;
 
 signals:
-    void fileChanged(const QString &filepath);
+    void filesChanged(const QStringList &filepaths);
     void mapLoaded(Map *map);
     void mapCreated(Map *newMap, const QString &groupName);
     void layoutCreated(Layout *newLayout);
@@ -385,6 +519,9 @@ signals:
     void mapSectionDisplayNameChanged(const QString &idName, const QString &displayName);
     void mapSectionIdNamesChanged(const QStringList &idNames);
     void eventScriptLabelsRead();
+    void cacheSizeChanged();
+    void layoutUnloaded(const QString &layoutId);
+    void eventGraphicsLoaded(const QStringList &gfxNames);
 };
 
 #endif // PROJECT_H
@@ -71,6 +71,10 @@ public:
     static QJSValue margins(const QMargins &margins);
     static QJSValue position(int x, int y);
     static const QImage * getImage(const QString &filepath, bool useCache);
+    static int numCachedImages();
+    static qint64 getImageCacheSize();
+    static int numOverlayCachedTiles();
+    static qint64 getOverlayCacheSize();
     static QJSValue dialogInput(QJSValue input, bool selectedOk);
 
 private:
@@ -95,6 +99,10 @@ public:
     static void init(MainWindow *) {}
     static void stop() {}
     static void populateGlobalObject(MainWindow *) {}
+    static int numCachedImages() { return 0; }
+    static qint64 getImageCacheSize() { return 0; }
+    static int numOverlayCachedTiles() { return 0; }
+    static qint64 getOverlayCacheSize() { return 0; }
 
     static void cb_ProjectOpened(QString) {};
     static void cb_ProjectClosed(QString) {};
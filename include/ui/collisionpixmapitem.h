@@ -29,6 +29,9 @@ public:
     virtual void pick(QGraphicsSceneMouseEvent*) override;
     void draw(bool ignoreCache = false) override;
 
+protected:
+    virtual QImage renderChunk(const QRect &area) override;
+
 private:
     void updateSelection(QPoint pos);
 };
@@ -3,6 +3,7 @@
 
 #include "mapconnection.h"
 #include "metatile.h"
+#include "pixmappyramid.h"
 #include <QGraphicsPixmapItem>
 #include <QPainter>
 #include <QPointer>
@@ -22,11 +23,14 @@ public:
 
     void render(bool ignoreCache = false);
 
+    virtual void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) override;
+
 signals:
     void positionChanged(qreal x, qreal y);
 
 private:
     QPixmap basePixmap;
+    PixmapPyramid pyramid;
     qreal originX;
     qreal originY;
     bool selected = false;
@@ -59,6 +59,7 @@ protected:
     QPointer<Project> project;
 
     void populateDropdown(NoScrollComboBox * combo, const QStringList &items);
+    void populateDropdown(NoScrollComboBox * combo, QStringListModel *model);
     void populateScriptDropdown(NoScrollComboBox * combo, Project * project);
     void populateMapNameDropdown(NoScrollComboBox * combo, Project * project);
     void populateIdNameDropdown(NoScrollComboBox * combo, Project * project, const QString &mapName, Event::Group group);
@@ -8,8 +8,11 @@
 
 class Layout;
 
+QColor getInvalidImageColor();
+
 QImage getCollisionMetatileImage(Block);
 QImage getCollisionMetatileImage(int, int);
+void drawCollisionMetatileImage(QImage *image, int x, int y, Block block);
 
 QImage getMetatileImage(uint16_t, const Layout*, bool useTruePalettes = false);
 QImage getMetatileImage(const Metatile*, const Layout*, bool useTruePalettes = false);
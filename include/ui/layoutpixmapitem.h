@@ -3,16 +3,18 @@
 
 #include "settings.h"
 #include "metatileselector.h"
+#include "blockdata.h"
+#include "pixmappyramid.h"
+#include "memoryusage.h"
 #include <QGraphicsPixmapItem>
+#include <QCache>
+#include <functional>
 
 class Layout;
 
 class LayoutPixmapItem : public QObject, public QGraphicsPixmapItem {
     Q_OBJECT
 
-private:
-    using QGraphicsPixmapItem::paint;
-
 public:
     LayoutPixmapItem(Layout *layout, MetatileSelector *metatileSelector, Settings *settings) {
         this->layout = layout;
@@ -21,7 +23,9 @@ public:
         this->settings = settings;
         this->lockedAxis = LayoutPixmapItem::Axis::None;
         this->prevStraightPathState = false;
+        this->chunkCache.setMaxCost(chunkCacheLimit);
         setAcceptHoverEvents(true);
+        setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
     }
 
     Layout *layout;
@@ -50,6 +54,9 @@ public:
 
     LayoutPixmapItem::Axis lockedAxis;
 
+    // Memory used by the item's own render caches (its chunks and downsampled pixmaps).
+    MemoryUsage memoryBreakdown(const QString &name) const;
+
     QPoint selection_origin;
     QList<QPoint> selection;
 
@@ -83,6 +90,14 @@ public:
     void shift(int xDelta, int yDelta, bool fromScriptCall = false);
     virtual void draw(bool ignoreCache = false);
 
+    // Very large layouts aren't drawn as a single pixmap. Instead they're split into fixed-size chunks,
+    // which are only rendered when they're exposed in the view and are cached up to a memory limit.
+    // When the view is zoomed out, downsampled copies of the pixmap or chunks are drawn instead.
+    bool isChunked() const { return this->chunked; }
+    virtual QRectF boundingRect() const override;
+    virtual QPainterPath shape() const override;
+    virtual void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) override;
+
     void updateMetatileSelection(QGraphicsSceneMouseEvent *event);
     void paintNormal(int x, int y, bool fromScriptCall = false);
     void lockNondominantAxis(QGraphicsSceneMouseEvent *event);
@@ -91,6 +106,21 @@ public:
 protected:
     unsigned actionId_ = 0;
 
+    static constexpr int chunkSize = 16; // Width/height of a chunk, in metatiles
+    static constexpr int maxUnchunkedArea = 128 * 128; // Layouts with more metatiles than this are drawn in chunks
+    static constexpr int chunkCacheLimit = 64 * 1024; // In KiB
+
+    bool shouldDrawChunked() const;
+    void drawChunks(bool ignoreCache);
+    void clearChunks();
+    virtual QImage renderChunk(const QRect &area);
+    virtual QVariant itemChange(GraphicsItemChange change, const QVariant &value) override;
+
+    PixmapPyramid pyramid;
+    bool takeChangedBlocks(QVector<int> *changedBlocks);
+    void renderPixmap(bool ignoreCache, const std::function<QPixmap()> &render);
+    QRect getChangedPixelRect(const QVector<int> &changedBlocks) const;
+
 private:
     void paintSmartPath(int x, int y, bool fromScriptCall = false);
     static bool isValidSmartPathSelection(MetatileSelection selection);
@@ -99,6 +129,20 @@ private:
     static constexpr int smartPathHeight = 3;
     static constexpr int smartPathMiddleIndex = (smartPathWidth / 2) + ((smartPathHeight / 2) * smartPathWidth);
     QPoint lastMetatileSelectionPos = QPoint(-1,-1);
+    Blockdata shiftStartBlockdata;
+
+    bool chunked = false;
+    QSize chunkedPixelSize;
+    const Layout *drawnLayout = nullptr;
+    quint64 drawnBlockChangeCount = 0;
+    QCache<quint64, QPixmap> chunkCache;
+    QPixmap getChunk(int x, int y, int level = 0);
+    QRect getChunkPixelRect(int x, int y) const;
+    static quint64 chunkKey(int x, int y, int level = 0) {
+        return (static_cast<quint64>(level) << 62) | (static_cast<quint64>(x & 0x7FFFFFFF) << 31) | static_cast<quint64>(y & 0x7FFFFFFF);
+    }
+    static int chunkKeyX(quint64 key) { return static_cast<int>((key >> 31) & 0x7FFFFFFF); }
+    static int chunkKeyY(quint64 key) { return static_cast<int>(key & 0x7FFFFFFF); }
 
 signals:
     void startPaint(QGraphicsSceneMouseEvent *, LayoutPixmapItem *);
@@ -0,0 +1,42 @@
+#ifndef MAPGRID_H
+#define MAPGRID_H
+
+#include <QPainter>
+#include <QPixmap>
+
+#include "gridsettings.h"
+
+// Paints the grid described by a GridSettings over the map.
+// The grid repeats every cell, so rather than drawing each of its lines we render a tile of a few cells
+// at the view's current scale and fill the area being painted with it. If the view's scale can't be
+// tiled exactly, only the lines in the area being painted are drawn.
+class MapGrid
+{
+public:
+    MapGrid() {};
+    ~MapGrid() {};
+
+    void setSettings(const GridSettings &settings);
+    GridSettings settings() const { return m_settings; }
+
+    void setVisible(bool visible) { m_visible = visible; }
+    bool isVisible() const { return m_visible; }
+
+    void paint(QPainter *painter, const QRectF &rect);
+
+private:
+    GridSettings m_settings;
+    bool m_visible = false;
+
+    QPixmap m_tile;
+    qreal m_tileScale = 0;
+    bool m_canTile = false;
+
+    static constexpr int maxTileCells = 8;
+    static constexpr int maxTilePixelSize = 2048;
+
+    bool updateTile(qreal scale);
+    void paintLines(QPainter *painter, const QRectF &rect) const;
+};
+
+#endif // MAPGRID_H
@@ -50,7 +50,7 @@ private:
     explicit MapImageExporter(QWidget *parent, Project *project, Map *map, Layout *layout, ImageExporterMode mode);
 
     Ui::MapImageExporter *ui;
-    Project *m_project = nullptr;
+    QPointer<Project> m_project = nullptr;
     Map *m_map = nullptr;
     Layout *m_layout = nullptr;
     CheckeredBgScene *m_scene = nullptr;
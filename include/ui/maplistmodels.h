@@ -68,6 +68,7 @@ public:
     virtual void removeItemAt(const QModelIndex &index);
     virtual QStandardItem *itemAt(const QModelIndex &index) const;
     virtual QStandardItem *itemAt(const QString &itemName) const;
+    void updateItem(const QString &itemName);
 
     virtual QVariant data(const QModelIndex &index, int role) const override;
 
@@ -9,6 +9,9 @@
 #include "overlay.h"
 #include "tile.h"
 
+#include <QLabel>
+#include <QTimer>
+
 class Editor;
 
 class MapView : public GraphicsView
@@ -25,6 +28,12 @@ public:
 
     Overlay * getOverlay(int layer);
     void clearOverlayMap();
+    qint64 getOverlayCacheSize() const;
+    int numOverlayCachedTiles() const;
+
+    // Show the paint latency statistics recorded by PaintProfiler in the corner of the view.
+    void setLatencyHudVisible(bool visible);
+    bool isLatencyHudVisible() const { return this->latencyHud && this->latencyHud->isVisible(); }
 
     // Overlay scripting API
 #ifdef QT_QML_LIB
@@ -84,13 +93,20 @@ public:
 
 protected:
     virtual void drawForeground(QPainter *painter, const QRectF &rect) override;
+    virtual void paintEvent(QPaintEvent *event) override;
     virtual void keyPressEvent(QKeyEvent*) override;
     virtual void moveEvent(QMoveEvent *event) override;
 private:
     QMap<int, Overlay*> overlayMap;
+    bool sceneUpdateScheduled = false;
+    bool sceneNeedsFullUpdate = false;
+    QLabel *latencyHud = nullptr;
+    QTimer latencyHudTimer;
 
-    void updateScene();
+    void updateScene(bool fullUpdate = false);
+    void flushSceneUpdate();
     void addTileImage(int x, int y, const Tile &tile, bool setTransparency, int layer = 0);
+    void updateLatencyHud();
 };
 
 #endif // GRAPHICSVIEW_H
@@ -0,0 +1,46 @@
+#ifndef MEMORYINSPECTOR_H
+#define MEMORYINSPECTOR_H
+
+#include <QDialog>
+#include <QLabel>
+#include <QTreeWidget>
+#include <QPushButton>
+#include <QCheckBox>
+#include <QPointer>
+#include <QTimer>
+#include <QSet>
+
+#include "memoryusage.h"
+
+class Project;
+
+// Shows an estimate of the memory used by the project's layouts, tilesets, maps, and caches.
+// The breakdown is refreshed periodically while the window is open, and can be exported as JSON.
+class MemoryInspector : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit MemoryInspector(Project *project, QWidget *parent = nullptr);
+
+    void refresh();
+
+protected:
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private:
+    QPointer<Project> project;
+    MemoryUsage usage;
+    QLabel *label_Summary;
+    QTreeWidget *tree_Usage;
+    QCheckBox *checkBox_AutoRefresh;
+    QPushButton *button_Export;
+    QTimer refreshTimer;
+
+    void populateItem(QTreeWidgetItem *item, const MemoryUsage &usage, const QString &path, const QSet<QString> &expandedPaths);
+    QSet<QString> getExpandedPaths() const;
+    void exportUsage();
+};
+
+#endif // MEMORYINSPECTOR_H
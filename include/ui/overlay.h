@@ -7,6 +7,8 @@
 #include <QPainter>
 #include <QStaticText>
 #include <QPainterPath>
+#include <QHash>
+#include <QCache>
 
 #ifdef QT_QML_LIB
 
@@ -15,6 +17,8 @@ public:
     OverlayItem() {}
     virtual ~OverlayItem() {};
     virtual void render(QPainter *) {};
+    // The area covered by the item, in the coordinates of its overlay layer.
+    virtual QRectF boundingRect() const { return QRectF(); }
 };
 
 class OverlayText : public OverlayItem {
@@ -26,15 +30,19 @@ public:
         this->y = y;
         this->color = color;
         this->fontSize = fontSize;
+        this->bounds = calculateBounds();
     }
     ~OverlayText() {}
     virtual void render(QPainter *painter);
+    virtual QRectF boundingRect() const { return this->bounds; }
 private:
     const QStaticText text;
     int x;
     int y;
     QColor color;
     int fontSize;
+    QRectF bounds;
+    QRectF calculateBounds() const;
 };
 
 class OverlayPath : public OverlayItem {
@@ -46,6 +54,8 @@ public:
     }
     ~OverlayPath() {}
     virtual void render(QPainter *painter);
+    // Padded to include the border, which is drawn centered on the path.
+    virtual QRectF boundingRect() const { return this->path.boundingRect().adjusted(-1, -1, 1, 1); }
 private:
     QPainterPath path;
     QColor borderColor;
@@ -61,6 +71,7 @@ public:
     }
     ~OverlayPixmap() {}
     virtual void render(QPainter *painter);
+    virtual QRectF boundingRect() const { return QRectF(this->x, this->y, this->pixmap.width(), this->pixmap.height()); }
 private:
     int x;
     int y;
@@ -79,6 +90,7 @@ public:
         this->hidden = false;
         this->opacity = 1.0;
         this->clippingRect = nullptr;
+        this->flattenedTiles.setMaxCost(flattenedTileCacheLimit);
     }
     ~Overlay() {
         this->clearItems();
@@ -103,17 +115,58 @@ public:
     void clearClippingRect();
     void setPosition(int x, int y);
     void move(int deltaX, int deltaY);
-    void renderItems(QPainter *painter);
+    void renderItems(QPainter *painter, const QRectF &exposedRect = QRectF());
     QList<OverlayItem*> getItems();
+    QList<OverlayItem*> getItems(const QRectF &rect) const;
     void clearItems();
     void addText(const QString text, int x, int y, QString colorStr, int fontSize);
     bool addRect(int x, int y, int width, int height, QString borderColorStr, QString fillColorStr, int rounding);
     bool addImage(int x, int y, QString filepath, bool useCache = true, int width = -1, int height = -1, int xOffset = 0, int yOffset = 0, qreal hScale = 1, qreal vScale = 1, QList<QRgb> palette = QList<QRgb>(), bool setTransparency = false);
     bool addImage(int x, int y, QImage image);
     bool addPath(QList<int> xCoords, QList<int> yCoords, QString borderColorStr, QString fillColorStr);
+
+    // Changes to the layer since the last call to 'clearDirty', so the scene can repaint only what changed.
+    // A layer is fully dirty if a change (e.g. to its position or visibility) could affect anywhere it was drawn.
+    bool isFullyDirty() const { return this->fullyDirty; }
+    QRectF getDirtySceneRect() const;
+    void clearDirty();
+
+    qint64 getFlattenedTilesSize() const { return static_cast<qint64>(this->flattenedTiles.totalCost()) * 1024; }
+    int numFlattenedTiles() const { return this->flattenedTiles.count(); }
 private:
     void clampAngle();
     QColor getColor(QString colorStr);
+    QTransform getTransform() const;
+    void addItem(OverlayItem *item);
+    void setFullyDirty();
+    QList<int> getItemIndexes(const QRectF &rect) const;
+    static QRect getBucketRange(const QRectF &rect);
+    static quint64 bucketKey(int x, int y) { return (static_cast<quint64>(static_cast<quint32>(x)) << 32) | static_cast<quint32>(y); }
+    static int bucketKeyX(quint64 key) { return static_cast<qint32>(static_cast<quint32>(key >> 32)); }
+    static int bucketKeyY(quint64 key) { return static_cast<qint32>(static_cast<quint32>(key)); }
+    bool renderFlattened(QPainter *painter, const QRectF &rect);
+    QPixmap getFlattenedTile(int x, int y, qreal scale, const QPainter *painter);
+    void removeFlattenedTiles(const QRectF &rect);
+
+    // Items are indexed by the square buckets of the layer that they overlap, so only
+    // the items in the area being painted need to be considered.
+    static constexpr int bucketSize = 256;
+    static constexpr int maxItemBuckets = 64; // Items that cover more buckets than this are always considered.
+    QHash<quint64, QList<int>> buckets;
+    QList<int> unbucketedItems;
+    QRectF itemsBoundingRect;
+
+    // Layers with many items are drawn from cached tiles of their items, which are rendered at the
+    // closest power of two to the view's scale. If the view is zoomed in further, the items are drawn directly.
+    static constexpr int flattenThreshold = 1000;
+    static constexpr qreal maxFlattenedScale = 2.0;
+    static constexpr int flattenedTileCacheLimit = 64 * 1024; // In KiB
+    QCache<quint64, QPixmap> flattenedTiles;
+    qreal flattenedScale = 0;
+
+    bool fullyDirty = false;
+    QRectF dirtyRect;
+
     QList<OverlayItem*> items;
     int x;
     int y;
@@ -133,7 +186,7 @@ public:
     Overlay() {}
     ~Overlay() {}
 
-    void renderItems(QPainter *) {}
+    void renderItems(QPainter *, const QRectF & = QRectF()) {}
 };
 
 #endif // QT_QML_LIB
@@ -0,0 +1,44 @@
+#ifndef PIXMAPPYRAMID_H
+#define PIXMAPPYRAMID_H
+
+#include <QPainter>
+#include <QPixmap>
+
+// Keeps copies of a pixmap downsampled to 1/2, 1/4, and 1/8 of its size.
+// When an item is zoomed out, drawing the copy closest to the view's scale is much cheaper
+// than scaling the full pixmap on every paint. Levels are only built when they're first drawn,
+// and when the source changes only the changed area of the built levels is downsampled again.
+class PixmapPyramid
+{
+public:
+    PixmapPyramid() {};
+    ~PixmapPyramid() {};
+
+    static constexpr int maxLevel = 3;
+    static int levelForTransform(QPainter *painter);
+
+    // Set the full-size pixmap. Any levels that were built are discarded.
+    void setSource(const QPixmap &source);
+    // Set the full-size pixmap, which only differs from the previous one within 'changedRect'.
+    void updateSource(const QPixmap &source, const QRect &changedRect);
+    const QPixmap &source() const { return m_source; }
+    void clear();
+    bool isEmpty() const;
+    // Memory used by the built levels. The source pixmap is owned elsewhere, so it isn't included.
+    qint64 memoryUsage() const;
+    int numBuiltLevels() const;
+
+    QPixmap level(int level);
+
+    // Draw the part of the pixmap in 'exposedRect' (in the source's coordinates) at 'pos' using the given level.
+    void paint(QPainter *painter, const QPointF &pos, const QRectF &exposedRect, int level);
+
+    static QPixmap downsample(const QPixmap &pixmap, int level);
+
+private:
+    QPixmap m_source;
+    QPixmap m_levels[maxLevel];  // m_levels[i] is 1/2^(i+1) scale
+    QRect m_dirtyRects[maxLevel]; // Area of each level's source that changed since it was built, in source pixels
+};
+
+#endif // PIXMAPPYRAMID_H
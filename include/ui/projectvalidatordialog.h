@@ -0,0 +1,39 @@
+#ifndef PROJECTVALIDATORDIALOG_H
+#define PROJECTVALIDATORDIALOG_H
+
+#include <QDialog>
+#include <QLabel>
+#include <QProgressBar>
+#include <QTreeWidget>
+#include <QPushButton>
+
+#include "projectvalidator.h"
+
+class Project;
+
+class ProjectValidatorDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit ProjectValidatorDialog(Project *project, QWidget *parent = nullptr);
+
+    void run();
+
+signals:
+    void openMapRequested(const QString &mapName);
+
+private:
+    Project *project;
+    ProjectValidator *validator;
+    QLabel *label_Summary;
+    QProgressBar *progressBar;
+    QTreeWidget *tree_Issues;
+    QPushButton *button_Run;
+    QPushButton *button_Export;
+
+    void displayResults();
+    void exportResults();
+};
+
+#endif // PROJECTVALIDATORDIALOG_H
@@ -24,7 +24,8 @@ public:
     virtual void fill(QGraphicsSceneMouseEvent *);
     virtual void select(QGraphicsSceneMouseEvent *);
     virtual void draw();
-    void floodFill(int x, int y, std::shared_ptr<TilemapTile> oldTile, std::shared_ptr<TilemapTile> newTile);
+    void drawTiles(const QList<int> &indexes);
+    void floodFill(int x, int y, unsigned oldTile, unsigned newTile);
 
 signals:
     void mouseEvent(QGraphicsSceneMouseEvent *, RegionMapPixmapItem *);
@@ -50,6 +50,7 @@ protected:
     virtual void mouseReleaseEvent(QGraphicsSceneMouseEvent*) override;
     virtual void drawSelectionRect(const QPoint &, const QSize &, Qt::PenStyle style = Qt::SolidLine);
     virtual void drawSelection();
+    static void paintSelectionRect(QPainter *painter, const QRect &rect, Qt::PenStyle style);
     virtual int cellsWide() const { return this->cellWidth ? (pixmap().width() / this->cellWidth) : 0; }
     virtual int cellsTall() const { return this->cellHeight ? (pixmap().height() / this->cellHeight) : 0; }
 
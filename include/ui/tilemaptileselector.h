@@ -122,6 +122,15 @@ public:
     }
 };
 
+// Create a tile in the given format from its value in a tilemap.
+inline shared_ptr<TilemapTile> makeTilemapTile(TilemapFormat format, unsigned raw) {
+    switch (format) {
+        case TilemapFormat::BPP_4: return std::make_shared<BPP4Tile>(raw);
+        case TilemapFormat::BPP_8: return std::make_shared<BPP8Tile>(raw);
+        default: return std::make_shared<PlainTile>(raw);
+    }
+}
+
 class TilemapTileSelector: public SelectablePixmapItem {
     Q_OBJECT
 public:
@@ -165,6 +174,7 @@ public:
     TilemapFormat format = TilemapFormat::Plain;
     QList<QRgb> palette;
     QImage tileImg(shared_ptr<TilemapTile> tile);
+    QImage tileImg(unsigned raw);
 
 protected:
     void mousePressEvent(QGraphicsSceneMouseEvent*);
@@ -180,6 +190,12 @@ private:
     unsigned getTileId(int x, int y);
     QPoint getTileIdCoords(unsigned);
 
+    // The tileset and palettes don't change after the selector is created, so each combination
+    // of tile, palette and flips only needs to be drawn once. Keyed by the tile's value in the tilemap.
+    QHash<unsigned, QImage> tileImageCache;
+    QHash<int, QImage> palettedTilesetCache;
+    QImage getPalettedTileset(int paletteIndex);
+
 signals:
     void hoveredTileChanged(unsigned);
     void hoveredTileCleared();
@@ -4,6 +4,7 @@
 #include <QMainWindow>
 #include <QPointer>
 #include <QKeyEvent>
+#include <QElapsedTimer>
 #include "project.h"
 #include "history.h"
 #include "paletteeditor.h"
@@ -19,34 +20,46 @@ namespace Ui {
 class TilesetEditor;
 }
 
+// An entry in the Tileset Editor's edit history. Rather than copies of the metatile before and after the edit,
+// only the tiles and attributes that changed are recorded, and the label only if it changed.
 class MetatileHistoryItem {
 public:
-    MetatileHistoryItem() {};
-    MetatileHistoryItem(uint16_t metatileId, Metatile *prevMetatile, Metatile *newMetatile, QString prevLabel, QString newLabel) {
-        this->metatileId = metatileId;
-        this->prevMetatile = prevMetatile;
-        this->newMetatile = newMetatile;
-        this->prevLabel = prevLabel;
-        this->newLabel = newLabel;
-    }
+    MetatileHistoryItem(uint16_t metatileId, const Metatile &prevMetatile, const Metatile &newMetatile, const QString &prevLabel, const QString &newLabel);
     MetatileHistoryItem(uint16_t metatileIdA, uint16_t metatileIdB) {
         this->metatileId = metatileIdA;
         this->swapMetatileId = metatileIdB;
         this->isSwap = true;
     }
-    ~MetatileHistoryItem() {
-        delete this->prevMetatile;
-        delete this->newMetatile;
-    }
+
+    struct TileChange {
+        int index;
+        Tile prev;
+        Tile next;
+    };
+    struct AttributeChange {
+        Metatile::Attr attr;
+        uint32_t prev;
+        uint32_t next;
+    };
 
     uint16_t metatileId = 0;
-    Metatile *prevMetatile = nullptr;
-    Metatile *newMetatile = nullptr;
+    QList<TileChange> tileChanges;
+    QList<AttributeChange> attributeChanges;
+    int prevNumTiles = 0;
+    int newNumTiles = 0;
+    bool labelChanged = false;
     QString prevLabel;
     QString newLabel;
 
     uint16_t swapMetatileId = 0;
     bool isSwap = false;
+
+    // Set for edits made by painting in the metatile layers view. Consecutive paint edits to the same metatile can be merged.
+    bool isLayerPaint = false;
+
+    bool merge(const MetatileHistoryItem &other);
+    void apply(Metatile *metatile, bool undo) const;
+    qint64 memoryUsage() const;
 };
 
 class TilesetEditor : public QMainWindow
@@ -133,8 +146,8 @@ private:
     void copyMetatile(bool cut);
     void pasteMetatile(const Metatile &toPaste, QString label);
     bool replaceMetatile(uint16_t metatileId, const Metatile &src, QString label);
-    void commitMetatileChange(Metatile * prevMetatile);
-    void commitMetatileAndLabelChange(Metatile * prevMetatile, QString prevLabel);
+    void commitMetatileChange(const Metatile &prevMetatile, bool isLayerPaint = false);
+    void commitMetatileAndLabelChange(const Metatile &prevMetatile, QString prevLabel, bool isLayerPaint = false);
     uint32_t attributeNameToValue(Metatile::Attr attribute, const QString &text, bool *ok);
     void commitAttributeFromComboBox(Metatile::Attr attribute, NoScrollComboBox *combo);
     void onRawAttributesEdited();
@@ -144,6 +157,8 @@ private:
     void commitTerrainType();
     void commitLayerType();
     void commit(MetatileHistoryItem *item);
+    void enforceMetatileHistoryLimit();
+    void applyMetatileHistoryItem(const MetatileHistoryItem *item, bool undo);
     void updateEditHistoryActions();
     void setRawAttributesVisible(bool visible);
     void refreshTileFlips();
@@ -164,6 +179,8 @@ private:
 
     Ui::TilesetEditor *ui;
     History<MetatileHistoryItem*> metatileHistory;
+    qint64 metatileHistorySize = 0; // Total memoryUsage() of the items in metatileHistory
+    QElapsedTimer lastLayerPaintTimer;
     TilesetEditorMetatileSelector *metatileSelector = nullptr;
     TilesetEditorTileSelector *tileSelector = nullptr;
     MetatileLayersItem *metatileLayersItem = nullptr;
@@ -15,6 +15,7 @@ public:
     void draw() override;
     void drawMetatile(uint16_t metatileId);
     void drawSelectedMetatile();
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) override;
 
     bool select(uint16_t metatileId);
     void setTilesets(Tileset*, Tileset*);
@@ -41,11 +42,26 @@ protected:
     void mouseReleaseEvent(QGraphicsSceneMouseEvent*) override;
     void hoverMoveEvent(QGraphicsSceneHoverEvent*) override;
     void hoverLeaveEvent(QGraphicsSceneHoverEvent*) override;
+    void drawSelectionRect(const QPoint &origin, const QSize &dimensions, Qt::PenStyle style = Qt::SolidLine) override;
 
 private:
+    struct SelectionRect {
+        QRect rect;
+        Qt::PenStyle style;
+    };
+
     const int numMetatilesWide;
-    QImage baseImage;
+
+    // The metatile sheet is only rebuilt when the tilesets change. Edits to a metatile redraw its cell in place.
     QPixmap basePixmap;
+
+    // Overlays are drawn on separate transparent layers and composed over the sheet in paint(),
+    // so they don't need to be redrawn when a metatile changes, or when the selection changes.
+    QPixmap gridLayer;
+    QPixmap unusedLayer;
+    QPixmap countsLayer;
+    QVector<uint16_t> layerUsage; // The usage counts that the unused and counts layers were drawn with
+    QList<SelectionRect> selectionRects;
     Tileset *primaryTileset = nullptr;
     Tileset *secondaryTileset = nullptr;
     uint16_t selectedMetatileId = 0;
@@ -63,10 +79,11 @@ private:
     int numRows(int numMetatiles) const;
     int numRows() const;
     void drawGrid();
-    void drawDivider();
+    void drawDivider(QPainter *painter) const;
     void drawFilters();
     void drawUnused();
     void drawCounts();
+    void clearLayers();
     int numPrimaryMetatilesRounded() const;
 
 signals:
@@ -4,7 +4,7 @@
 #
 #-------------------------------------------------
 
-QT       += core gui
+QT       += core gui concurrent
 
 qtHaveModule(charts) {
     QT += charts
@@ -24,6 +24,9 @@ qtHaveModule(network) {
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
+# PNG export uses zlib directly. Qt's bundled copy is used when its headers are installed, otherwise link the system zlib.
+!exists($$[QT_INSTALL_HEADERS]/QtZlib/zlib.h): LIBS += -lz
+
 TARGET = porymap
 TEMPLATE = app
 RC_ICONS = resources/icons/porymap-icon-2.ico
@@ -50,6 +53,7 @@ SOURCES += src/core/advancemapparser.cpp \
     src/core/blockdata.cpp \
     src/core/events.cpp \
     src/core/filedialog.cpp \
+    src/core/filewatcher.cpp \
     src/core/imageexport.cpp \
     src/core/map.cpp \
     src/core/mapconnection.cpp \
@@ -57,7 +61,10 @@ SOURCES += src/core/advancemapparser.cpp \
     src/core/maplayout.cpp \
     src/core/metatile.cpp \
     src/core/network.cpp \
+    src/core/memoryusage.cpp \
+    src/core/paintprofiler.cpp \
     src/core/paletteutil.cpp \
+    src/core/projectvalidator.cpp \
     src/core/parseutil.cpp \
     src/core/tile.cpp \
     src/core/tileset.cpp \
@@ -110,6 +117,10 @@ SOURCES += src/core/advancemapparser.cpp \
     src/ui/prefabcreationdialog.cpp \
     src/ui/regionmappixmapitem.cpp \
     src/ui/citymappixmapitem.cpp \
+    src/ui/mapgrid.cpp \
+    src/ui/pixmappyramid.cpp \
+    src/ui/projectvalidatordialog.cpp \
+    src/ui/memoryinspector.cpp \
     src/ui/mapheaderform.cpp \
     src/ui/metatilelayersitem.cpp \
     src/ui/metatileselector.cpp \
@@ -167,6 +178,7 @@ HEADERS  += include/core/advancemapparser.h \
     include/core/blockdata.h \
     include/core/events.h \
     include/core/filedialog.h \
+    include/core/filewatcher.h \
     include/core/history.h \
     include/core/imageexport.h \
     include/core/map.h \
@@ -175,7 +187,10 @@ HEADERS  += include/core/advancemapparser.h \
     include/core/maplayout.h \
     include/core/metatile.h \
     include/core/network.h \
+    include/core/memoryusage.h \
+    include/core/paintprofiler.h \
     include/core/paletteutil.h \
+    include/core/projectvalidator.h \
     include/core/parseutil.h \
     include/core/tile.h \
     include/core/tileset.h \
@@ -224,6 +239,10 @@ HEADERS  += include/core/advancemapparser.h \
     include/ui/graphicsview.h \
     include/ui/imageproviders.h \
     include/ui/layoutpixmapitem.h \
+    include/ui/mapgrid.h \
+    include/ui/pixmappyramid.h \
+    include/ui/projectvalidatordialog.h \
+    include/ui/memoryinspector.h \
     include/ui/mapview.h \
     include/ui/prefabcreationdialog.h \
     include/ui/regionmappixmapitem.h \
@@ -334,3 +353,25 @@ INCLUDEPATH += include/lib
 INCLUDEPATH += forms
 
 include(src/vendor/QtGifImage/gifimage/qtgifimage.pri)
+
+# Benchmarks for porymap's performance-sensitive code. These are built instead of porymap with 'qmake "CONFIG+=benchmarks"'.
+# See tests/README.md.
+benchmarks {
+    TARGET = porymap-benchmarks
+    QT += testlib
+    CONFIG += console
+    CONFIG -= app_bundle
+
+    SOURCES -= src/main.cpp
+    SOURCES += tests/benchmarks/allocationcounter.cpp \
+        tests/benchmarks/benchmarkreport.cpp \
+        tests/benchmarks/benchmarks.cpp \
+        tools/projectgenerator/projectgenerator.cpp
+
+    HEADERS += tests/benchmarks/allocationcounter.h \
+        tests/benchmarks/benchmarkreport.h \
+        tools/projectgenerator/projectgenerator.h
+
+    INCLUDEPATH += tests/benchmarks
+    INCLUDEPATH += tools/projectgenerator
+}
@@ -365,6 +365,10 @@ void PorymapConfig::reset() {
     this->eventOverlayEnabled = false;
     this->checkForUpdates = true;
     this->showProjectLoadingScreen = true;
+    this->preloadTilesets = true;
+    this->mapPrefetchLimit = 8;
+    this->cacheMemoryLimit = 0;
+    this->tilesetEditorHistoryLimit = 16;
     this->lastUpdateCheckTime = QDateTime();
     this->lastUpdateCheckVersion = porymapVersion;
     this->rateLimitTimes.clear();
@@ -531,6 +535,14 @@ void PorymapConfig::parseConfigKeyValue(QString key, QString value) {
         this->checkForUpdates = getConfigBool(key, value);
     } else if (key == "show_project_loading_screen") {
         this->showProjectLoadingScreen = getConfigBool(key, value);
+    } else if (key == "preload_tilesets") {
+        this->preloadTilesets = getConfigBool(key, value);
+    } else if (key == "map_prefetch_limit") {
+        this->mapPrefetchLimit = getConfigInteger(key, value, 0, 64, 8);
+    } else if (key == "cache_memory_limit") {
+        this->cacheMemoryLimit = getConfigInteger(key, value, 0, 65536, 0);
+    } else if (key == "tileset_editor_history_limit") {
+        this->tilesetEditorHistoryLimit = getConfigInteger(key, value, 0, 4096, 16);
     } else if (key == "last_update_check_time") {
         this->lastUpdateCheckTime = QDateTime::fromString(value).toLocalTime();
     } else if (key == "last_update_check_version") {
@@ -656,6 +668,10 @@ QMap<QString, QString> PorymapConfig::getKeyValueMap() {
     map.insert("event_overlay_enabled", QString::number(this->eventOverlayEnabled));
     map.insert("check_for_updates", QString::number(this->checkForUpdates));
     map.insert("show_project_loading_screen", QString::number(this->showProjectLoadingScreen));
+    map.insert("preload_tilesets", QString::number(this->preloadTilesets));
+    map.insert("map_prefetch_limit", QString::number(this->mapPrefetchLimit));
+    map.insert("cache_memory_limit", QString::number(this->cacheMemoryLimit));
+    map.insert("tileset_editor_history_limit", QString::number(this->tilesetEditorHistoryLimit));
     map.insert("last_update_check_time", this->lastUpdateCheckTime.toUTC().toString());
     map.insert("last_update_check_version", this->lastUpdateCheckVersion.toString());
     for (auto i = this->rateLimitTimes.cbegin(), end = this->rateLimitTimes.cend(); i != end; i++){
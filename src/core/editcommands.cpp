@@ -2,8 +2,10 @@
 #include "eventpixmapitem.h"
 #include "bordermetatilespixmapitem.h"
 #include "editor.h"
+#include "paintprofiler.h"
 
 #include <QDebug>
+#include <QUndoStack>
 
 int getEventTypeMask(const QList<Event *> &events) {
     int eventTypeMask = 0;
@@ -62,6 +64,7 @@ PaintMetatile::PaintMetatile(Layout *layout,
 }
 
 void PaintMetatile::redo() {
+    PaintProfiler::Scope profilerScope(PaintProfiler::Phase::Command);
     QUndoCommand::redo();
 
     if (!layout) return;
@@ -74,6 +77,7 @@ void PaintMetatile::redo() {
 }
 
 void PaintMetatile::undo() {
+    PaintProfiler::Scope profilerScope(PaintProfiler::Phase::Command);
     if (!layout) return;
 
     layout->setBlockdata(oldMetatiles, true);
@@ -116,6 +120,7 @@ PaintBorder::PaintBorder(Layout *layout,
 }
 
 void PaintBorder::redo() {
+    PaintProfiler::Scope profilerScope(PaintProfiler::Phase::Command);
     QUndoCommand::redo();
 
     if (!layout) return;
@@ -128,6 +133,7 @@ void PaintBorder::redo() {
 }
 
 void PaintBorder::undo() {
+    PaintProfiler::Scope profilerScope(PaintProfiler::Phase::Command);
     if (!layout) return;
 
     layout->setBorderBlockData(oldBorder, true);
@@ -156,6 +162,7 @@ ShiftMetatiles::ShiftMetatiles(Layout *layout,
 }
 
 void ShiftMetatiles::redo() {
+    PaintProfiler::Scope profilerScope(PaintProfiler::Phase::Command);
     QUndoCommand::redo();
 
     if (!layout) return;
@@ -164,17 +171,20 @@ void ShiftMetatiles::redo() {
 
     layout->lastCommitBlocks.blocks = layout->blockdata;
 
-    renderBlocks(layout, true);
+    // Only the blocks that differ from what was last rendered need to be drawn again.
+    // When the shift is first committed the blocks have already been shifted and drawn.
+    renderBlocks(layout);
 }
 
 void ShiftMetatiles::undo() {
+    PaintProfiler::Scope profilerScope(PaintProfiler::Phase::Command);
     if (!layout) return;
 
     layout->setBlockdata(oldMetatiles, true);
 
     layout->lastCommitBlocks.blocks = layout->blockdata;
 
-    renderBlocks(layout, true);
+    renderBlocks(layout);
 
     QUndoCommand::undo();
 }
@@ -225,6 +235,7 @@ ResizeLayout::ResizeLayout(Layout *layout, QSize oldLayoutDimensions, QMargins n
 }
 
 void ResizeLayout::redo() {
+    PaintProfiler::Scope profilerScope(PaintProfiler::Phase::Command);
     QUndoCommand::redo();
 
     if (!layout) return;
@@ -244,6 +255,7 @@ void ResizeLayout::redo() {
 }
 
 void ResizeLayout::undo() {
+    PaintProfiler::Scope profilerScope(PaintProfiler::Phase::Command);
     if (!layout) return;
 
     layout->border = oldBorder;
@@ -509,6 +521,7 @@ ScriptEditLayout::ScriptEditLayout(Layout *layout,
 }
 
 void ScriptEditLayout::redo() {
+    PaintProfiler::Scope profilerScope(PaintProfiler::Phase::Command);
     QUndoCommand::redo();
 
     if (!layout) return;
@@ -537,6 +550,7 @@ void ScriptEditLayout::redo() {
 }
 
 void ScriptEditLayout::undo() {
+    PaintProfiler::Scope profilerScope(PaintProfiler::Phase::Command);
     if (!layout) return;
 
     if (oldLayoutWidth != layout->getWidth() || oldLayoutHeight != layout->getHeight()) {
@@ -785,3 +799,59 @@ void MapConnectionRemove::undo() {
 int MapConnectionRemove::id() const {
     return CommandId::ID_MapConnectionRemove | getConnectionDirectionMask({this->connection->direction()});
 }
+
+static qint64 blockdataMemoryUsage(const Blockdata &blockdata) {
+    return blockdata.size() * static_cast<qint64>(sizeof(Block));
+}
+
+qint64 PaintMetatile::memoryUsage() const {
+    return blockdataMemoryUsage(this->newMetatiles) + blockdataMemoryUsage(this->oldMetatiles);
+}
+
+qint64 PaintBorder::memoryUsage() const {
+    return blockdataMemoryUsage(this->newBorder) + blockdataMemoryUsage(this->oldBorder);
+}
+
+qint64 ShiftMetatiles::memoryUsage() const {
+    return blockdataMemoryUsage(this->newMetatiles) + blockdataMemoryUsage(this->oldMetatiles);
+}
+
+qint64 ResizeLayout::memoryUsage() const {
+    return blockdataMemoryUsage(this->newMetatiles) + blockdataMemoryUsage(this->oldMetatiles)
+         + blockdataMemoryUsage(this->newBorder) + blockdataMemoryUsage(this->oldBorder);
+}
+
+qint64 ScriptEditLayout::memoryUsage() const {
+    return blockdataMemoryUsage(this->newMetatiles) + blockdataMemoryUsage(this->oldMetatiles)
+         + blockdataMemoryUsage(this->newBorder) + blockdataMemoryUsage(this->oldBorder);
+}
+
+static qint64 commandMemoryUsage(const QUndoCommand *command) {
+    qint64 size = sizeof(QUndoCommand) + command->text().size() * static_cast<qint64>(sizeof(QChar));
+    if (auto paint = dynamic_cast<const PaintMetatile *>(command)) {
+        // Includes the collision and fill commands.
+        size += paint->memoryUsage();
+    } else if (auto paintBorder = dynamic_cast<const PaintBorder *>(command)) {
+        size += paintBorder->memoryUsage();
+    } else if (auto shift = dynamic_cast<const ShiftMetatiles *>(command)) {
+        size += shift->memoryUsage();
+    } else if (auto resize = dynamic_cast<const ResizeLayout *>(command)) {
+        size += resize->memoryUsage();
+    } else if (auto scriptEdit = dynamic_cast<const ScriptEditLayout *>(command)) {
+        size += scriptEdit->memoryUsage();
+    }
+    for (int i = 0; i < command->childCount(); i++) {
+        size += commandMemoryUsage(command->child(i));
+    }
+    return size;
+}
+
+qint64 editHistoryMemoryUsage(const QUndoStack *history) {
+    if (!history)
+        return 0;
+    qint64 size = 0;
+    for (int i = 0; i < history->count(); i++) {
+        size += commandMemoryUsage(history->command(i));
+    }
+    return size;
+}
@@ -0,0 +1,256 @@
+#include "filewatcher.h"
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QFile>
+#include <QFileInfo>
+#include <QPointer>
+#include <QtConcurrent>
+
+FileWatcher::FileWatcher(QObject *parent) : QObject(parent) {
+    connect(&m_watcher, &QFileSystemWatcher::directoryChanged, this, &FileWatcher::recordDirectoryChange);
+
+    m_debounceTimer.setSingleShot(true);
+    m_debounceTimer.setInterval(250);
+    connect(&m_debounceTimer, &QTimer::timeout, this, &FileWatcher::checkPendingChanges);
+
+    // Checks only read files, and they're run one at a time so that their results arrive in order.
+    m_checkPool.setMaxThreadCount(1);
+}
+
+FileWatcher::~FileWatcher() {
+    // A running check only uses copies of the file states, but it must finish before its pool is destroyed.
+    if (m_check)
+        m_check->disconnect(this);
+    m_checkPool.waitForDone();
+}
+
+FileWatcher *FileWatcher::instance() {
+    static QPointer<FileWatcher> watcher;
+    if (!watcher) {
+        // Only create the file watcher when it's first needed (even an empty QFileSystemWatcher will consume system resources).
+        watcher = new FileWatcher(qApp);
+    }
+    return watcher;
+}
+
+QString FileWatcher::dirPath(const QString &filepath) {
+    return QFileInfo(filepath).absolutePath();
+}
+
+QByteArray FileWatcher::hashFile(const QString &filepath) {
+    QFile file(filepath);
+    if (!file.open(QIODevice::ReadOnly))
+        return QByteArray();
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    hash.addData(&file);
+    return hash.result();
+}
+
+FileWatcher::FileState FileWatcher::readState(const QString &filepath) {
+    FileState state;
+    const QFileInfo info(filepath);
+    if (info.exists()) {
+        state.exists = true;
+        state.size = info.size();
+        state.lastModified = info.lastModified();
+    }
+    return state;
+}
+
+bool FileWatcher::addFile(const QString &filepath) {
+    auto it = m_refCounts.find(filepath);
+    if (it != m_refCounts.end()) {
+        it.value()++;
+        return true;
+    }
+
+    const QString dir = dirPath(filepath);
+    if (!m_dirs.contains(dir)) {
+        if (!m_watcher.addPath(dir) && !m_watcher.directories().contains(dir))
+            return false;
+    }
+    m_dirs[dir].insert(filepath);
+    const FileState state = readState(filepath);
+    m_files.insert(filepath, state);
+    m_refCounts.insert(filepath, 1);
+
+    // Hash the file on the worker thread, so that later changes can be compared against its contents.
+    if (state.exists) {
+        m_unhashedFiles.insert(filepath);
+        m_debounceTimer.start();
+    }
+    return true;
+}
+
+bool FileWatcher::removeFile(const QString &filepath) {
+    auto it = m_refCounts.find(filepath);
+    if (it == m_refCounts.end())
+        return false;
+    if (--it.value() > 0)
+        return true;
+
+    m_refCounts.erase(it);
+    m_files.remove(filepath);
+    m_unhashedFiles.remove(filepath);
+
+    const QString dir = dirPath(filepath);
+    auto dirIt = m_dirs.find(dir);
+    if (dirIt != m_dirs.end()) {
+        dirIt->remove(filepath);
+        if (dirIt->isEmpty()) {
+            m_dirs.erase(dirIt);
+            m_pendingDirs.remove(dir);
+            forgetMissingDirectory(dir);
+            if (!m_missingDirs.contains(dir))
+                m_watcher.removePath(dir);
+        }
+    }
+    return true;
+}
+
+void FileWatcher::recordDirectoryChange(const QString &dirpath) {
+    if (m_dirs.contains(dirpath)) {
+        m_pendingDirs.insert(dirpath);
+        // QFileSystemWatcher stops watching a directory once it's deleted (e.g. by a checkout that replaces it).
+        if (!m_watcher.directories().contains(dirpath))
+            watchDirectory(dirpath);
+    }
+
+    // A parent of deleted directories changed, so some of them may have been recreated.
+    const QSet<QString> missingDirs = m_missingDirs.take(dirpath);
+    for (const auto &dir : missingDirs) {
+        watchDirectory(dir);
+    }
+    if (!missingDirs.isEmpty() && !m_missingDirs.contains(dirpath) && !m_dirs.contains(dirpath))
+        m_watcher.removePath(dirpath);
+
+    m_debounceTimer.start();
+}
+
+// Start watching a directory again. If it doesn't exist, its nearest existing parent is watched instead
+// so that we find out when it's recreated.
+void FileWatcher::watchDirectory(const QString &dir) {
+    if (QFileInfo(dir).isDir() && m_watcher.addPath(dir)) {
+        // Its files may have been recreated along with it.
+        m_pendingDirs.insert(dir);
+        return;
+    }
+
+    QString parent = dir;
+    do {
+        const QString next = dirPath(parent);
+        if (next == parent)
+            return;
+        parent = next;
+    } while (!QFileInfo(parent).isDir());
+
+    if (!m_dirs.contains(parent) && !m_missingDirs.contains(parent) && !m_watcher.addPath(parent))
+        return;
+    m_missingDirs[parent].insert(dir);
+}
+
+// Stop waiting for a deleted directory to be recreated, and stop watching any parent that was only watched for it.
+void FileWatcher::forgetMissingDirectory(const QString &dir) {
+    for (auto it = m_missingDirs.begin(); it != m_missingDirs.end();) {
+        it->remove(dir);
+        if (it->isEmpty()) {
+            if (!m_dirs.contains(it.key()))
+                m_watcher.removePath(it.key());
+            it = m_missingDirs.erase(it);
+        } else {
+            it++;
+        }
+    }
+}
+
+// Compare each file against its recorded state. Only files whose size or modification time changed are hashed,
+// and a file is only reported if its contents changed. Files that haven't been hashed yet are hashed here.
+// This only reads the files, so it's safe to call from a worker thread.
+QList<FileWatcher::FileCheck> FileWatcher::checkFiles(const QHash<QString, FileState> &files) {
+    QList<FileCheck> checks;
+    for (auto it = files.constBegin(); it != files.constEnd(); it++) {
+        const FileState &previous = it.value();
+        FileCheck check;
+        check.filepath = it.key();
+        check.state = readState(check.filepath);
+
+        if (!check.state.exists) {
+            if (previous.exists) {
+                check.changed = true;
+                checks.append(check);
+            }
+            continue;
+        }
+        if (previous.exists && previous.size == check.state.size && previous.lastModified == check.state.lastModified) {
+            if (!previous.hash.isEmpty()) {
+                // A different file in the same directory changed.
+                continue;
+            }
+            // The file was just added. Record its hash to compare against later.
+            check.state.hash = hashFile(check.filepath);
+            checks.append(check);
+            continue;
+        }
+
+        // If the file changed before it could be hashed we can't tell whether its contents are the same, so it's reported.
+        check.state.hash = hashFile(check.filepath);
+        check.changed = !previous.exists
+                     || previous.size != check.state.size
+                     || previous.hash.isEmpty()
+                     || previous.hash != check.state.hash;
+        checks.append(check);
+    }
+    return checks;
+}
+
+void FileWatcher::checkPendingChanges() {
+    if (m_check) {
+        // A check is already running. Anything still pending will be checked once it finishes.
+        return;
+    }
+
+    QHash<QString, FileState> candidates;
+    for (const auto &dir : m_pendingDirs) {
+        for (const auto &filepath : m_dirs.value(dir)) {
+            candidates.insert(filepath, m_files.value(filepath));
+        }
+    }
+    for (const auto &filepath : m_unhashedFiles) {
+        candidates.insert(filepath, m_files.value(filepath));
+    }
+    m_pendingDirs.clear();
+    m_unhashedFiles.clear();
+    m_debounceTimer.stop();
+    if (candidates.isEmpty())
+        return;
+
+    m_check = new QFutureWatcher<QList<FileCheck>>(this);
+    connect(m_check, &QFutureWatcher<QList<FileCheck>>::finished, this, &FileWatcher::finishCheck);
+    m_check->setFuture(QtConcurrent::run(&m_checkPool, [candidates] { return checkFiles(candidates); }));
+}
+
+void FileWatcher::finishCheck() {
+    const QList<FileCheck> checks = m_check->result();
+    m_check->deleteLater();
+    m_check = nullptr;
+
+    QStringList changedFiles;
+    for (const auto &check : checks) {
+        // The file may have stopped being watched while it was being checked.
+        auto it = m_files.find(check.filepath);
+        if (it == m_files.end())
+            continue;
+        it.value() = check.state;
+        if (check.changed)
+            changedFiles.append(check.filepath);
+    }
+
+    if (!m_pendingDirs.isEmpty() || !m_unhashedFiles.isEmpty())
+        m_debounceTimer.start();
+
+    if (!changedFiles.isEmpty()) {
+        changedFiles.sort();
+        emit filesChanged(changedFiles);
+    }
+}
@@ -1,57 +1,287 @@
 #include "imageexport.h"
 #include "log.h"
 #include <QFile>
+#include <QtEndian>
 
-// CRC code from: http://www.libpng.org/pub/png/spec/1.2/PNG-CRCAppendix.html
+#include <array>
+#include <cstring>
+#include <limits>
 
-/* Table of CRCs of all 8-bit messages. */
-unsigned long crc_table[256];
+// Qt builds that bundle zlib provide it through QtZlib, otherwise Qt uses the system's zlib.
+#if __has_include(<QtZlib/zlib.h>)
+#include <QtZlib/zlib.h>
+#else
+#include <zlib.h>
+#endif
 
-/* Flag: has the table been computed? Initially false. */
-int crc_table_computed = 0;
+// The CRC is the standard CRC-32 used by PNG. See: http://www.libpng.org/pub/png/spec/1.2/PNG-CRCAppendix.html
+static const std::array<quint32, 256> crcTable = [] {
+    std::array<quint32, 256> table = {};
+    for (quint32 n = 0; n < 256; n++) {
+        quint32 c = n;
+        for (int k = 0; k < 8; k++) {
+            if (c & 1)
+                c = 0xedb88320u ^ (c >> 1);
+            else
+                c = c >> 1;
+        }
+        table[n] = c;
+    }
+    return table;
+}();
 
-/* Make the table for a fast CRC. */
-void make_crc_table(void)
-{
-  unsigned long c;
-  int n, k;
-
-  for (n = 0; n < 256; n++) {
-    c = (unsigned long) n;
-    for (k = 0; k < 8; k++) {
-      if (c & 1)
-        c = 0xedb88320L ^ (c >> 1);
-      else
-        c = c >> 1;
-    }
-    crc_table[n] = c;
-  }
-  crc_table_computed = 1;
+// Update a running CRC with the bytes data[0..length-1]. The CRC should be initialized to all 1's,
+// and the final value is the 1's complement of the running CRC.
+static quint32 updateCrc(quint32 crc, const char *data, qint64 length) {
+    for (qint64 i = 0; i < length; i++) {
+        crc = crcTable[(crc ^ static_cast<uchar>(data[i])) & 0xff] ^ (crc >> 8);
+    }
+    return crc;
 }
 
-/* Update a running CRC with the bytes buf[0..len-1]--the CRC
-   should be initialized to all 1's, and the transmitted value
-   is the 1's complement of the final running CRC (see the
-   crc() routine below)). */
+// Write a chunk with the given 4-character type and data, followed by its CRC.
+static bool writeChunk(QIODevice *device, const char *type, const char *data, qint64 length) {
+    char lengthBytes[4];
+    qToBigEndian<quint32>(static_cast<quint32>(length), lengthBytes);
 
-unsigned long update_crc(unsigned long crc, QByteArray buf,
-                         int len)
-{
-  unsigned long c = crc;
-  int n;
-
-  if (!crc_table_computed)
-    make_crc_table();
-  for (n = 0; n < len; n++) {
-    c = crc_table[(c ^ static_cast<unsigned char>(buf[n])) & 0xff] ^ (c >> 8);
-  }
-  return c;
+    quint32 crc = updateCrc(0xffffffffu, type, 4);
+    crc = updateCrc(crc, data, length);
+    char crcBytes[4];
+    qToBigEndian<quint32>(crc ^ 0xffffffffu, crcBytes);
+
+    return device->write(lengthBytes, 4) == 4
+        && device->write(type, 4) == 4
+        && (length == 0 || device->write(data, length) == length)
+        && device->write(crcBytes, 4) == 4;
+}
+
+static uchar paethPredictor(int a, int b, int c) {
+    int p = a + b - c;
+    int pa = qAbs(p - a);
+    int pb = qAbs(p - b);
+    int pc = qAbs(p - c);
+    if (pa <= pb && pa <= pc) return a;
+    if (pb <= pc) return b;
+    return c;
 }
 
-/* Return the CRC of the bytes buf[0..len-1]. */
-unsigned long crc(QByteArray buf, int len)
+// Filter a row of packed pixels into 'out', which starts with the filter type byte.
+// 'prev' is the previous unfiltered row, or all zeros for the first row.
+// With bit depths below 8 the "previous pixel" used by the filters is the previous byte.
+static void filterRow(PngRowFilter filter, const uchar *row, const uchar *prev, int length, uchar *out) {
+    out[0] = static_cast<uchar>(filter);
+    out++;
+    switch (filter) {
+    case PngRowFilter::Sub:
+        for (int i = 0; i < length; i++)
+            out[i] = row[i] - (i > 0 ? row[i - 1] : 0);
+        break;
+    case PngRowFilter::Up:
+        for (int i = 0; i < length; i++)
+            out[i] = row[i] - prev[i];
+        break;
+    case PngRowFilter::Average:
+        for (int i = 0; i < length; i++)
+            out[i] = row[i] - (((i > 0 ? row[i - 1] : 0) + prev[i]) / 2);
+        break;
+    case PngRowFilter::Paeth:
+        for (int i = 0; i < length; i++)
+            out[i] = row[i] - paethPredictor(i > 0 ? row[i - 1] : 0, prev[i], i > 0 ? prev[i - 1] : 0);
+        break;
+    default:
+        memcpy(out, row, length);
+        break;
+    }
+}
+
+// Choose the filter that minimizes the sum of the filtered bytes (as signed values), which is the heuristic recommended by the PNG spec.
+static void filterRowAdaptive(const uchar *row, const uchar *prev, int length, uchar *out, QByteArray *scratch) {
+    quint64 bestSum = std::numeric_limits<quint64>::max();
+    for (PngRowFilter filter : {PngRowFilter::None, PngRowFilter::Sub, PngRowFilter::Up, PngRowFilter::Average, PngRowFilter::Paeth}) {
+        uchar *candidate = reinterpret_cast<uchar*>(scratch->data());
+        filterRow(filter, row, prev, length, candidate);
+        quint64 sum = 0;
+        for (int i = 1; i <= length; i++)
+            sum += qAbs(static_cast<int>(static_cast<signed char>(candidate[i])));
+        if (sum < bestSum) {
+            bestSum = sum;
+            memcpy(out, candidate, length + 1);
+        }
+    }
+}
+
+// Compresses the image data with zlib as it's given, and writes the compressed data to IDAT chunks of a bounded size.
+class IdatWriter
 {
-  return update_crc(0xffffffffL, buf, len) ^ 0xffffffffL;
+public:
+    IdatWriter(QIODevice *device, int compressionLevel) : m_device(device), m_buffer(maxIdatLength, Qt::Uninitialized) {
+        m_stream.zalloc = Z_NULL;
+        m_stream.zfree = Z_NULL;
+        m_stream.opaque = Z_NULL;
+        m_initialized = (deflateInit(&m_stream, qBound(-1, compressionLevel, 9)) == Z_OK);
+        resetOutput();
+    }
+    ~IdatWriter() {
+        if (m_initialized)
+            deflateEnd(&m_stream);
+    }
+
+    bool isValid() const { return m_initialized; }
+    QString errorString() const { return m_error; }
+
+    bool write(const uchar *data, int length) {
+        m_stream.next_in = const_cast<Bytef*>(data);
+        m_stream.avail_in = static_cast<uInt>(length);
+        while (m_stream.avail_in > 0) {
+            if (!deflateStep(Z_NO_FLUSH))
+                return false;
+        }
+        return true;
+    }
+
+    // Compress anything that's still buffered by zlib, and write the last chunk.
+    bool finish() {
+        m_stream.next_in = Z_NULL;
+        m_stream.avail_in = 0;
+        while (!m_finished) {
+            if (!deflateStep(Z_FINISH))
+                return false;
+        }
+        return writeOutput();
+    }
+
+private:
+    static const int maxIdatLength = 0x10000;
+
+    QIODevice *m_device;
+    z_stream m_stream;
+    QByteArray m_buffer;
+    bool m_initialized = false;
+    bool m_finished = false;
+    QString m_error;
+
+    void resetOutput() {
+        m_stream.next_out = reinterpret_cast<Bytef*>(m_buffer.data());
+        m_stream.avail_out = static_cast<uInt>(m_buffer.size());
+    }
+
+    // Write the compressed data in the output buffer as an IDAT chunk.
+    bool writeOutput() {
+        const int length = m_buffer.size() - static_cast<int>(m_stream.avail_out);
+        if (length > 0 && !writeChunk(m_device, "IDAT", m_buffer.constData(), length)) {
+            m_error = m_device->errorString();
+            return false;
+        }
+        resetOutput();
+        return true;
+    }
+
+    bool deflateStep(int flush) {
+        const int result = deflate(&m_stream, flush);
+        if (result == Z_STREAM_END) {
+            m_finished = true;
+        } else if (result != Z_OK && result != Z_BUF_ERROR) {
+            m_error = QString("Failed to compress the image data (zlib error %1).").arg(result);
+            return false;
+        }
+        // Chunks are only written once the output buffer is full (or the stream has ended).
+        if (m_stream.avail_out == 0)
+            return writeOutput();
+        return true;
+    }
+};
+
+bool writeIndexed4BPPPng(const QImage &sourceImage, QIODevice *device, int compressionLevel, PngRowFilter filter, QString *errorString) {
+    auto fail = [errorString](const QString &error) {
+        if (errorString) *errorString = error;
+        return false;
+    };
+
+    if (sourceImage.isNull())
+        return fail("The image is null.");
+    if (!device || !device->isWritable())
+        return fail("The device is not writable.");
+
+    // Rows are read directly from the image data, which needs one byte per pixel.
+    const QImage image = (sourceImage.format() == QImage::Format_Indexed8) ? sourceImage : sourceImage.convertToFormat(QImage::Format_Indexed8);
+    const int width = image.width();
+    const int height = image.height();
+
+    // Header
+    static const char pngSignature[8] = { static_cast<char>(0x89), 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A };
+    if (device->write(pngSignature, sizeof(pngSignature)) != sizeof(pngSignature))
+        return fail(device->errorString());
+
+    // IHDR Chunk
+    char ihdr[13];
+    qToBigEndian<quint32>(width, ihdr);
+    qToBigEndian<quint32>(height, ihdr + 4);
+    ihdr[8] = 4;  // bit depth
+    ihdr[9] = 3;  // indexed color type
+    ihdr[10] = 0; // compression method
+    ihdr[11] = 0; // filter method
+    ihdr[12] = 0; // interlace method
+    if (!writeChunk(device, "IHDR", ihdr, sizeof(ihdr)))
+        return fail(device->errorString());
+
+    // PLTE Chunk. A bit depth of 4 allows at most 16 colors.
+    const QVector<QRgb> colorTable = image.colorTable();
+    const int numColors = qMin(colorTable.length(), 16);
+    QByteArray plte;
+    plte.reserve(numColors * 3);
+    for (int i = 0; i < numColors; i++) {
+        plte.append(static_cast<char>(qRed(colorTable.at(i))));
+        plte.append(static_cast<char>(qGreen(colorTable.at(i))));
+        plte.append(static_cast<char>(qBlue(colorTable.at(i))));
+    }
+    if (!writeChunk(device, "PLTE", plte.constData(), plte.length()))
+        return fail(device->errorString());
+
+    // IDAT Chunks. Each row is packed to two pixels per byte and filtered. Filtered rows are
+    // collected into batches of about 64 KiB, which are compressed as they're filled.
+    IdatWriter idat(device, compressionLevel);
+    if (!idat.isValid())
+        return fail("Failed to initialize compression.");
+
+    const int rowLength = (width + 1) / 2;
+    const int filteredRowLength = rowLength + 1;
+    const int rowsPerBatch = qBound(1, 0x10000 / filteredRowLength, height);
+    QByteArray batch(filteredRowLength * rowsPerBatch, Qt::Uninitialized);
+    QByteArray packedRows(rowLength * 2, 0); // The current row, followed by the previous row
+    QByteArray scratch(filteredRowLength, Qt::Uninitialized);
+    uchar *row = reinterpret_cast<uchar*>(packedRows.data());
+    uchar *prev = row + rowLength;
+    uchar *batchStart = reinterpret_cast<uchar*>(batch.data());
+    uchar *out = batchStart;
+    for (int y = 0; y < height; y++) {
+        const uchar *src = image.constScanLine(y);
+        for (int x = 0; x + 1 < width; x += 2)
+            row[x / 2] = ((src[x] & 0xF) << 4) | (src[x + 1] & 0xF);
+        if (width % 2)
+            row[rowLength - 1] = (src[width - 1] & 0xF) << 4;
+
+        if (filter == PngRowFilter::Adaptive) {
+            filterRowAdaptive(row, prev, rowLength, out, &scratch);
+        } else {
+            filterRow(filter, row, prev, rowLength, out);
+        }
+        out += filteredRowLength;
+        std::swap(row, prev);
+
+        if (out - batchStart == batch.size() || y == height - 1) {
+            if (!idat.write(batchStart, static_cast<int>(out - batchStart)))
+                return fail(idat.errorString());
+            out = batchStart;
+        }
+    }
+    if (!idat.finish())
+        return fail(idat.errorString());
+
+    // IEND Chunk
+    if (!writeChunk(device, "IEND", nullptr, 0))
+        return fail(device->errorString());
+
+    return true;
 }
 
 // Qt does not have the ability to export indexed PNG files with a
@@ -68,125 +298,15 @@ void exportIndexed4BPPPng(QImage image, QString filepath)
         return;
     }
 
-    // Header
-    QByteArray pngHeader;
-    pngHeader.append(static_cast<char>(0x89));
-    pngHeader.append("PNG");
-    pngHeader.append(static_cast<char>(0x0D));
-    pngHeader.append(static_cast<char>(0x0A));
-    pngHeader.append(static_cast<char>(0x1A));
-    pngHeader.append(static_cast<char>(0x0A));
-
-    // IHDR Chunk
-    QByteArray ihdr;
-    ihdr.append("IHDR");
-    int width = image.width();
-    ihdr.append(static_cast<char>((width >> 24) & 0xFF));
-    ihdr.append(static_cast<char>((width >> 16) & 0xFF));
-    ihdr.append(static_cast<char>((width >>  8) & 0xFF));
-    ihdr.append(static_cast<char>((width >>  0) & 0xFF));
-    int height = image.height();
-    ihdr.append(static_cast<char>((height >> 24) & 0xFF));
-    ihdr.append(static_cast<char>((height >> 16) & 0xFF));
-    ihdr.append(static_cast<char>((height >>  8) & 0xFF));
-    ihdr.append(static_cast<char>((height >>  0) & 0xFF));
-    ihdr.append(static_cast<char>(4)); // bit depth
-    ihdr.append(static_cast<char>(3)); // indexed color type
-    ihdr.append(static_cast<char>(0)); // compression method
-    ihdr.append(static_cast<char>(0)); // filter method
-    ihdr.append(static_cast<char>(0)); // interlace method
-    unsigned long ihdrCRC = crc(ihdr, 17);
-    ihdr.append(static_cast<char>((ihdrCRC >> 24) & 0xFF));
-    ihdr.append(static_cast<char>((ihdrCRC >> 16) & 0xFF));
-    ihdr.append(static_cast<char>((ihdrCRC >>  8) & 0xFF));
-    ihdr.append(static_cast<char>((ihdrCRC >>  0) & 0xFF));
-
-    // PLTE Chunk
-    int numColors = image.colorCount();
-    QByteArray plte;
-    plte.append("PLTE");
-    for (int i = 0; i < numColors; i++) {
-        QRgb rgb = image.colorTable().at(i);
-        plte.append(static_cast<char>(qRed(rgb)));
-        plte.append(static_cast<char>(qGreen(rgb)));
-        plte.append(static_cast<char>(qBlue(rgb)));
-    }
-    unsigned long plteCRC = crc(plte, numColors * 3 + 4);
-    plte.append(static_cast<char>((plteCRC >> 24) & 0xFF));
-    plte.append(static_cast<char>((plteCRC >> 16) & 0xFF));
-    plte.append(static_cast<char>((plteCRC >>  8) & 0xFF));
-    plte.append(static_cast<char>((plteCRC >>  0) & 0xFF));
-
-    // IDAT Chunk
-    QByteArray idat;
-    idat.append("IDAT");
-    unsigned long count = 0;
-    char val = 0;
-
-    QByteArray pixelData;
-    for (int y = 0; y < image.height(); y++) {
-        pixelData.append(static_cast<char>(0));
-        for (int x = 0; x < image.width(); x++) {
-            int colorId = image.pixelIndex(x, y);
-            if (count % 2 == 0) {
-                val = static_cast<char>(val & 0x0F) | static_cast<char>(colorId << 4);
-            } else {
-                val = static_cast<char>(val & 0xF0) | (static_cast<char>(colorId));
-                pixelData.append(val);
-            }
-            count++;
-        }
-    }
-    QByteArray compressedPixelData = qCompress(pixelData);
-    // Qt's qCompress/qDecompress use a pointless 4-byte header, even though
-    // they are using DEFLATE under the hood. If we strip the 4-byte header,
-    // it's perfectly compatible with the PNG compression spec.
-    compressedPixelData.remove(0, 4);
-    idat.append(compressedPixelData);
-    unsigned long idatCRC = crc(idat, compressedPixelData.length() + 4);
-    idat.append(static_cast<char>((idatCRC >> 24) & 0xFF));
-    idat.append(static_cast<char>((idatCRC >> 16) & 0xFF));
-    idat.append(static_cast<char>((idatCRC >>  8) & 0xFF));
-    idat.append(static_cast<char>((idatCRC >>  0) & 0xFF));
-
-    // IEND Chunk
-    QByteArray iend;
-    iend.append("IEND");
-    unsigned long iendCRC = crc(iend, 4);
-    iend.append(static_cast<char>((iendCRC >> 24) & 0xFF));
-    iend.append(static_cast<char>((iendCRC >> 16) & 0xFF));
-    iend.append(static_cast<char>((iendCRC >>  8) & 0xFF));
-    iend.append(static_cast<char>((iendCRC >>  0) & 0xFF));
-
-    QByteArray data;
-    data.append(pngHeader);
-    data.append(static_cast<char>(((ihdr.length() - 8) >> 24) & 0xFF));
-    data.append(static_cast<char>(((ihdr.length() - 8) >> 16) & 0xFF));
-    data.append(static_cast<char>(((ihdr.length() - 8) >>  8) & 0xFF));
-    data.append(static_cast<char>(((ihdr.length() - 8) >>  0) & 0xFF));
-    data.append(ihdr);
-    data.append(static_cast<char>(((plte.length() - 8) >> 24) & 0xFF));
-    data.append(static_cast<char>(((plte.length() - 8) >> 16) & 0xFF));
-    data.append(static_cast<char>(((plte.length() - 8) >>  8) & 0xFF));
-    data.append(static_cast<char>(((plte.length() - 8) >>  0) & 0xFF));
-    data.append(plte);
-    data.append(static_cast<char>(((idat.length() - 8) >> 24) & 0xFF));
-    data.append(static_cast<char>(((idat.length() - 8) >> 16) & 0xFF));
-    data.append(static_cast<char>(((idat.length() - 8) >>  8) & 0xFF));
-    data.append(static_cast<char>(((idat.length() - 8) >>  0) & 0xFF));
-    data.append(idat);
-    data.append(static_cast<char>(((iend.length() - 8) >> 24) & 0xFF));
-    data.append(static_cast<char>(((iend.length() - 8) >> 16) & 0xFF));
-    data.append(static_cast<char>(((iend.length() - 8) >>  8) & 0xFF));
-    data.append(static_cast<char>(((iend.length() - 8) >>  0) & 0xFF));
-    data.append(iend);
-
     QFile file(filepath);
     if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
         logError(QString("Could not save '%1'. ").arg(filepath) + file.errorString());
         return;
     }
 
-    file.write(data);
+    QString error;
+    if (!writeIndexed4BPPPng(image, &file, -1, PngRowFilter::None, &error)) {
+        logError(QString("Could not save '%1'. ").arg(filepath) + error);
+    }
     file.close();
 }
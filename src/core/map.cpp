@@ -5,6 +5,7 @@
 #include "utility.h"
 #include "editcommands.h"
 #include "project.h"
+#include "filewatcher.h"
 
 #include <QTime>
 #include <QPainter>
@@ -43,6 +44,7 @@ Map::Map(const Map &other, QObject *parent) : Map(parent) {
 }
 
 Map::~Map() {
+    stopWatchingScripts();
     qDeleteAll(m_ownedEvents);
     m_ownedEvents.clear();
     deleteConnections();
@@ -102,13 +104,19 @@ QPixmap Map::renderConnection(const QString &direction, Layout * fromLayout) {
     if (!bounds.isValid())
         return QPixmap();
 
-    // 'fromLayout' will be used in 'render' to get the palettes from the parent map.
+    // 'fromLayout' will be used in 'renderArea' to get the palettes from the parent map.
     // Dive/Emerge connections render normally with their own palettes, so we ignore this.
     if (MapConnection::isDiving(direction))
         fromLayout = nullptr;
 
-    QPixmap connectionPixmap = m_layout->render(true, fromLayout, bounds);
-    return connectionPixmap.copy(bounds);
+    // Only render the metatiles covered by the connection, rather than the connected map's full layout image.
+    // The result is cached by the layout, so displaying a neighboring map again doesn't need to render it again.
+    const QRect area(bounds.left() / Metatile::pixelWidth(),
+                     bounds.top() / Metatile::pixelHeight(),
+                     (bounds.right() / Metatile::pixelWidth()) - (bounds.left() / Metatile::pixelWidth()) + 1,
+                     (bounds.bottom() / Metatile::pixelHeight()) - (bounds.top() / Metatile::pixelHeight()) + 1);
+    QImage image = m_layout->renderAreaCached(area, fromLayout);
+    return QPixmap::fromImage(image.copy(bounds.translated(-area.left() * Metatile::pixelWidth(), -area.top() * Metatile::pixelHeight())));
 }
 
 void Map::openScript(const QString &label) {
@@ -124,13 +132,47 @@ void Map::setSharedScriptsMap(const QString &sharedScriptsMap) {
 
 void Map::invalidateScripts() {
     m_scriptsLoaded = false;
+    stopWatchingScripts();
+    emit scriptsModified();
+}
 
-    // m_scriptFileWatcher is a QPointer so clearing it shouldn't be necessary,
-    // but it's possible that Map::getScriptLabels will be called before events are processed.
-    delete m_scriptFileWatcher;
-    m_scriptFileWatcher = nullptr;
+void Map::stopWatchingScripts() {
+    if (m_watchedScriptsFilepath.isEmpty())
+        return;
+    FileWatcher::instance()->removeFile(m_watchedScriptsFilepath);
+    m_watchedScriptsFilepath.clear();
+}
 
-    emit scriptsModified();
+void Map::checkScriptsFileChanged(const QStringList &filepaths) {
+    if (!m_watchedScriptsFilepath.isEmpty() && filepaths.contains(m_watchedScriptsFilepath))
+        invalidateScripts();
+}
+
+// Approximate memory used by the map's own data. Its layout is measured separately, because layouts can be shared between maps.
+MemoryUsage Map::memoryBreakdown() const {
+    MemoryUsage usage(m_name);
+
+    const QList<Event*> events = getEvents();
+    qint64 pixmapsSize = 0;
+    int numFrames = 0;
+    for (const auto &event : events) {
+        pixmapsSize += Util::memoryUsage(event->getPixmap());
+        if (event->hasEventFrame())
+            numFrames++;
+    }
+    usage.add("Event pixmaps", pixmapsSize, events.size());
+
+    // The frames are widgets, so we can only report how many of them are alive.
+    MemoryUsage &frames = usage.add("Event frames", 0, numFrames);
+    frames.note = QStringLiteral("Widget memory is not measured");
+
+    qint64 labelsSize = 0;
+    for (const auto &label : m_scriptLabels) {
+        labelsSize += label.size() * static_cast<qint64>(sizeof(QChar));
+    }
+    usage.add("Script labels", labelsSize, m_scriptLabels.size());
+    usage.add("Edit history", editHistoryMemoryUsage(m_editHistory), m_editHistory ? m_editHistory->count() : 0);
+    return usage;
 }
 
 QStringList Map::getScriptLabels(Event::Group group) {
@@ -150,25 +192,19 @@ QStringList Map::getScriptLabels(Event::Group group) {
             m_loggedScriptsFileError = true;
         }
 
-        if (m_fileWatchingEnabled && !m_loggedScriptsFileError) {
-            if (!m_scriptFileWatcher) {
-                // Only create the file watcher when it's first needed (even an empty QFileSystemWatcher will consume system resources).
-                // The other option would be for Porymap to have a single global QFileSystemWatcher, but that has complications of its own.
-                m_scriptFileWatcher = new QFileSystemWatcher(this);
-                connect(m_scriptFileWatcher, &QFileSystemWatcher::fileChanged, this, &Map::invalidateScripts);
-            }
-            // m_scriptFileWatcher can stil be nullptr here if the inotify limit was reached on Linux.
-            // Porymap isn't using enough resources in general for this to be a problem, but the user may have lowered the inotify limit.
-            if (!m_scriptFileWatcher) {
-                logWarn(QString("Failed to add scripts file '%1' to file watcher for %2: Reached system resource limit.")
-                                .arg(Util::stripPrefix(scriptsFilepath, projectConfig.projectDir() + "/"))
-                                .arg(m_name));
-                m_loggedScriptsFileError = true;
-            } else if (!m_scriptFileWatcher->files().contains(scriptsFilepath) && !m_scriptFileWatcher->addPath(scriptsFilepath)) {
+        if (m_fileWatchingEnabled && !m_loggedScriptsFileError && m_watchedScriptsFilepath != scriptsFilepath) {
+            stopWatchingScripts();
+            // Scripts files are watched by the same FileWatcher as the project's files. It only needs a system watch
+            // for each directory of scripts files, but the user may have lowered the inotify limit.
+            FileWatcher *fileWatcher = FileWatcher::instance();
+            if (!fileWatcher->addFile(scriptsFilepath)) {
                 logWarn(QString("Failed to add scripts file '%1' to file watcher for %2.")
                                 .arg(Util::stripPrefix(scriptsFilepath, projectConfig.projectDir() + "/"))
                                 .arg(m_name));
                 m_loggedScriptsFileError = true;
+            } else {
+                m_watchedScriptsFilepath = scriptsFilepath;
+                connect(fileWatcher, &FileWatcher::filesChanged, this, &Map::checkScriptsFileChanged, Qt::UniqueConnection);
             }
         }
 
@@ -1,12 +1,16 @@
 #include "maplayout.h"
 
 #include <QRegularExpression>
+#include <algorithm>
+#include <iterator>
 
 #include "scripting.h"
 #include "imageproviders.h"
 #include "utility.h"
 #include "project.h"
 #include "layoutpixmapitem.h"
+#include "collisionpixmapitem.h"
+#include "paintprofiler.h"
 
 QList<int> Layout::s_globalMetatileLayerOrder;
 QList<float> Layout::s_globalMetatileLayerOpacity;
@@ -37,6 +41,7 @@ void Layout::copyFrom(const Layout *other) {
     this->blockdata = other->blockdata;
     this->border = other->border;
     this->customData = other->customData;
+    invalidateBlockIndex();
 }
 
 QString Layout::layoutConstantFromName(const QString &name) {
@@ -116,6 +121,9 @@ void Layout::setBlock(int x, int y, Block block, bool enableScriptCallback) {
     if (i < this->blockdata.size()) {
         Block prevBlock = this->blockdata.at(i);
         this->blockdata.replace(i, block);
+        updateBlockIndex(i, prevBlock, block);
+        if (prevBlock != block)
+            recordBlockChange(i);
         if (enableScriptCallback) {
             Scripting::cb_MetatileChanged(x, y, prevBlock, block);
         }
@@ -130,6 +138,8 @@ void Layout::setBlockdata(Blockdata newBlockdata, bool enableScriptCallback) {
         Block newBlock = newBlockdata.at(i);
         if (prevBlock != newBlock) {
             this->blockdata.replace(i, newBlock);
+            updateBlockIndex(i, prevBlock, newBlock);
+            recordBlockChange(i);
             if (enableScriptCallback)
                 Scripting::cb_MetatileChanged(i % width, i / width, prevBlock, newBlock);
         }
@@ -150,6 +160,172 @@ bool Layout::setMetatileId(int x, int y, uint16_t metatileId, bool enableScriptC
     return true;
 }
 
+QList<QPoint> Layout::getMetatilePositions(uint16_t metatileId) {
+    if (!updateBlockIndex())
+        return {};
+    auto it = m_metatileIndex.find(metatileId);
+    return (it != m_metatileIndex.end()) ? getIndexedPositions(&it.value()) : QList<QPoint>();
+}
+
+QList<QPoint> Layout::getCollisionPositions(uint16_t collision, uint16_t elevation) {
+    if (!updateBlockIndex())
+        return {};
+    auto it = m_collisionIndex.find(collisionIndexKey(collision, elevation));
+    return (it != m_collisionIndex.end()) ? getIndexedPositions(&it.value()) : QList<QPoint>();
+}
+
+QList<QPoint> Layout::getIndexedPositions(BlockIndexEntry *entry) const {
+    // Bring the list up to date with the blocks that changed since it was last queried.
+    // A block that changes away and back is in both 'added' and 'removed', so each removal cancels out one occurrence.
+    if (!entry->added.isEmpty() || !entry->removed.isEmpty()) {
+        std::sort(entry->added.begin(), entry->added.end());
+        std::sort(entry->removed.begin(), entry->removed.end());
+        QVector<int> merged;
+        merged.reserve(entry->indexes.length() + entry->added.length());
+        std::merge(entry->indexes.constBegin(), entry->indexes.constEnd(), entry->added.constBegin(), entry->added.constEnd(), std::back_inserter(merged));
+        entry->indexes.clear();
+        std::set_difference(merged.constBegin(), merged.constEnd(), entry->removed.constBegin(), entry->removed.constEnd(), std::back_inserter(entry->indexes));
+        entry->indexes.squeeze();
+        entry->added.clear();
+        entry->removed.clear();
+    }
+
+    QList<QPoint> positions;
+    positions.reserve(entry->indexes.length());
+    for (const int &i : entry->indexes) {
+        positions.append(QPoint(i % this->width, i / this->width));
+    }
+    return positions;
+}
+
+void Layout::invalidateBlockIndex() {
+    m_blockIndexValid = false;
+    m_metatileIndex.clear();
+    m_collisionIndex.clear();
+    markAllBlocksChanged();
+}
+
+void Layout::recordBlockChange(int i) {
+    // Once more blocks have been recorded than the layout has, redrawing everything is no slower.
+    if (m_blockChanges.length() >= qMax(this->blockdata.length(), 1024)) {
+        markAllBlocksChanged();
+        return;
+    }
+    m_blockChanges.append(i);
+}
+
+void Layout::markAllBlocksChanged() {
+    // Skip a change count, so that no view's last count is still within the record.
+    m_blockChangesStart += m_blockChanges.length() + 1;
+    m_blockChanges.clear();
+}
+
+bool Layout::getChangedBlocks(quint64 since, QVector<int> *changedBlocks) const {
+    if (since < m_blockChangesStart || since > blockChangeCount())
+        return false;
+    *changedBlocks = m_blockChanges.mid(static_cast<int>(since - m_blockChangesStart));
+    return true;
+}
+
+// Build the block index if it isn't valid. Returns false if the layout has no blocks to index.
+bool Layout::updateBlockIndex() {
+    if (this->width <= 0 || this->height <= 0 || this->blockdata.length() != this->width * this->height) {
+        invalidateBlockIndex();
+        return false;
+    }
+    if (m_blockIndexValid)
+        return true;
+
+    // Blocks are visited in order, so each list is sorted as it's built.
+    m_metatileIndex.clear();
+    m_collisionIndex.clear();
+    for (int i = 0; i < this->blockdata.length(); i++) {
+        const Block &block = this->blockdata.at(i);
+        m_metatileIndex[block.metatileId()].indexes.append(i);
+        m_collisionIndex[collisionIndexKey(block.collision(), block.elevation())].indexes.append(i);
+    }
+    m_blockIndexValid = true;
+    return true;
+}
+
+void Layout::updateBlockIndex(int i, const Block &prevBlock, const Block &newBlock) {
+    if (!m_blockIndexValid)
+        return;
+
+    if (prevBlock.metatileId() != newBlock.metatileId()) {
+        auto it = m_metatileIndex.find(prevBlock.metatileId());
+        if (it != m_metatileIndex.end())
+            it.value().removed.append(i);
+        m_metatileIndex[newBlock.metatileId()].added.append(i);
+    }
+
+    const quint32 prevKey = collisionIndexKey(prevBlock.collision(), prevBlock.elevation());
+    const quint32 newKey = collisionIndexKey(newBlock.collision(), newBlock.elevation());
+    if (prevKey != newKey) {
+        auto it = m_collisionIndex.find(prevKey);
+        if (it != m_collisionIndex.end())
+            it.value().removed.append(i);
+        m_collisionIndex[newKey].added.append(i);
+    }
+}
+
+// Approximate number of bytes used by the layout's block data and rendered images.
+// This is what unloading the layout would free, so it excludes the edit history.
+qint64 Layout::memoryUsage() const {
+    return memoryBreakdown().total();
+}
+
+MemoryUsage Layout::memoryBreakdown() const {
+    const qint64 blockSize = sizeof(Block);
+    MemoryUsage usage(this->id);
+    usage.add("Block data", (this->blockdata.size() + this->border.size()) * blockSize);
+    usage.add("Cached block data", (this->cached_blockdata.size() + this->cached_border.size()) * blockSize);
+    usage.add("Cached collision", this->cached_collision.size() * blockSize);
+    usage.add("Last commit", (this->lastCommitBlocks.blocks.size() + this->lastCommitBlocks.border.size()) * blockSize);
+    usage.add("Images", Util::memoryUsage(this->image)
+                      + Util::memoryUsage(this->border_image)
+                      + Util::memoryUsage(this->collision_image));
+    usage.add("Pixmaps", Util::memoryUsage(this->pixmap)
+                       + Util::memoryUsage(this->border_pixmap)
+                       + Util::memoryUsage(this->collision_pixmap));
+    usage.add("Area render cache", static_cast<qint64>(m_areaRenderCache.totalCost()) * 1024, m_areaRenderCache.count());
+    qint64 blockIndexSize = 0;
+    for (const auto &entry : m_metatileIndex)
+        blockIndexSize += (entry.indexes.capacity() + entry.added.capacity() + entry.removed.capacity()) * static_cast<qint64>(sizeof(int));
+    for (const auto &entry : m_collisionIndex)
+        blockIndexSize += (entry.indexes.capacity() + entry.added.capacity() + entry.removed.capacity()) * static_cast<qint64>(sizeof(int));
+    usage.add("Block index", blockIndexSize, m_metatileIndex.count() + m_collisionIndex.count());
+    usage.add("Block changes", m_blockChanges.capacity() * static_cast<qint64>(sizeof(int)), m_blockChanges.length());
+    // Only the layout that's open in the editor has items.
+    if (this->layoutItem)
+        usage.add(this->layoutItem->memoryBreakdown("Metatiles view"));
+    if (this->collisionItem)
+        usage.add(this->collisionItem->memoryBreakdown("Collision view"));
+    return usage;
+}
+
+// Release the layout's block data, rendered images, and tilesets. The layout must be loaded again before it can be used.
+// Its properties (dimensions, file paths, tileset labels, etc.) are kept.
+void Layout::unload() {
+    this->blockdata.clear();
+    this->border.clear();
+    this->cached_blockdata.clear();
+    this->cached_collision.clear();
+    this->cached_border.clear();
+    this->lastCommitBlocks.blocks.clear();
+    this->lastCommitBlocks.border.clear();
+    this->image = QImage();
+    this->pixmap = QPixmap();
+    this->border_image = QImage();
+    this->border_pixmap = QPixmap();
+    this->collision_image = QImage();
+    this->collision_pixmap = QPixmap();
+    m_areaRenderCache.clear();
+    invalidateBlockIndex();
+    this->tileset_primary = nullptr;
+    this->tileset_secondary = nullptr;
+}
+
 void Layout::clearBorderCache() {
     this->cached_border.clear();
 }
@@ -217,6 +393,7 @@ void Layout::setDimensions(int newWidth, int newHeight, bool setNewBlockdata) {
     }
     this->width = newWidth;
     this->height = newHeight;
+    invalidateBlockIndex();
     emit dimensionsChanged(QSize(this->width, this->height));
 }
 
@@ -227,20 +404,10 @@ void Layout::adjustDimensions(const QMargins &margins, bool setNewBlockdata) {
     this->height = oldHeight + margins.top() + margins.bottom();
 
     if (setNewBlockdata) {
-        // Fill new blockdata
-        Blockdata newBlockdata;
-        for (int y = 0; y < this->height; y++)
-        for (int x = 0; x < this->width; x++) {
-            if ((x < margins.left()) || (x >= this->width - margins.right()) || (y < margins.top()) || (y >= this->height - margins.bottom())) {
-                newBlockdata.append(0);
-            } else {
-                int index = (y - margins.top()) * oldWidth + (x - margins.left());
-                newBlockdata.append(this->blockdata.value(index));
-            }
-        }
-        this->blockdata = newBlockdata;
+        this->blockdata = resizeBlockdata(this->blockdata, QSize(oldWidth, oldHeight), QSize(this->width, this->height), QPoint(margins.left(), margins.top()));
     }
 
+    invalidateBlockIndex();
     Scripting::cb_MapResized(oldWidth, oldHeight, margins);
     emit dimensionsChanged(QSize(this->width, this->height));
 }
@@ -261,22 +428,75 @@ void Layout::setBorderDimensions(int newWidth, int newHeight, bool setNewBlockda
 }
 
 void Layout::setNewDimensionsBlockdata(int newWidth, int newHeight) {
-    int oldWidth = getWidth();
-    int oldHeight = getHeight();
-
-    Blockdata newBlockdata;
+    this->blockdata = resizeBlockdata(this->blockdata, QSize(getWidth(), getHeight()), QSize(newWidth, newHeight));
+}
+
+// Copy the blocks of a grid with dimensions 'oldSize' into a new grid with dimensions 'newSize', with the old grid's
+// top-left corner placed at 'offset'. Blocks that end up outside the new grid are dropped, and new space is filled with 0.
+Blockdata Layout::resizeBlockdata(const Blockdata &blocks, const QSize &oldSize, const QSize &newSize, const QPoint &offset) {
+    Blockdata newBlocks;
+    if (newSize.width() <= 0 || newSize.height() <= 0)
+        return newBlocks;
+    newBlocks.fill(Block(0), newSize.width() * newSize.height());
+
+    // Copy each row of the area that's in both grids at once, rather than block by block.
+    const QRect copyArea = QRect(offset, oldSize) & QRect(QPoint(0, 0), newSize);
+    for (int y = copyArea.top(); y <= copyArea.bottom(); y++) {
+        const int srcIndex = (y - offset.y()) * oldSize.width() + (copyArea.left() - offset.x());
+        const int destIndex = y * newSize.width() + copyArea.left();
+        if (srcIndex < 0 || srcIndex + copyArea.width() > blocks.length())
+            continue;
+        std::copy(blocks.constBegin() + srcIndex, blocks.constBegin() + srcIndex + copyArea.width(), newBlocks.begin() + destIndex);
+    }
+    return newBlocks;
+}
 
-    for (int y = 0; y < newHeight; y++)
-    for (int x = 0; x < newWidth; x++) {
-        if (x < oldWidth && y < oldHeight) {
-            int index = y * oldWidth + x;
-            newBlockdata.append(this->blockdata.value(index));
-        } else {
-            newBlockdata.append(0);
+// Rotate the rows of a grid right by 'xDelta' and down by 'yDelta', wrapping around the edges. Deltas must be within the grid's dimensions.
+template <typename T>
+static void rotateGrid(T *data, int rowLength, int rowStride, int numRows, int xDelta, int yDelta) {
+    if (xDelta > 0) {
+        for (int y = 0; y < numRows; y++) {
+            T *row = data + y * rowStride;
+            std::rotate(row, row + (rowLength - xDelta), row + rowLength);
         }
     }
+    if (yDelta > 0) {
+        std::rotate(data, data + (numRows - yDelta) * rowStride, data + numRows * rowStride);
+    }
+}
+
+static void rotateImage(QImage *image, int xDelta, int yDelta) {
+    const int bytesPerPixel = image->depth() / 8;
+    rotateGrid(image->bits(), image->width() * bytesPerPixel, image->bytesPerLine(), image->height(), xDelta * bytesPerPixel, yDelta);
+}
+
+// Move every block by the given amount, wrapping around the edges of the layout.
+// The layout's rendered images are moved along with their block caches, so nothing needs to be rendered again.
+void Layout::shiftBlocks(int xDelta, int yDelta) {
+    const int w = this->width;
+    const int h = this->height;
+    if (w <= 0 || h <= 0 || this->blockdata.length() != w * h)
+        return;
+    xDelta = ((xDelta % w) + w) % w;
+    yDelta = ((yDelta % h) + h) % h;
+    if (xDelta == 0 && yDelta == 0)
+        return;
 
-    this->blockdata = newBlockdata;
+    rotateGrid(this->blockdata.data(), w, w, h, xDelta, yDelta);
+    invalidateBlockIndex();
+
+    const int pixelX = xDelta * Metatile::pixelWidth();
+    const int pixelY = yDelta * Metatile::pixelHeight();
+    if (this->cached_blockdata.length() == w * h && this->image.size() == pixelSize() && this->image.depth() % 8 == 0) {
+        rotateGrid(this->cached_blockdata.data(), w, w, h, xDelta, yDelta);
+        rotateImage(&this->image, pixelX, pixelY);
+        this->pixmap = QPixmap::fromImage(this->image);
+    }
+    if (this->cached_collision.length() == w * h && this->collision_image.size() == pixelSize() && this->collision_image.depth() % 8 == 0) {
+        rotateGrid(this->cached_collision.data(), w, w, h, xDelta, yDelta);
+        rotateImage(&this->collision_image, pixelX, pixelY);
+        this->collision_pixmap = QPixmap::fromImage(this->collision_image);
+    }
 }
 
 void Layout::setNewBorderDimensionsBlockdata(int newWidth, int newHeight) {
@@ -344,22 +564,18 @@ void Layout::floodFillCollisionElevation(int x, int y, uint16_t collision, uint1
 void Layout::magicFillCollisionElevation(int initialX, int initialY, uint16_t collision, uint16_t elevation) {
     Block block;
     if (getBlock(initialX, initialY, &block) && (block.collision() != collision || block.elevation() != elevation)) {
-        uint old_coll = block.collision();
-        uint old_elev = block.elevation();
-
-        for (int y = 0; y < getHeight(); y++) {
-            for (int x = 0; x < getWidth(); x++) {
-                if (getBlock(x, y, &block) && block.collision() == old_coll && block.elevation() == old_elev) {
-                    block.setCollision(collision);
-                    block.setElevation(elevation);
-                    setBlock(x, y, block, true);
-                }
+        for (const QPoint &pos : getCollisionPositions(block.collision(), block.elevation())) {
+            if (getBlock(pos, &block)) {
+                block.setCollision(collision);
+                block.setElevation(elevation);
+                setBlock(pos, block, true);
             }
         }
     }
 }
 
 QPixmap Layout::render(bool ignoreCache, Layout *fromLayout, const QRect &bounds) {
+    PaintProfiler::Scope profilerScope(PaintProfiler::Phase::Render);
     bool changed_any = false;
     if (this->image.isNull() || this->image.width() != pixelWidth() || this->image.height() != pixelHeight()) {
         this->image = QImage(pixelWidth(), pixelHeight(), QImage::Format_RGBA8888);
@@ -414,6 +630,7 @@ QPixmap Layout::render(bool ignoreCache, Layout *fromLayout, const QRect &bounds
 }
 
 QPixmap Layout::renderCollision(bool ignoreCache) {
+    PaintProfiler::Scope profilerScope(PaintProfiler::Phase::Render);
     bool changed_any = false;
     if (collision_image.isNull() || collision_image.width() != pixelWidth() || collision_image.height() != pixelHeight()) {
         collision_image = QImage(pixelWidth(), pixelHeight(), QImage::Format_RGBA8888);
@@ -423,19 +640,15 @@ QPixmap Layout::renderCollision(bool ignoreCache) {
         collision_pixmap = collision_pixmap.fromImage(collision_image);
         return collision_pixmap;
     }
-    QPainter painter(&collision_image);
     for (int i = 0; i < this->blockdata.length(); i++) {
         if (!ignoreCache && !layoutBlockChanged(i, this->blockdata, this->cached_collision)) {
             continue;
         }
         changed_any = true;
-        Block block = this->blockdata.at(i);
-        QImage collision_metatile_image = getCollisionMetatileImage(block);
         int x = this->width ? ((i % this->width) * Metatile::pixelWidth()) : 0;
         int y = this->width ? ((i / this->width) * Metatile::pixelHeight()) : 0;
-        painter.drawImage(x, y, collision_metatile_image);
+        drawCollisionMetatileImage(&collision_image, x, y, this->blockdata.at(i));
     }
-    painter.end();
     cacheCollision();
     if (changed_any) {
         collision_pixmap = collision_pixmap.fromImage(collision_image);
@@ -444,6 +657,7 @@ QPixmap Layout::renderCollision(bool ignoreCache) {
 }
 
 QPixmap Layout::renderBorder(bool ignoreCache) {
+    PaintProfiler::Scope profilerScope(PaintProfiler::Phase::Render);
     bool changed_any = false, border_resized = false;
     int pixelWidth = this->border_width * Metatile::pixelWidth();
     int pixelHeight = this->border_height * Metatile::pixelHeight();
@@ -481,8 +695,138 @@ QPixmap Layout::renderBorder(bool ignoreCache) {
     return this->border_pixmap;
 }
 
+QImage Layout::renderArea(const QRect &area, Layout *fromLayout) {
+    PaintProfiler::Scope profilerScope(PaintProfiler::Phase::Render);
+    const QRect bounds = area & QRect(0, 0, this->width, this->height);
+    QImage areaImage(qMax(0, area.width()) * Metatile::pixelWidth(), qMax(0, area.height()) * Metatile::pixelHeight(), QImage::Format_RGBA8888);
+    areaImage.fill(Qt::transparent);
+    if (bounds.isEmpty() || this->blockdata.isEmpty())
+        return areaImage;
+
+    // Same per-request metatile image cache as in 'render'.
+    QHash<uint16_t, QImage> imageCache;
+
+    QPainter painter(&areaImage);
+    for (int y = bounds.top(); y <= bounds.bottom(); y++)
+    for (int x = bounds.left(); x <= bounds.right(); x++) {
+        Block block;
+        if (!getBlock(x, y, &block))
+            continue;
+
+        uint16_t metatileId = block.metatileId();
+        QImage metatileImage;
+        if (imageCache.contains(metatileId)) {
+            metatileImage = imageCache.value(metatileId);
+        } else {
+            metatileImage = getMetatileImage(
+                metatileId,
+                fromLayout ? fromLayout->tileset_primary   : this->tileset_primary,
+                fromLayout ? fromLayout->tileset_secondary : this->tileset_secondary,
+                metatileLayerOrder(),
+                metatileLayerOpacity()
+            );
+            imageCache.insert(metatileId, metatileImage);
+        }
+        painter.drawImage((x - area.x()) * Metatile::pixelWidth(), (y - area.y()) * Metatile::pixelHeight(), metatileImage);
+    }
+    painter.end();
+    return areaImage;
+}
+
+QImage Layout::renderThumbnail(int maxMetatiles) {
+    PaintProfiler::Scope profilerScope(PaintProfiler::Phase::Render);
+    const int step = qMax(1, (qMax(this->width, this->height) + maxMetatiles - 1) / qMax(1, maxMetatiles));
+    const int thumbnailWidth = (this->width + step - 1) / step;
+    const int thumbnailHeight = (this->height + step - 1) / step;
+    QImage thumbnail(thumbnailWidth * Metatile::pixelWidth(), thumbnailHeight * Metatile::pixelHeight(), QImage::Format_RGBA8888);
+    thumbnail.fill(Qt::transparent);
+    if (thumbnail.isNull() || this->blockdata.isEmpty())
+        return thumbnail;
+
+    QHash<uint16_t, QImage> imageCache;
+    QPainter painter(&thumbnail);
+    for (int y = 0; y < thumbnailHeight; y++)
+    for (int x = 0; x < thumbnailWidth; x++) {
+        Block block;
+        if (!getBlock(x * step, y * step, &block))
+            continue;
+
+        const uint16_t metatileId = block.metatileId();
+        auto it = imageCache.constFind(metatileId);
+        if (it == imageCache.constEnd()) {
+            it = imageCache.insert(metatileId, getMetatileImage(metatileId, this->tileset_primary, this->tileset_secondary,
+                                                                metatileLayerOrder(), metatileLayerOpacity()));
+        }
+        painter.drawImage(x * Metatile::pixelWidth(), y * Metatile::pixelHeight(), it.value());
+    }
+    painter.end();
+    return thumbnail;
+}
+
+QImage Layout::renderCollisionArea(const QRect &area) {
+    PaintProfiler::Scope profilerScope(PaintProfiler::Phase::Render);
+    const QRect bounds = area & QRect(0, 0, this->width, this->height);
+    QImage areaImage(qMax(0, area.width()) * Metatile::pixelWidth(), qMax(0, area.height()) * Metatile::pixelHeight(), QImage::Format_RGBA8888);
+    areaImage.fill(Qt::transparent);
+    if (bounds.isEmpty() || this->blockdata.isEmpty())
+        return areaImage;
+
+    for (int y = bounds.top(); y <= bounds.bottom(); y++)
+    for (int x = bounds.left(); x <= bounds.right(); x++) {
+        Block block;
+        if (getBlock(x, y, &block)) {
+            drawCollisionMetatileImage(&areaImage, (x - area.x()) * Metatile::pixelWidth(), (y - area.y()) * Metatile::pixelHeight(), block);
+        }
+    }
+    return areaImage;
+}
+
+Blockdata Layout::getAreaBlocks(const QRect &area) const {
+    Blockdata blocks;
+    const QRect bounds = area & QRect(0, 0, this->width, this->height);
+    if (bounds.isEmpty() || this->blockdata.isEmpty())
+        return blocks;
+
+    blocks.reserve(bounds.width() * bounds.height());
+    for (int y = bounds.top(); y <= bounds.bottom(); y++)
+    for (int x = bounds.left(); x <= bounds.right(); x++) {
+        Block block;
+        getBlock(x, y, &block);
+        blocks.append(block);
+    }
+    return blocks;
+}
+
+QImage Layout::renderAreaCached(const QRect &area, Layout *fromLayout) {
+    // Tileset revisions are unique, so any change to the tilesets used to draw the area results in a new key.
+    // Old entries are left to be evicted by the cache.
+    const Tileset *primaryTileset = fromLayout ? fromLayout->tileset_primary : this->tileset_primary;
+    const Tileset *secondaryTileset = fromLayout ? fromLayout->tileset_secondary : this->tileset_secondary;
+    const QString key = QString("%1,%2,%3,%4:%5:%6").arg(area.x()).arg(area.y()).arg(area.width()).arg(area.height())
+                                                    .arg(primaryTileset ? primaryTileset->revision() : 0)
+                                                    .arg(secondaryTileset ? secondaryTileset->revision() : 0);
+
+    // The blocks are compared rather than tracking every edit to the layout, which is cheap relative to rendering them.
+    const Blockdata blocks = getAreaBlocks(area);
+    AreaRender *cached = m_areaRenderCache.object(key);
+    if (cached && cached->blocks == blocks && cached->layerOrder == metatileLayerOrder() && cached->layerOpacity == metatileLayerOpacity())
+        return cached->image;
+
+    AreaRender *render = new AreaRender;
+    render->image = renderArea(area, fromLayout);
+    render->blocks = blocks;
+    render->layerOrder = metatileLayerOrder();
+    render->layerOpacity = metatileLayerOpacity();
+    const QImage image = render->image;
+    m_areaRenderCache.insert(key, render, qMax(static_cast<qint64>(1), Util::memoryUsage(image) / 1024));
+    return image;
+}
+
 QPixmap Layout::getLayoutItemPixmap() {
-    return this->layoutItem ? this->layoutItem->pixmap() : QPixmap();
+    if (!this->layoutItem)
+        return QPixmap();
+    // Very large layouts are drawn by their item in chunks, and have no single pixmap.
+    return this->layoutItem->isChunked() ? render() : this->layoutItem->pixmap();
 }
 
 bool Layout::hasUnsavedChanges() const {
@@ -533,20 +877,24 @@ bool Layout::writeBlockdata(const QString &path, const Blockdata &blockdata) con
     return true;
 }
 
-bool Layout::loadBorder(const QString &root) {
+bool Layout::loadBorder(const QString &root, const Blockdata *data) {
     if (this->border_path.isEmpty()) {
         logError(QString("Failed to load border for %1: no path specified.").arg(this->name));
         return false;
     }
 
-    QString error;
-    QString path = QString("%1/%2").arg(root).arg(this->border_path);
-    auto blockdata = readBlockdata(path, &error);
-    if (!error.isEmpty()) {
-        logError(QString("Failed to load border for %1 from '%2': %3").arg(this->name).arg(path).arg(error));
-        return false;
+    if (data) {
+        this->border = *data;
+    } else {
+        QString error;
+        QString path = QString("%1/%2").arg(root).arg(this->border_path);
+        auto blockdata = readBlockdata(path, &error);
+        if (!error.isEmpty()) {
+            logError(QString("Failed to load border for %1 from '%2': %3").arg(this->name).arg(path).arg(error));
+            return false;
+        }
+        this->border = blockdata;
     }
-    this->border = blockdata;
 
     // 0 is an expected border width/height that should be handled, GF used it for the RS layouts in FRLG
     if (this->border_width <= 0) {
@@ -573,20 +921,24 @@ bool Layout::loadBorder(const QString &root) {
     return true;
 }
 
-bool Layout::loadBlockdata(const QString &root) {
+bool Layout::loadBlockdata(const QString &root, const Blockdata *data) {
     if (this->blockdata_path.isEmpty()) {
         logError(QString("Failed to load blockdata for %1: no path specified.").arg(this->name));
         return false;
     }
 
-    QString error;
-    QString path = QString("%1/%2").arg(root).arg(this->blockdata_path);
-    auto blockdata = readBlockdata(path, &error);
-    if (!error.isEmpty()) {
-        logError(QString("Failed to load blockdata for %1 from '%2': %3").arg(this->name).arg(path).arg(error));
-        return false;
+    if (data) {
+        this->blockdata = *data;
+    } else {
+        QString error;
+        QString path = QString("%1/%2").arg(root).arg(this->blockdata_path);
+        auto blockdata = readBlockdata(path, &error);
+        if (!error.isEmpty()) {
+            logError(QString("Failed to load blockdata for %1 from '%2': %3").arg(this->name).arg(path).arg(error));
+            return false;
+        }
+        this->blockdata = blockdata;
     }
-    this->blockdata = blockdata;
 
     int expectedSize = this->width * this->height;
     if (expectedSize <= 0) {
@@ -605,6 +957,7 @@ bool Layout::loadBlockdata(const QString &root) {
 
     this->lastCommitBlocks.blocks = this->blockdata;
     this->lastCommitBlocks.layoutDimensions = QSize(this->width, this->height);
+    invalidateBlockIndex();
 
     return true;
 }
@@ -0,0 +1,49 @@
+#include "memoryusage.h"
+
+#include <QJsonArray>
+#include <algorithm>
+
+MemoryUsage &MemoryUsage::add(const QString &name, qint64 bytes, int count) {
+    return add(MemoryUsage(name, bytes, count));
+}
+
+MemoryUsage &MemoryUsage::add(const MemoryUsage &child) {
+    this->children.append(child);
+    return this->children.last();
+}
+
+qint64 MemoryUsage::total() const {
+    qint64 size = this->bytes;
+    for (const auto &child : this->children) {
+        size += child.total();
+    }
+    return size;
+}
+
+// Sorts each level of the breakdown from largest to smallest.
+void MemoryUsage::sortBySize() {
+    for (auto &child : this->children) {
+        child.sortBySize();
+    }
+    std::stable_sort(this->children.begin(), this->children.end(), [](const MemoryUsage &a, const MemoryUsage &b) {
+        return a.total() > b.total();
+    });
+}
+
+QJsonObject MemoryUsage::toJson() const {
+    QJsonObject obj;
+    obj["name"] = this->name;
+    obj["bytes"] = total();
+    if (this->count >= 0)
+        obj["count"] = this->count;
+    if (!this->note.isEmpty())
+        obj["note"] = this->note;
+    if (!this->children.isEmpty()) {
+        QJsonArray children;
+        for (const auto &child : this->children) {
+            children.append(child.toJson());
+        }
+        obj["children"] = children;
+    }
+    return obj;
+}
@@ -0,0 +1,263 @@
+#include "paintprofiler.h"
+
+#include <QCoreApplication>
+#include <QThread>
+#include <QVector>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <algorithm>
+#include <cmath>
+
+// Keeps the most recent 'capacity' samples.
+class RollingSamples {
+public:
+    explicit RollingSamples(int capacity = 1000) : capacity(capacity) {}
+
+    void add(qint64 value) {
+        if (this->values.size() < this->capacity) {
+            this->values.append(value);
+        } else {
+            this->values[this->next] = value;
+        }
+        this->next = (this->next + 1) % this->capacity;
+    }
+    void clear() {
+        this->values.clear();
+        this->next = 0;
+    }
+    const QVector<qint64> &samples() const { return this->values; }
+
+private:
+    int capacity;
+    int next = 0;
+    QVector<qint64> values;
+};
+
+static const int numPhases = static_cast<int>(PaintProfiler::Phase::Count);
+
+bool PaintProfiler::s_enabled = false;
+static PaintProfiler::Scope *s_currentScope = nullptr;
+
+static RollingSamples s_latencySamples;
+static RollingSamples s_phaseSamples[numPhases];
+static RollingSamples s_frameSamples;
+static int s_numInteractions = 0;
+
+static bool s_interactionPending = false;
+static QElapsedTimer s_interactionTimer;
+static qint64 s_interactionNsecs[numPhases] = {};
+
+static bool isMainThread() {
+    return QCoreApplication::instance() && QThread::currentThread() == QCoreApplication::instance()->thread();
+}
+
+PaintProfiler::Scope::Scope(Phase phase) : phase(phase) {
+    if (!PaintProfiler::s_enabled || !isMainThread())
+        return;
+    this->active = true;
+    this->parent = s_currentScope;
+    s_currentScope = this;
+    this->timer.start();
+}
+
+PaintProfiler::Scope::~Scope() {
+    if (!this->active)
+        return;
+    const qint64 totalNsecs = this->timer.nsecsElapsed();
+    s_currentScope = this->parent;
+    if (this->parent)
+        this->parent->childNsecs += totalNsecs;
+    PaintProfiler::endScope(this->phase, totalNsecs - this->childNsecs, totalNsecs, this->parent == nullptr);
+}
+
+void PaintProfiler::setEnabled(bool enabled) {
+    if (s_enabled == enabled)
+        return;
+    s_enabled = enabled;
+    s_interactionPending = false;
+}
+
+void PaintProfiler::reset() {
+    s_latencySamples.clear();
+    for (auto &samples : s_phaseSamples) {
+        samples.clear();
+    }
+    s_frameSamples.clear();
+    s_numInteractions = 0;
+    s_interactionPending = false;
+}
+
+// Called when the map view receives an input event that may change what it displays.
+// Input events that arrive before the next repaint are counted as part of the same interaction.
+void PaintProfiler::beginInteraction() {
+    if (!s_enabled || !isMainThread())
+        return;
+
+    // If the earlier input events didn't change anything, start timing from this one instead.
+    const bool changedAnything = s_interactionNsecs[static_cast<int>(Phase::Command)] > 0
+                              || s_interactionNsecs[static_cast<int>(Phase::Render)] > 0;
+    if (s_interactionPending && changedAnything)
+        return;
+
+    s_interactionPending = true;
+    std::fill(std::begin(s_interactionNsecs), std::end(s_interactionNsecs), 0);
+    s_interactionTimer.start();
+}
+
+void PaintProfiler::endScope(Phase phase, qint64 exclusiveNsecs, qint64 totalNsecs, bool outermost) {
+    if (s_interactionPending)
+        s_interactionNsecs[static_cast<int>(phase)] += exclusiveNsecs;
+
+    if (phase == Phase::Repaint && outermost) {
+        s_frameSamples.add(totalNsecs);
+        if (s_interactionPending)
+            endInteraction();
+    }
+}
+
+void PaintProfiler::endInteraction() {
+    s_interactionPending = false;
+
+    // Interactions that didn't edit or render anything (e.g. clicking without changing any blocks) aren't interesting.
+    if (s_interactionNsecs[static_cast<int>(Phase::Command)] == 0 && s_interactionNsecs[static_cast<int>(Phase::Render)] == 0)
+        return;
+
+    const qint64 latencyNsecs = s_interactionTimer.nsecsElapsed();
+    qint64 measuredNsecs = 0;
+    for (int i = 0; i < numPhases; i++) {
+        if (i != static_cast<int>(Phase::Waiting))
+            measuredNsecs += s_interactionNsecs[i];
+    }
+    s_interactionNsecs[static_cast<int>(Phase::Waiting)] = qMax(latencyNsecs - measuredNsecs, static_cast<qint64>(0));
+
+    s_latencySamples.add(latencyNsecs);
+    for (int i = 0; i < numPhases; i++) {
+        s_phaseSamples[i].add(s_interactionNsecs[i]);
+    }
+    s_numInteractions++;
+}
+
+QString PaintProfiler::phaseName(Phase phase) {
+    switch (phase) {
+    case Phase::Input:   return QStringLiteral("Input");
+    case Phase::Command: return QStringLiteral("Commands");
+    case Phase::Render:  return QStringLiteral("Render");
+    case Phase::Scripts: return QStringLiteral("Scripts");
+    case Phase::Repaint: return QStringLiteral("Repaint");
+    case Phase::Waiting: return QStringLiteral("Waiting");
+    default: return QString();
+    }
+}
+
+// The upper bound (in milliseconds) of each histogram bucket. The histograms have one more bucket for anything slower.
+QList<double> PaintProfiler::histogramBounds() {
+    static const QList<double> bounds = {1, 2, 4, 8, 16, 33, 50, 100, 250, 500};
+    return bounds;
+}
+
+static PaintProfiler::Stats computeStats(const RollingSamples &rollingSamples) {
+    PaintProfiler::Stats stats;
+    const QList<double> bounds = PaintProfiler::histogramBounds();
+    for (int i = 0; i <= bounds.size(); i++) {
+        stats.histogram.append(0);
+    }
+
+    QVector<qint64> samples = rollingSamples.samples();
+    if (samples.isEmpty())
+        return stats;
+    std::sort(samples.begin(), samples.end());
+
+    auto toMsecs = [](qint64 nsecs) { return nsecs / 1000000.0; };
+    auto percentile = [&samples](double p) {
+        int i = static_cast<int>(std::ceil(p * samples.size())) - 1;
+        return samples.at(qBound(0, i, samples.size() - 1));
+    };
+
+    qint64 sum = 0;
+    for (const auto &sample : samples) {
+        sum += sample;
+        const double msecs = toMsecs(sample);
+        int bucket = 0;
+        while (bucket < bounds.size() && msecs > bounds.at(bucket))
+            bucket++;
+        stats.histogram[bucket]++;
+    }
+    stats.count = samples.size();
+    stats.mean = toMsecs(sum) / samples.size();
+    stats.p50 = toMsecs(percentile(0.50));
+    stats.p95 = toMsecs(percentile(0.95));
+    stats.p99 = toMsecs(percentile(0.99));
+    stats.max = toMsecs(samples.last());
+    return stats;
+}
+
+PaintProfiler::Stats PaintProfiler::latencyStats() {
+    return computeStats(s_latencySamples);
+}
+
+PaintProfiler::Stats PaintProfiler::phaseStats(Phase phase) {
+    if (phase == Phase::Count)
+        return Stats();
+    return computeStats(s_phaseSamples[static_cast<int>(phase)]);
+}
+
+PaintProfiler::Stats PaintProfiler::frameStats() {
+    return computeStats(s_frameSamples);
+}
+
+int PaintProfiler::numInteractions() {
+    return s_numInteractions;
+}
+
+static QJsonObject statsToJson(const PaintProfiler::Stats &stats) {
+    QJsonObject obj;
+    obj["count"] = stats.count;
+    obj["mean_ms"] = stats.mean;
+    obj["p50_ms"] = stats.p50;
+    obj["p95_ms"] = stats.p95;
+    obj["p99_ms"] = stats.p99;
+    obj["max_ms"] = stats.max;
+    QJsonArray histogram;
+    for (const auto &count : stats.histogram) {
+        histogram.append(count);
+    }
+    obj["histogram"] = histogram;
+    return obj;
+}
+
+QJsonObject PaintProfiler::toJson() {
+    QJsonObject obj;
+    obj["qt_version"] = QString(qVersion());
+    obj["interactions"] = s_numInteractions;
+
+    QJsonArray bounds;
+    for (const auto &bound : histogramBounds()) {
+        bounds.append(bound);
+    }
+    obj["histogram_bounds_ms"] = bounds;
+
+    obj["latency"] = statsToJson(latencyStats());
+    QJsonObject phases;
+    for (int i = 0; i < numPhases; i++) {
+        const Phase phase = static_cast<Phase>(i);
+        phases[phaseName(phase)] = statsToJson(phaseStats(phase));
+    }
+    obj["phases"] = phases;
+    obj["frames"] = statsToJson(frameStats());
+    return obj;
+}
+
+bool PaintProfiler::writeJson(const QString &filepath, QString *error) {
+    QSaveFile file(filepath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        if (error) *error = file.errorString();
+        return false;
+    }
+    file.write(QJsonDocument(toJson()).toJson(QJsonDocument::Indented));
+    if (!file.commit()) {
+        if (error) *error = file.errorString();
+        return false;
+    }
+    return true;
+}
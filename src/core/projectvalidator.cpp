@@ -0,0 +1,485 @@
+#include "projectvalidator.h"
+#include "project.h"
+#include "parseutil.h"
+#include "config.h"
+
+#include <QtConcurrent>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <algorithm>
+
+struct ProjectValidator::Snapshot {
+    QString root;
+    QString dynamicMapConstant;
+    QString mapFoldersPath;
+    QString wildEncountersPath;
+    bool usePoryScript = false;
+    int maxMetatileId = 0;
+
+    QSet<QString> mapNames;
+    QHash<QString, QString> mapConstantsToMapNames;
+    QHash<QString, QString> mapSharedScriptsMaps;
+    QSet<QString> primaryTilesetLabels;
+    QSet<QString> secondaryTilesetLabels;
+    QSet<QString> globalScriptLabels;
+    QSet<QString> gfxConstants;
+    QSet<QString> movementTypes;
+    QSet<QString> trainerTypes;
+    QSet<QString> flagNames;
+    QSet<QString> varNames;
+    QSet<QString> itemNames;
+    QSet<QString> weatherNames;
+    QSet<QString> facingDirections;
+    QSet<QString> secretBaseIds;
+    QSet<QString> speciesNames;
+
+    struct LayoutInfo {
+        QString name;
+        int width = 0;
+        int height = 0;
+        int borderWidth = 0;
+        int borderHeight = 0;
+        QString blockdataPath;
+        QString borderPath;
+        QString primaryTilesetLabel;
+        QString secondaryTilesetLabel;
+    };
+    QHash<QString, LayoutInfo> layouts;
+
+    struct EncounterSlot {
+        QString mapConstant;
+        QString groupLabel;
+        QString species;
+    };
+    QList<EncounterSlot> encounters;
+};
+
+static QSet<QString> toSet(const QStringList &list) {
+    return QSet<QString>(list.constBegin(), list.constEnd());
+}
+
+// Empty values and zero are used throughout the projects to mean "none", so they're never reported.
+static bool isUnsetValue(const QString &value) {
+    return value.isEmpty() || value == QStringLiteral("0") || value == QStringLiteral("0x0") || value == QStringLiteral("NULL");
+}
+
+static QString relativePath(const QString &root, const QString &filepath) {
+    return Util::stripPrefix(filepath, root + "/");
+}
+
+ProjectValidator::ProjectValidator(Project *project, QObject *parent) :
+    QObject(parent),
+    m_project(project)
+{
+    connect(&m_watcher, &QFutureWatcher<TaskResult>::progressValueChanged, this, [this](int value) {
+        emit progressChanged(value, m_watcher.progressMaximum());
+    });
+    connect(&m_watcher, &QFutureWatcher<TaskResult>::finished, this, &ProjectValidator::finish);
+}
+
+ProjectValidator::~ProjectValidator() {
+    m_watcher.cancel();
+    m_watcher.waitForFinished();
+}
+
+int ProjectValidator::numErrors() const {
+    int count = 0;
+    for (const auto &issue : m_issues) {
+        if (issue.severity == Issue::Severity::Error) count++;
+    }
+    return count;
+}
+
+int ProjectValidator::numWarnings() const {
+    return m_issues.length() - numErrors();
+}
+
+QString ProjectValidator::severityToString(Issue::Severity severity) {
+    return severity == Issue::Severity::Error ? QStringLiteral("error") : QStringLiteral("warning");
+}
+
+// Copy everything the checks need from the project. This is done on the main thread before any work begins,
+// so the workers only ever read their own copy.
+std::shared_ptr<const ProjectValidator::Snapshot> ProjectValidator::takeSnapshot() const {
+    auto snapshot = std::make_shared<Snapshot>();
+    snapshot->root = m_project->root;
+    snapshot->dynamicMapConstant = Project::getDynamicMapDefineName();
+    snapshot->mapFoldersPath = QDir::cleanPath(QString("%1/%2").arg(projectConfig.projectDir())
+                                                               .arg(projectConfig.getFilePath(ProjectFilePath::data_map_folders)));
+    snapshot->wildEncountersPath = projectConfig.getFilePath(ProjectFilePath::json_wild_encounters);
+    snapshot->usePoryScript = projectConfig.usePoryScript;
+    snapshot->maxMetatileId = Project::getNumMetatilesTotal() - 1;
+
+    for (const auto &mapName : m_project->mapNames()) {
+        const Map *map = m_project->getMap(mapName);
+        // Maps that haven't been saved yet have nothing on disk to check.
+        if (!map || !map->isPersistedToFile())
+            continue;
+        snapshot->mapNames.insert(mapName);
+        if (!map->sharedScriptsMap().isEmpty())
+            snapshot->mapSharedScriptsMaps.insert(mapName, map->sharedScriptsMap());
+    }
+    for (auto it = m_project->mapConstantsToMapNames.constBegin(); it != m_project->mapConstantsToMapNames.constEnd(); it++) {
+        snapshot->mapConstantsToMapNames.insert(it.key(), it.value());
+    }
+
+    for (const auto &layoutId : m_project->layoutIds()) {
+        const Layout *layout = m_project->getLayout(layoutId);
+        if (!layout || !layout->newFolderPath.isEmpty())
+            continue;
+        Snapshot::LayoutInfo info;
+        info.name = layout->name;
+        info.width = layout->width;
+        info.height = layout->height;
+        info.borderWidth = layout->border_width;
+        info.borderHeight = layout->border_height;
+        info.blockdataPath = QString("%1/%2").arg(m_project->root).arg(layout->blockdata_path);
+        info.borderPath = QString("%1/%2").arg(m_project->root).arg(layout->border_path);
+        info.primaryTilesetLabel = layout->tileset_primary_label;
+        info.secondaryTilesetLabel = layout->tileset_secondary_label;
+        snapshot->layouts.insert(layoutId, info);
+    }
+
+    snapshot->primaryTilesetLabels = toSet(m_project->primaryTilesetLabels);
+    snapshot->secondaryTilesetLabels = toSet(m_project->secondaryTilesetLabels);
+    snapshot->globalScriptLabels = toSet(m_project->globalScriptLabels);
+    snapshot->gfxConstants = toSet(m_project->gfxDefines.keys());
+    snapshot->movementTypes = toSet(m_project->movementTypes);
+    snapshot->trainerTypes = toSet(m_project->trainerTypes);
+    snapshot->flagNames = toSet(m_project->flagNames);
+    snapshot->varNames = toSet(m_project->varNames);
+    snapshot->itemNames = toSet(m_project->itemNames);
+    snapshot->weatherNames = toSet(m_project->coordEventWeatherNames);
+    snapshot->facingDirections = toSet(m_project->bgEventFacingDirections);
+    snapshot->secretBaseIds = toSet(m_project->secretBaseIds);
+    snapshot->speciesNames = toSet(m_project->speciesNames);
+
+    for (const auto &mapPair : m_project->wildMonData) {
+        for (const auto &groupPair : mapPair.second) {
+            for (const auto &fieldPair : groupPair.second.wildMons) {
+                for (const auto &wildMon : fieldPair.second.wildPokemon) {
+                    snapshot->encounters.append(Snapshot::EncounterSlot{mapPair.first, groupPair.first, wildMon.species});
+                }
+            }
+        }
+    }
+    return snapshot;
+}
+
+void ProjectValidator::start() {
+    if (isRunning() || !m_project)
+        return;
+
+    m_issues.clear();
+    m_timer.start();
+    m_snapshot = takeSnapshot();
+
+    QList<Task> tasks;
+    for (const auto &mapName : m_snapshot->mapNames) {
+        tasks.append(Task{Task::Kind::Map, mapName, m_snapshot});
+    }
+    for (auto it = m_snapshot->layouts.constBegin(); it != m_snapshot->layouts.constEnd(); it++) {
+        tasks.append(Task{Task::Kind::Layout, it.key(), m_snapshot});
+    }
+    tasks.append(Task{Task::Kind::WildEncounters, QString(), m_snapshot});
+    m_numMaps = m_snapshot->mapNames.count();
+    m_numLayouts = m_snapshot->layouts.count();
+
+    m_watcher.setFuture(QtConcurrent::mapped(tasks, &ProjectValidator::runTask));
+}
+
+void ProjectValidator::cancel() {
+    m_watcher.cancel();
+}
+
+ProjectValidator::TaskResult ProjectValidator::runTask(const Task &task) {
+    switch (task.kind) {
+    case Task::Kind::Map:            return validateMap(task.name, *task.snapshot);
+    case Task::Kind::Layout:         return validateLayout(task.name, *task.snapshot);
+    case Task::Kind::WildEncounters: return validateWildEncounters(*task.snapshot);
+    }
+    return TaskResult();
+}
+
+// Collect the results from the workers, and check the references between maps that need every map to have been read.
+void ProjectValidator::finish() {
+    m_elapsedMs = m_timer.elapsed();
+    if (m_watcher.isCanceled()) {
+        m_snapshot.reset();
+        emit finished();
+        return;
+    }
+
+    const QList<TaskResult> results = m_watcher.future().results();
+    QHash<QString, int> numWarps;
+    for (const auto &result : results) {
+        m_issues.append(result.issues);
+        if (!result.mapName.isEmpty())
+            numWarps.insert(result.mapName, result.numWarps);
+    }
+
+    for (const auto &result : results) {
+        for (const auto &warp : result.warps) {
+            // Named warp IDs can only be checked by the compiler, and maps that couldn't be read were already reported.
+            bool ok;
+            const int warpId = warp.destWarpId.toInt(&ok, 0);
+            const int destNumWarps = numWarps.value(warp.destMap, -1);
+            if (!ok || destNumWarps < 0)
+                continue;
+            if (warpId < 0 || warpId >= destNumWarps) {
+                Issue issue;
+                issue.severity = Issue::Severity::Error;
+                issue.source = result.mapName;
+                issue.file = relativePath(m_snapshot->root, QString("%1/%2/map.json").arg(m_snapshot->mapFoldersPath).arg(result.mapName));
+                issue.message = QString("Warp %1 leads to warp %2 of '%3', which only has %4 warps.")
+                                    .arg(warp.index).arg(warpId).arg(warp.destMap).arg(destNumWarps);
+                m_issues.append(issue);
+            }
+        }
+    }
+
+    std::sort(m_issues.begin(), m_issues.end(), [](const Issue &a, const Issue &b) {
+        if (a.source != b.source) return a.source < b.source;
+        return a.severity > b.severity;
+    });
+    m_snapshot.reset();
+    m_elapsedMs = m_timer.elapsed();
+    emit finished();
+}
+
+// Reads a map's JSON file and checks everything it refers to. Runs on a worker thread.
+ProjectValidator::TaskResult ProjectValidator::validateMap(const QString &mapName, const Snapshot &snapshot) {
+    TaskResult result;
+    result.mapName = mapName;
+
+    const QString filepath = QString("%1/%2/map.json").arg(snapshot.mapFoldersPath).arg(mapName);
+    const QString file = relativePath(snapshot.root, filepath);
+    auto report = [&](Issue::Severity severity, const QString &message) {
+        result.issues.append(Issue{severity, mapName, file, message});
+    };
+
+    QFile jsonFile(filepath);
+    if (!jsonFile.open(QIODevice::ReadOnly)) {
+        report(Issue::Severity::Error, QString("Failed to open map file: %1").arg(jsonFile.errorString()));
+        return result;
+    }
+    QJsonParseError parseError;
+    const QJsonDocument doc = QJsonDocument::fromJson(jsonFile.readAll(), &parseError);
+    if (parseError.error != QJsonParseError::NoError) {
+        report(Issue::Severity::Error, QString("Failed to parse map file: %1").arg(parseError.errorString()));
+        return result;
+    }
+    const QJsonObject mapObj = doc.object();
+
+    const QString layoutId = ParseUtil::jsonToQString(mapObj.value("layout"));
+    if (!snapshot.layouts.contains(layoutId))
+        report(Issue::Severity::Error, QString("Unknown layout ID '%1'.").arg(layoutId));
+
+    // The map's script labels are read from its (possibly shared) scripts file.
+    QString scriptsPath = QString("%1/%2/scripts").arg(snapshot.mapFoldersPath).arg(snapshot.mapSharedScriptsMaps.value(mapName, mapName));
+    QString extension = Project::getScriptFileExtension(snapshot.usePoryScript);
+    if (snapshot.usePoryScript && !QFile::exists(scriptsPath + extension))
+        extension = Project::getScriptFileExtension(false);
+    const QStringList localLabelList = ParseUtil::getGlobalScriptLabels(scriptsPath + extension);
+    const QSet<QString> localScriptLabels = toSet(localLabelList);
+
+    auto checkName = [&](const QString &description, const QString &value, const QSet<QString> &known, Issue::Severity severity) {
+        if (!isUnsetValue(value) && !known.contains(value))
+            report(severity, QString("%1 '%2' is not defined.").arg(description).arg(value));
+    };
+    auto checkScript = [&](const QString &description, const QString &label) {
+        if (!isUnsetValue(label) && !localScriptLabels.contains(label) && !snapshot.globalScriptLabels.contains(label))
+            report(Issue::Severity::Warning, QString("%1 uses script '%2', which was not found.").arg(description).arg(label));
+    };
+    auto checkMapConstant = [&](const QString &description, const QString &mapConstant) -> QString {
+        if (mapConstant == snapshot.dynamicMapConstant)
+            return QString();
+        const QString destMap = snapshot.mapConstantsToMapNames.value(mapConstant);
+        if (destMap.isEmpty())
+            report(Issue::Severity::Error, QString("%1 refers to unknown map '%2'.").arg(description).arg(mapConstant));
+        return destMap;
+    };
+
+    // Objects
+    const QJsonArray objects = mapObj.value(Event::groupToJsonKey(Event::Group::Object)).toArray();
+    for (int i = 0; i < objects.size(); i++) {
+        const QJsonObject obj = objects.at(i).toObject();
+        const QString description = QString("Object %1").arg(i + Event::getIndexOffset(Event::Group::Object));
+        const Event::Type type = obj.contains("type") ? Event::typeFromJsonKey(ParseUtil::jsonToQString(obj.value("type"))) : Event::Type::Object;
+        checkName(description + " graphics", ParseUtil::jsonToQString(obj.value("graphics_id")), snapshot.gfxConstants, Issue::Severity::Warning);
+        if (type == Event::Type::CloneObject) {
+            checkMapConstant(description, ParseUtil::jsonToQString(obj.value("target_map")));
+        } else {
+            checkName(description + " movement type", ParseUtil::jsonToQString(obj.value("movement_type")), snapshot.movementTypes, Issue::Severity::Warning);
+            checkName(description + " trainer type", ParseUtil::jsonToQString(obj.value("trainer_type")), snapshot.trainerTypes, Issue::Severity::Warning);
+            checkName(description + " flag", ParseUtil::jsonToQString(obj.value("flag")), snapshot.flagNames, Issue::Severity::Warning);
+            checkScript(description, ParseUtil::jsonToQString(obj.value("script")));
+        }
+    }
+
+    // Warps
+    const QJsonArray warps = mapObj.value(Event::groupToJsonKey(Event::Group::Warp)).toArray();
+    result.numWarps = warps.size();
+    for (int i = 0; i < warps.size(); i++) {
+        const QJsonObject warp = warps.at(i).toObject();
+        const int index = i + Event::getIndexOffset(Event::Group::Warp);
+        const QString destMap = checkMapConstant(QString("Warp %1").arg(index), ParseUtil::jsonToQString(warp.value("dest_map")));
+        if (!destMap.isEmpty())
+            result.warps.append(WarpReference{destMap, ParseUtil::jsonToQString(warp.value("dest_warp_id")), index});
+    }
+
+    // Coord events
+    const QJsonArray coords = mapObj.value(Event::groupToJsonKey(Event::Group::Coord)).toArray();
+    for (int i = 0; i < coords.size(); i++) {
+        const QJsonObject coord = coords.at(i).toObject();
+        const QString description = QString("Coord event %1").arg(i + Event::getIndexOffset(Event::Group::Coord));
+        const Event::Type type = Event::typeFromJsonKey(ParseUtil::jsonToQString(coord.value("type")));
+        if (type == Event::Type::Trigger) {
+            checkName(description + " var", ParseUtil::jsonToQString(coord.value("var")), snapshot.varNames, Issue::Severity::Warning);
+            checkScript(description, ParseUtil::jsonToQString(coord.value("script")));
+        } else if (type == Event::Type::WeatherTrigger) {
+            checkName(description + " weather", ParseUtil::jsonToQString(coord.value("weather")), snapshot.weatherNames, Issue::Severity::Warning);
+        } else {
+            report(Issue::Severity::Error, QString("%1 has an invalid type.").arg(description));
+        }
+    }
+
+    // BG events
+    const QJsonArray bgs = mapObj.value(Event::groupToJsonKey(Event::Group::Bg)).toArray();
+    for (int i = 0; i < bgs.size(); i++) {
+        const QJsonObject bg = bgs.at(i).toObject();
+        const QString description = QString("BG event %1").arg(i + Event::getIndexOffset(Event::Group::Bg));
+        const Event::Type type = Event::typeFromJsonKey(ParseUtil::jsonToQString(bg.value("type")));
+        if (type == Event::Type::Sign) {
+            checkName(description + " facing direction", ParseUtil::jsonToQString(bg.value("player_facing_dir")), snapshot.facingDirections, Issue::Severity::Warning);
+            checkScript(description, ParseUtil::jsonToQString(bg.value("script")));
+        } else if (type == Event::Type::HiddenItem) {
+            checkName(description + " item", ParseUtil::jsonToQString(bg.value("item")), snapshot.itemNames, Issue::Severity::Warning);
+            checkName(description + " flag", ParseUtil::jsonToQString(bg.value("flag")), snapshot.flagNames, Issue::Severity::Warning);
+        } else if (type == Event::Type::SecretBase) {
+            checkName(description + " secret base ID", ParseUtil::jsonToQString(bg.value("secret_base_id")), snapshot.secretBaseIds, Issue::Severity::Warning);
+        } else {
+            report(Issue::Severity::Error, QString("%1 has an invalid type.").arg(description));
+        }
+    }
+
+    // Connections
+    static const QSet<QString> directions = {"up", "down", "left", "right", "dive", "emerge"};
+    const QJsonArray connections = mapObj.value("connections").toArray();
+    for (int i = 0; i < connections.size(); i++) {
+        const QJsonObject connection = connections.at(i).toObject();
+        const QString direction = ParseUtil::jsonToQString(connection.value("direction"));
+        const QString description = QString("Connection '%1'").arg(direction);
+        if (!directions.contains(direction))
+            report(Issue::Severity::Error, QString("Connection %1 has an invalid direction '%2'.").arg(i).arg(direction));
+        checkMapConstant(description, ParseUtil::jsonToQString(connection.value("map")));
+    }
+
+    return result;
+}
+
+// Reads a layout's blockdata and border, and checks their sizes and metatile IDs. Runs on a worker thread.
+ProjectValidator::TaskResult ProjectValidator::validateLayout(const QString &layoutId, const Snapshot &snapshot) {
+    TaskResult result;
+    const Snapshot::LayoutInfo layout = snapshot.layouts.value(layoutId);
+    auto report = [&](Issue::Severity severity, const QString &file, const QString &message) {
+        result.issues.append(Issue{severity, layoutId, file, message});
+    };
+
+    if (!snapshot.primaryTilesetLabels.contains(layout.primaryTilesetLabel))
+        report(Issue::Severity::Error, QString(), QString("Unknown primary tileset '%1'.").arg(layout.primaryTilesetLabel));
+    if (!snapshot.secondaryTilesetLabels.contains(layout.secondaryTilesetLabel))
+        report(Issue::Severity::Error, QString(), QString("Unknown secondary tileset '%1'.").arg(layout.secondaryTilesetLabel));
+
+    auto checkBlockdata = [&](const QString &description, const QString &filepath, int width, int height) {
+        const QString file = relativePath(snapshot.root, filepath);
+        QString error;
+        const Blockdata blockdata = Layout::readBlockdata(filepath, &error);
+        if (!error.isEmpty()) {
+            report(Issue::Severity::Error, file, QString("Failed to read %1: %2").arg(description).arg(error));
+            return;
+        }
+        if (blockdata.length() != width * height) {
+            report(Issue::Severity::Error, file, QString("%1 has %2 blocks, but its dimensions (%3x%4) need %5.")
+                                                    .arg(description).arg(blockdata.length()).arg(width).arg(height).arg(width * height));
+        }
+
+        // Report the number of invalid blocks and the first one, rather than every block.
+        int numInvalid = 0;
+        int firstInvalid = -1;
+        for (int i = 0; i < blockdata.length(); i++) {
+            if (blockdata.at(i).metatileId() > snapshot.maxMetatileId) {
+                if (firstInvalid < 0) firstInvalid = i;
+                numInvalid++;
+            }
+        }
+        if (numInvalid > 0) {
+            report(Issue::Severity::Error, file, QString("%1 has %2 block(s) with metatile IDs above the maximum (%3). The first is at (%4, %5).")
+                                                    .arg(description)
+                                                    .arg(numInvalid)
+                                                    .arg(Util::toHexString(snapshot.maxMetatileId, 3))
+                                                    .arg(width > 0 ? firstInvalid % width : firstInvalid)
+                                                    .arg(width > 0 ? firstInvalid / width : 0));
+        }
+    };
+    checkBlockdata("Blockdata", layout.blockdataPath, layout.width, layout.height);
+    checkBlockdata("Border", layout.borderPath, layout.borderWidth, layout.borderHeight);
+
+    return result;
+}
+
+// Checks the species and maps used by the wild encounter data, which was read when the project was loaded.
+ProjectValidator::TaskResult ProjectValidator::validateWildEncounters(const Snapshot &snapshot) {
+    TaskResult result;
+    const QString file = snapshot.wildEncountersPath;
+    QSet<QString> reported;
+    for (const auto &slot : snapshot.encounters) {
+        if (!snapshot.mapConstantsToMapNames.contains(slot.mapConstant) && !reported.contains(slot.mapConstant)) {
+            result.issues.append(Issue{Issue::Severity::Warning, QStringLiteral("Wild Encounters"), file,
+                                  QString("Encounter group '%1' refers to unknown map '%2'.").arg(slot.groupLabel).arg(slot.mapConstant)});
+            reported.insert(slot.mapConstant);
+        }
+        if (!isUnsetValue(slot.species) && !snapshot.speciesNames.contains(slot.species) && !reported.contains(slot.species)) {
+            result.issues.append(Issue{Issue::Severity::Warning, QStringLiteral("Wild Encounters"), file,
+                                  QString("Species '%1' (first used by '%2') is not defined.").arg(slot.species).arg(slot.groupLabel)});
+            reported.insert(slot.species);
+        }
+    }
+    return result;
+}
+
+QJsonDocument ProjectValidator::toJson() const {
+    QJsonArray issuesArr;
+    for (const auto &issue : m_issues) {
+        QJsonObject issueObj;
+        issueObj["severity"] = severityToString(issue.severity);
+        issueObj["source"] = issue.source;
+        issueObj["file"] = issue.file;
+        issueObj["message"] = issue.message;
+        issuesArr.append(issueObj);
+    }
+
+    QJsonObject obj;
+    obj["maps_checked"] = m_numMaps;
+    obj["layouts_checked"] = m_numLayouts;
+    obj["errors"] = numErrors();
+    obj["warnings"] = numWarnings();
+    obj["elapsed_ms"] = m_elapsedMs;
+    obj["issues"] = issuesArr;
+    return QJsonDocument(obj);
+}
+
+bool ProjectValidator::writeJson(const QString &filepath, QString *error) const {
+    QSaveFile file(filepath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        if (error) *error = file.errorString();
+        return false;
+    }
+    file.write(toJson().toJson(QJsonDocument::Indented));
+    if (!file.commit()) {
+        if (error) *error = file.errorString();
+        return false;
+    }
+    return true;
+}
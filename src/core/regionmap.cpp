@@ -527,7 +527,7 @@ void RegionMap::resizeTilemap(int newWidth, int newHeight, bool update) {
                 for (int x = 0; x < newWidth; x++) {
                     if (y < oldHeight && x < oldWidth) {
                         int i = x + y * oldWidth;
-                        uint8_t tile = tilemapCopy[i]->raw();
+                        uint8_t tile = tilemapCopy[i];
                         dataStream << tile;
                     } else {
                         uint8_t tile = 0;
@@ -541,7 +541,7 @@ void RegionMap::resizeTilemap(int newWidth, int newHeight, bool update) {
                 for (int x = 0; x < newWidth; x++) {
                     if (y < oldHeight && x < oldWidth) {
                         int i = x + y * oldWidth;
-                        uint16_t tile = tilemapCopy[i]->raw();
+                        uint16_t tile = tilemapCopy[i];
                         dataStream << tile;
                     } else {
                         uint16_t tile = 0;
@@ -566,19 +566,19 @@ QByteArray RegionMap::getTilemap() {
     switch (this->tilemap_format) {
         case TilemapFormat::Plain:
             for (int i = 0; i < tilemapSize(); i++) {
-                uint8_t tile = this->tilemap[i]->raw();
+                uint8_t tile = this->tilemap[i];
                 dataStream << tile;
             }
             break;
         case TilemapFormat::BPP_4:
             for (int i = 0; i < tilemapSize(); i++) {
-                uint16_t tile = this->tilemap[i]->raw();
+                uint16_t tile = this->tilemap[i];
                 dataStream << tile;
             }
             break;
         case TilemapFormat::BPP_8:
             for (int i = 0; i < tilemapSize(); i++) {
-                uint16_t tile = this->tilemap[i]->raw();
+                uint16_t tile = this->tilemap[i];
                 dataStream << tile;
             }
             break;
@@ -598,21 +598,22 @@ void RegionMap::setTilemap(QByteArray newTilemap) {
             for (int i = 0; i < tilemapBytes(); i++) {
                 uint8_t tile;
                 dataStream >> tile;
-                this->tilemap[i] = make_shared<PlainTile>(tile);
+                this->tilemap[i] = tile;
             }
             break;
         case TilemapFormat::BPP_4:
             for (int i = 0; i < tilemapSize(); i++) {
                 uint16_t tile;
                 dataStream >> tile;
-                this->tilemap[i] = make_shared<BPP4Tile>(tile & 0xffff);
+                this->tilemap[i] = tile;
             }
             break;
         case TilemapFormat::BPP_8:
             for (int i = 0; i < tilemapSize(); i++) {
                 uint16_t tile;
                 dataStream >> tile;
-                this->tilemap[i] = make_shared<BPP8Tile>(tile & 0xffff);
+                // 8bpp tiles have no palette bits.
+                this->tilemap[i] = tile & 0x0fff;
             }
             break;
     }
@@ -672,21 +673,30 @@ int RegionMap::get_layout_index(int x, int y) {
 }
 
 unsigned RegionMap::getTileId(int index) {
-    if (index < tilemap.size()) {
-        return tilemap[index]->id();
+    if (index >= 0 && index < tilemap.size()) {
+        return makeTilemapTile(this->tilemap_format, tilemap[index])->id();
     }
 
     return 0;
 }
 
-shared_ptr<TilemapTile> RegionMap::getTile(int index) { 
-    if (index < tilemap.size()) {
-        return tilemap[index];
+// Note: The returned tile is a copy, changes to it won't affect the tilemap.
+shared_ptr<TilemapTile> RegionMap::getTile(int index) {
+    if (index >= 0 && index < tilemap.size()) {
+        return makeTilemapTile(this->tilemap_format, tilemap[index]);
     }
 
     return nullptr;
 }
 
+unsigned RegionMap::getTileValue(int index) {
+    if (index >= 0 && index < tilemap.size()) {
+        return tilemap[index];
+    }
+
+    return 0;
+}
+
 unsigned RegionMap::getTileId(int x, int y) {
     int index = x + y * tilemap_width;
     return getTileId(index);
@@ -698,26 +708,38 @@ shared_ptr<TilemapTile> RegionMap::getTile(int x, int y) {
 }
 
 void RegionMap::setTileId(int index, unsigned id) {
-    if (index < tilemap.size()) {
-        tilemap[index]->setId(id);
+    if (index >= 0 && index < tilemap.size()) {
+        auto tile = makeTilemapTile(this->tilemap_format, tilemap[index]);
+        tile->setId(id);
+        tilemap[index] = tile->raw();
     }
 }
 
 void RegionMap::setTile(int index, TilemapTile &tile) {
-    if (index < tilemap.size()) {
-        tilemap[index]->copy(tile);
-    }
+    setTileData(index, tile.id(), tile.hFlip(), tile.vFlip(), tile.palette());
 }
 
 void RegionMap::setTileData(int index, unsigned id, bool hFlip, bool vFlip, int palette) {
-    if (index < tilemap.size()) {
-        tilemap[index]->setId(id);
-        tilemap[index]->setHFlip(hFlip);
-        tilemap[index]->setVFlip(vFlip);
-        tilemap[index]->setPalette(palette);
+    setTileValue(index, tileValue(id, hFlip, vFlip, palette));
+}
+
+void RegionMap::setTileValue(int index, unsigned value) {
+    if (index >= 0 && index < tilemap.size()) {
+        tilemap[index] = value;
     }
 }
 
+// Get the value of a tile with the given properties in this tilemap's format.
+// Properties the format doesn't support are ignored.
+unsigned RegionMap::tileValue(unsigned id, bool hFlip, bool vFlip, int palette) {
+    auto tile = makeTilemapTile(this->tilemap_format, 0);
+    tile->setId(id);
+    tile->setHFlip(hFlip);
+    tile->setVFlip(vFlip);
+    tile->setPalette(palette);
+    return tile->raw();
+}
+
 int RegionMap::tilemapToLayoutIndex(int index) {
     int x = index % this->tilemap_width;
     if (x < this->offset_left) return -1;
@@ -5,10 +5,13 @@
 #include "config.h"
 #include "imageproviders.h"
 #include "validator.h"
+#include "utility.h"
 
 #include <QPainter>
 #include <QImage>
+#include <QtConcurrent>
 #include <algorithm>
+#include <atomic>
 
 
 Tileset::Tileset(const Tileset &other)
@@ -63,6 +66,7 @@ Tileset &Tileset::operator=(const Tileset &other) {
         m_metatiles.append(new Metatile(*metatile));
     }
 
+    markChanged();
     return *this;
 }
 
@@ -70,6 +74,16 @@ Tileset::~Tileset() {
     clearMetatiles();
 }
 
+// Tilesets may be created on background threads while loading.
+quint64 Tileset::nextRevision() {
+    static std::atomic<quint64> counter(0);
+    return ++counter;
+}
+
+void Tileset::markChanged() {
+    m_revision = nextRevision();
+}
+
 void Tileset::clearMetatiles() {
     qDeleteAll(m_metatiles);
     m_metatiles.clear();
@@ -78,10 +92,12 @@ void Tileset::clearMetatiles() {
 void Tileset::setMetatiles(const QList<Metatile*> &metatiles) {
     clearMetatiles();
     m_metatiles = metatiles;
+    markChanged();
 }
 
 void Tileset::addMetatile(Metatile* metatile) {
     m_metatiles.append(metatile);
+    markChanged();
 }
 
 void Tileset::resizeMetatiles(int newNumMetatiles) {
@@ -93,6 +109,7 @@ void Tileset::resizeMetatiles(int newNumMetatiles) {
     while (m_metatiles.length() < newNumMetatiles) {
         m_metatiles.append(new Metatile(numTiles));
     }
+    markChanged();
 }
 
 uint16_t Tileset::firstMetatileId() const {
@@ -617,11 +634,44 @@ bool Tileset::loadTilesImage(QImage *importedImage) {
     if (imported) {
         // Only set this flag once we've successfully loaded the tiles image.
         m_hasUnsavedTilesImage = true;
+        markChanged();
     }
 
     return true;
 }
 
+// Approximate number of bytes used by the tileset's images, metatiles, and palettes.
+qint64 Tileset::memoryUsage() const {
+    return memoryBreakdown().total();
+}
+
+MemoryUsage Tileset::memoryBreakdown() const {
+    MemoryUsage usage(this->name);
+    usage.add("Tiles image", Util::memoryUsage(m_tilesImage));
+
+    qint64 tilesSize = 0;
+    for (const auto &tile : m_tiles) {
+        tilesSize += Util::memoryUsage(tile);
+    }
+    usage.add("Tiles", tilesSize, m_tiles.size());
+
+    qint64 metatilesSize = 0;
+    for (const auto &metatile : m_metatiles) {
+        metatilesSize += sizeof(Metatile) + metatile->tiles.size() * sizeof(Tile);
+    }
+    usage.add("Metatiles", metatilesSize, m_metatiles.size());
+
+    qint64 palettesSize = 0;
+    for (const auto &palette : this->palettes) {
+        palettesSize += palette.size() * sizeof(QRgb);
+    }
+    for (const auto &palette : this->palettePreviews) {
+        palettesSize += palette.size() * sizeof(QRgb);
+    }
+    usage.add("Palettes", palettesSize, this->palettes.size());
+    return usage;
+}
+
 bool Tileset::saveTilesImage() {
     // Only write the tiles image if it was changed.
     // Porymap will only ever change an existing tiles image by importing a new one.
@@ -642,8 +692,8 @@ bool Tileset::loadPalettes() {
     this->palettePreviews.clear();
 
     for (int i = 0; i < Project::getNumPalettesTotal(); i++) {
+        const QString path = this->palettePaths.value(i);
         QList<QRgb> palette;
-        QString path = this->palettePaths.value(i);
         if (!path.isEmpty()) {
             bool error = false;
             palette = PaletteUtil::parse(path, &error);
@@ -674,12 +724,23 @@ bool Tileset::savePalettes() {
     return success;
 }
 
-bool Tileset::load() {
+// The palettes, tiles image, and metatiles are independent of each other, so given a pool we decode them concurrently.
+// Each of these only writes to its own members, so it's safe for them to share the Tileset.
+// The metatile attributes depend on the number of metatiles, so they're read after the metatiles.
+bool Tileset::load(QThreadPool *pool) {
+    QFuture<bool> palettesFuture;
+    QFuture<bool> tilesImageFuture;
+    if (pool) {
+        palettesFuture = QtConcurrent::run(pool, [this] { return loadPalettes(); });
+        tilesImageFuture = QtConcurrent::run(pool, [this] { return loadTilesImage(); });
+    }
+
     bool success = true;
-    if (!loadPalettes()) success = false;
-    if (!loadTilesImage()) success = false;
     if (!loadMetatiles()) success = false;
     if (!loadMetatileAttributes()) success = false;
+    if (!(pool ? palettesFuture.result() : loadPalettes())) success = false;
+    if (!(pool ? tilesImageFuture.result() : loadTilesImage())) success = false;
+    markChanged();
     return success;
 }
 
@@ -161,3 +161,12 @@ QString Util::mkpath(const QString& dirPath) {
     }
     return QString();
 }
+
+// Approximate number of bytes used by an image's pixel data.
+qint64 Util::memoryUsage(const QImage &image) {
+    return image.sizeInBytes();
+}
+
+qint64 Util::memoryUsage(const QPixmap &pixmap) {
+    return static_cast<qint64>(pixmap.width()) * pixmap.height() * pixmap.depth() / 8;
+}
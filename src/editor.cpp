@@ -25,6 +25,7 @@ static bool selectNewEvents = false;
 
 // 2D array mapping collision+elevation combos to an icon.
 QList<QList<const QImage*>> Editor::collisionIcons;
+QImage Editor::collisionAtlas;
 
 Editor::Editor(Ui::MainWindow* ui)
 {
@@ -113,6 +114,9 @@ void Editor::setProject(Project * project) {
     closeProject();
     this->project = project;
     MapConnection::project = project;
+    if (project) {
+        connect(project, &Project::eventGraphicsLoaded, this, &Editor::redrawDefaultSpriteEvents);
+    }
 }
 
 void Editor::closeProject() {
@@ -280,6 +284,9 @@ void Editor::displayWildMonTables() {
         return;
     }
 
+    // Start decoding the species icons now, rather than while the tables are being painted.
+    project->preloadSpeciesIcons();
+
     QComboBox *labelCombo = ui->comboBox_EncounterGroupLabel;
     QStringList labelComboStrings;
     for (auto groupPair : project->wildMonData[map->constantName()])
@@ -841,6 +848,7 @@ void Editor::displayConnection(MapConnection *connection) {
     // Create connection image
     auto pixmapItem = new ConnectionPixmapItem(connection);
     scene->addItem(pixmapItem);
+    updateDisplayedLayouts();
     maskNonVisibleConnectionTiles();
     connect(pixmapItem, &ConnectionPixmapItem::positionChanged, this, &Editor::maskNonVisibleConnectionTiles);
 
@@ -1331,6 +1339,7 @@ bool Editor::setMap(QString map_name) {
     connect(map, &Map::connectionRemoved, this, &Editor::removeConnectionPixmap);
     updateEvents();
     this->project->watchFile(map->getJsonFilepath());
+    updateDisplayedLayouts();
 
     return true;
 }
@@ -1378,9 +1387,28 @@ bool Editor::setLayout(QString layoutId) {
     if (this->layout->tileset_secondary_label != prevSecondaryTileset)
         Scripting::cb_TilesetUpdated(this->layout->tileset_secondary_label);
 
+    updateDisplayedLayouts();
+
     return true;
 }
 
+// The project may unload layouts to save memory, so we tell it which ones are on screen.
+void Editor::updateDisplayedLayouts() {
+    if (!this->project)
+        return;
+
+    QSet<QString> layoutIds;
+    if (this->layout) {
+        layoutIds.insert(this->layout->id);
+    }
+    if (this->map) {
+        for (const auto &connection : this->map->getConnections()) {
+            layoutIds.insert(this->project->getMapLayoutId(connection->targetMapName()));
+        }
+    }
+    this->project->setDisplayedLayouts(layoutIds);
+}
+
 bool Editor::canPaintMetatiles() const {
     return this->editMode == EditMode::Metatiles && this->mapEditAction != EditAction::Select && this->mapEditAction != EditAction::Move;
 }
@@ -1936,39 +1964,11 @@ void Editor::clearMapGrid() {
 }
 
 void Editor::displayMapGrid() {
-    clearMapGrid();
-
-    // Note: The grid lines are not added to the scene. They need to be drawn on top of the overlay
-    //       elements of the scripting API, so they're painted manually in MapView::drawForeground.
-    this->mapGrid = new QGraphicsItemGroup();
-
-    const int pixelMapWidth = this->layout->pixelWidth();
-    const int pixelMapHeight = this->layout->pixelHeight();
-
-    // The grid can be moved with a user-specified x/y offset. The grid's dash patterns will only wrap in full pattern increments,
-    // so we draw an additional row/column outside the map that can be revealed as the offset changes.
-    const int offsetX = (this->gridSettings.offsetX % this->gridSettings.width) - this->gridSettings.width;
-    const int offsetY = (this->gridSettings.offsetY % this->gridSettings.height) - this->gridSettings.height;
-
-    QPen pen;
-    pen.setColor(this->gridSettings.color);
-
-    // Create vertical lines
-    pen.setDashPattern(this->gridSettings.getVerticalDashPattern());
-    for (int i = offsetX; i <= pixelMapWidth; i += this->gridSettings.width) {
-        auto line = new QGraphicsLineItem(i, offsetY, i, pixelMapHeight);
-        line->setPen(pen);
-        this->mapGrid->addToGroup(line);
-    }
-
-    // Create horizontal lines
-    pen.setDashPattern(this->gridSettings.getHorizontalDashPattern());
-    for (int i = offsetY; i <= pixelMapHeight; i += this->gridSettings.height) {
-        auto line = new QGraphicsLineItem(offsetX, i, pixelMapWidth, i);
-        line->setPen(pen);
-        this->mapGrid->addToGroup(line);
-    }
-
+    // Note: The grid is not added to the scene. It needs to be drawn on top of the overlay
+    //       elements of the scripting API, so it's painted manually in MapView::drawForeground.
+    if (!this->mapGrid)
+        this->mapGrid = new MapGrid();
+    this->mapGrid->setSettings(this->gridSettings);
     this->mapGrid->setVisible(porymapConfig.showGrid);
 }
 
@@ -2048,6 +2048,25 @@ void Editor::redrawEvents(const QList<Event*> &events) {
     }
 }
 
+// Event sprites are loaded in the background, and events are displayed with a default sprite until theirs is ready.
+// Only the events using the graphics that finished loading need to be redrawn.
+void Editor::redrawDefaultSpriteEvents(const QStringList &gfxNames) {
+    if (!this->map)
+        return;
+
+    const QSet<QString> loadedGfx(gfxNames.begin(), gfxNames.end());
+    QList<Event*> events;
+    for (const auto &event : this->map->getEvents(Event::Group::Object)) {
+        const auto object = dynamic_cast<ObjectEvent*>(event);
+        if (object && object->getUsesDefaultPixmap() && loadedGfx.contains(this->project->getEventGraphicsName(object->getGfx()))) {
+            // Reload the sprite first, the event's opacity depends on whether it still uses the default sprite.
+            this->project->loadEventPixmap(event, true);
+            events.append(event);
+        }
+    }
+    redrawEvents(events);
+}
+
 qreal Editor::getEventOpacity(const Event *event) const {
     // There are 4 possible opacities for an event's sprite:
     // - Off the Events tab, and the event overlay is off (0.0)
@@ -2480,4 +2499,18 @@ void Editor::setCollisionGraphics() {
         }
         collisionIcons.append(sublist);
     }
+
+    // Collect the icons into a single image, with a column for each collision value and a row for each elevation value.
+    // This lets collision images be written with direct copies from the atlas (see drawCollisionMetatileImage).
+    collisionAtlas = QImage(w * collisionIcons.length(), h * (Block::getMaxElevation() + 1), QImage::Format_RGBA8888);
+    collisionAtlas.fill(Qt::transparent);
+    QPainter painter(&collisionAtlas);
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
+    for (int collision = 0; collision < collisionIcons.length(); collision++) {
+        const QList<const QImage*> &sublist = collisionIcons.at(collision);
+        for (int elevation = 0; elevation < sublist.length(); elevation++) {
+            painter.drawImage(collision * w, elevation * h, *sublist.at(elevation));
+        }
+    }
+    painter.end();
 }
@@ -6,14 +6,42 @@
 #include <QLabel>
 #include <QPointer>
 #include <QTimer>
+#include <QThread>
+#include <QThreadPool>
+#include <QMutex>
+#include <QtConcurrent>
 
 namespace Log {
     static QString mostRecentError;
+    static QMutex mostRecentErrorMutex;
     static QString path;
     static QFile file;
-    static QTextStream textStream;
+    static QMutex fileMutex;
     static bool initialized = false;
 
+    // Lines are written to the log file in batches by a single background writer.
+    // Errors (and anything logged while the application is quitting) are written immediately,
+    // so that nothing important is lost if Porymap crashes.
+    static QStringList pendingLines;
+    static QTimer flushTimer;
+    static QThreadPool writer;
+    static bool writeImmediately = false;
+
+    // Repeats of the most recent message are counted rather than logged.
+    static QString lastMessage;
+    static LogType lastType;
+    static int numRepeats = 0;
+    static const int maxRepeats = 1000;
+
+    // The status bars only display the most recent message, so they're only updated once per frame.
+    struct PendingDisplay {
+        QString message;
+        quint64 order = 0;
+    };
+    static QMap<LogType, PendingDisplay> pendingDisplays;
+    static quint64 numDisplayed = 0;
+    static QTimer displayUpdateTimer;
+
     struct Display {
         QPointer<QStatusBar> statusBar;
         QPointer<QLabel> message;
@@ -22,6 +50,9 @@ namespace Log {
     };
     static QList<Display> displays;
     static QTimer displayClearTimer;
+
+    // Each thread has its own capture, so a background task only captures the messages it logs itself.
+    static thread_local LogCapture *capture = nullptr;
 };
 
 // Enabling this does not seem to be simple to color console output
@@ -38,6 +69,28 @@ namespace Log {
     #define CLEAR_COLOR   "\033[0m"
 #endif
 
+// Messages may be logged from worker threads (e.g. while tilesets are loading in the background),
+// but the log file and the status bar displays should only be touched from the main thread.
+static bool isMainThread() {
+    return !qApp || QThread::currentThread() == qApp->thread();
+}
+
+LogCapture::LogCapture() : m_previous(Log::capture) {
+    Log::capture = this;
+}
+
+LogCapture::~LogCapture() {
+    Log::capture = m_previous;
+}
+
+// Returns true if the message was taken by the calling thread's LogCapture, in which case it shouldn't be logged.
+bool captureLogMessage() {
+    if (!Log::capture)
+        return false;
+    Log::capture->m_numMessages++;
+    return true;
+}
+
 void logInfo(const QString &message) {
     log(message, LogType::LOG_INFO);
 }
@@ -47,7 +100,11 @@ void logWarn(const QString &message) {
 }
 
 void logError(const QString &message) {
+    if (captureLogMessage())
+        return;
+    Log::mostRecentErrorMutex.lock();
     Log::mostRecentError = message;
+    Log::mostRecentErrorMutex.unlock();
     log(message, LogType::LOG_ERROR);
 }
 
@@ -115,7 +172,7 @@ void pruneLogDisplays() {
     }
 }
 
-void updateLogDisplays(const QString &message, LogType type) {
+void updateLogDisplays() {
     static const QMap<LogType, QPixmap> icons = {
         {LogType::LOG_INFO,  QPixmap(QStringLiteral(":/icons/information.ico"))},
         {LogType::LOG_WARN,  QPixmap(QStringLiteral(":/icons/warning.ico"))},
@@ -125,14 +182,23 @@ void updateLogDisplays(const QString &message, LogType type) {
     pruneLogDisplays();
     bool startTimer = false;
     for (const auto &display : Log::displays) {
-        // Update the display, but only if it accepts this message type.
-        if (display.acceptedTypes.contains(type)) {
+        // Update the display with the most recent message it accepts, if any arrived since the last update.
+        LogType type = LogType::LOG_INFO;
+        const Log::PendingDisplay *latest = nullptr;
+        for (auto it = Log::pendingDisplays.constBegin(); it != Log::pendingDisplays.constEnd(); it++) {
+            if (display.acceptedTypes.contains(it.key()) && (!latest || it.value().order > latest->order)) {
+                type = it.key();
+                latest = &it.value();
+            }
+        }
+        if (latest) {
             display.icon->setPixmap(icons.value(type));
             display.statusBar->clearMessage();
-            display.message->setText(message);
+            display.message->setText(latest->message);
             startTimer = true;
         }
     }
+    Log::pendingDisplays.clear();
 
     // Auto-hide status bar messages after a set period of time
     if (startTimer) Log::displayClearTimer.start(5000);
@@ -146,7 +212,54 @@ void clearLogDisplays() {
     }
 }
 
-void log(const QString &message, LogType type) {
+static void writeLines(const QStringList &lines) {
+    if (lines.isEmpty())
+        return;
+    const QByteArray data = (lines.join('\n') + '\n').toUtf8();
+    QMutexLocker locker(&Log::fileMutex);
+    Log::file.write(data);
+    Log::file.flush();
+}
+
+// Write any pending lines to the log file. If 'wait' is false they're handed to the background writer.
+static void flushLog(bool wait) {
+    Log::flushTimer.stop();
+    const QStringList lines = Log::pendingLines;
+    Log::pendingLines.clear();
+
+    if (wait) {
+        // Finish any writes that are already in progress first, so that lines stay in order.
+        Log::writer.waitForDone();
+        writeLines(lines);
+    } else if (!lines.isEmpty()) {
+        // The writer runs one task at a time, so batches are written in the order they were queued.
+        (void)QtConcurrent::run(&Log::writer, [lines] { writeLines(lines); });
+    }
+}
+
+// Wait for all logged messages to be written to the log file, e.g. before opening it.
+void flushLog() {
+    // Pending lines are only touched by the main thread. Messages from other threads are already queued to it.
+    if (!isMainThread())
+        return;
+    flushLog(true);
+}
+
+// Queue a line to be written to the log file.
+static void writeLogFile(const QString &fullMessage, LogType type) {
+    if (!Log::initialized) {
+        return;
+    }
+
+    Log::pendingLines.append(fullMessage);
+    if (type == LogType::LOG_ERROR || Log::writeImmediately) {
+        flushLog(true);
+    } else if (!Log::flushTimer.isActive()) {
+        Log::flushTimer.start(1000);
+    }
+}
+
+static QString formatMessage(const QString &message, LogType type) {
     QString now = QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss");
     QString typeString = "";
     switch (type)
@@ -162,18 +275,51 @@ void log(const QString &message, LogType type) {
         break;
     }
 
-    QString fullMessage = QString("%1 %2 %3").arg(now).arg(typeString).arg(message);
+    return QString("%1 %2 %3").arg(now).arg(typeString).arg(message);
+}
+
+// If the most recent message was repeated, write how many times it was repeated to the log file.
+static void logRepeats() {
+    if (Log::numRepeats > 0) {
+        const QString message = QString("Previous message repeated %1 time(s)").arg(Log::numRepeats);
+        Log::numRepeats = 0;
+        writeLogFile(formatMessage(message, Log::lastType), Log::lastType);
+    }
+}
 
+static void writeLogMessage(const QString &message, LogType type) {
+    const QString fullMessage = formatMessage(message, type);
     qDebug().noquote() << colorizeMessage(fullMessage, type);
 
-    if (!Log::initialized) {
-        return;
+    // Some project errors can produce the same warning many times in a row. Rather than writing each of them
+    // to the log file, count them and write the total once a different message arrives. Errors are always written.
+    // The console and status bars still show every message, so they're never left showing something stale.
+    if (type != LogType::LOG_ERROR && type == Log::lastType && message == Log::lastMessage && Log::numRepeats < Log::maxRepeats) {
+        Log::numRepeats++;
+    } else {
+        logRepeats();
+        Log::lastMessage = message;
+        Log::lastType = type;
+        writeLogFile(fullMessage, type);
     }
 
-    updateLogDisplays(message, type);
+    if (Log::initialized) {
+        Log::pendingDisplays[type] = Log::PendingDisplay{message, ++Log::numDisplayed};
+        if (!Log::displayUpdateTimer.isActive())
+            Log::displayUpdateTimer.start();
+    }
+}
 
-    Log::textStream << fullMessage << Qt::endl;
-    Log::file.flush();
+void log(const QString &message, LogType type) {
+    if (captureLogMessage())
+        return;
+    if (!isMainThread()) {
+        // The message has already been checked against this thread's capture,
+        // it shouldn't be taken by whatever capture the main thread has when it arrives.
+        QMetaObject::invokeMethod(qApp, [message, type] { writeLogMessage(message, type); }, Qt::QueuedConnection);
+        return;
+    }
+    writeLogMessage(message, type);
 }
 
 QString getLogPath() {
@@ -181,10 +327,12 @@ QString getLogPath() {
 }
 
 QString getMostRecentError() {
+    QMutexLocker locker(&Log::mostRecentErrorMutex);
     return Log::mostRecentError;
 }
 
 bool cleanupLargeLog() {
+    QMutexLocker locker(&Log::fileMutex);
     return Log::file.size() >= 20000000 && Log::file.resize(0);
 }
 
@@ -196,12 +344,30 @@ void logInit() {
     Log::path = dir.absoluteFilePath(QStringLiteral("porymap.log"));
     Log::file.setFileName(Log::path);
     if (!Log::file.open(QIODevice::WriteOnly | QIODevice::Append)) return;
-    Log::textStream.setDevice(&Log::file);
 
     QObject::connect(&Log::displayClearTimer, &QTimer::timeout, [=] {
         clearLogDisplays();
     });
 
+    Log::displayUpdateTimer.setSingleShot(true);
+    Log::displayUpdateTimer.setInterval(16);
+    QObject::connect(&Log::displayUpdateTimer, &QTimer::timeout, [=] {
+        updateLogDisplays();
+    });
+
+    Log::writer.setMaxThreadCount(1);
+    Log::flushTimer.setSingleShot(true);
+    QObject::connect(&Log::flushTimer, &QTimer::timeout, [=] {
+        flushLog(false);
+    });
+
+    // Anything logged after this point (e.g. while the project is closing) is written immediately.
+    QObject::connect(qApp, &QCoreApplication::aboutToQuit, [=] {
+        logRepeats();
+        flushLog(true);
+        Log::writeImmediately = true;
+    });
+
     Log::initialized = true;
 
     if (cleanupLargeLog()) {
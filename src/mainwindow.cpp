@@ -29,6 +29,7 @@
 #include "newmapgroupdialog.h"
 #include "newlocationdialog.h"
 #include "loadingscreen.h"
+#include "paintprofiler.h"
 
 #include <QClipboard>
 #include <QDirIterator>
@@ -74,6 +75,11 @@ MainWindow::MainWindow(QWidget *parent) :
 
     ui->setupUi(this);
 
+    // The Map tab's icon is a preview of the current layout. It's refreshed at most once per interval, rather than on every edit.
+    mapTabIconTimer.setSingleShot(true);
+    mapTabIconTimer.setInterval(500);
+    connect(&mapTabIconTimer, &QTimer::timeout, this, &MainWindow::updateMapTabIcon);
+
     logInit();
     logInfo(QString("Launching Porymap v%1 (%2)").arg(QCoreApplication::applicationVersion()).arg(QStringLiteral(PORYMAP_LATEST_COMMIT)));
     logInfo(QString("Using Qt v%2 (%3)").arg(QStringLiteral(QT_VERSION_STR)).arg(QSysInfo::buildCpuArchitecture()));
@@ -343,6 +349,36 @@ void MainWindow::initCustomUI() {
     // Center zooming on the mouse
     ui->graphicsView_Map->setTransformationAnchor(QGraphicsView::ViewportAnchor::AnchorUnderMouse);
     ui->graphicsView_Map->setResizeAnchor(QGraphicsView::ViewportAnchor::AnchorUnderMouse);
+
+    // Readout of the memory used by loaded layouts and tilesets
+    this->label_CacheStatus = new QLabel(this);
+    statusBar()->addPermanentWidget(this->label_CacheStatus);
+}
+
+void MainWindow::updateCacheStatus() {
+    if (!this->label_CacheStatus)
+        return;
+
+    const Project *project = this->editor ? this->editor->project : nullptr;
+    if (!project) {
+        this->label_CacheStatus->clear();
+        this->label_CacheStatus->setToolTip(QString());
+        return;
+    }
+
+    const qint64 layoutCacheSize = project->getLayoutCacheSize();
+    const qint64 tilesetCacheSize = project->getTilesetCacheSize();
+    this->label_CacheStatus->setText(QString("Cache: %1").arg(locale().formattedDataSize(layoutCacheSize + tilesetCacheSize)));
+
+    QString toolTip = QString("%1 layout(s) loaded, using %2\n%3 tileset(s) loaded, using %4")
+                        .arg(project->numLoadedLayouts())
+                        .arg(locale().formattedDataSize(layoutCacheSize))
+                        .arg(project->numLoadedTilesets())
+                        .arg(locale().formattedDataSize(tilesetCacheSize));
+    if (porymapConfig.cacheMemoryLimit > 0) {
+        toolTip.append(QString("\nLimit: %1 MiB").arg(porymapConfig.cacheMemoryLimit));
+    }
+    this->label_CacheStatus->setToolTip(toolTip);
 }
 
 void MainWindow::overrideMainTabIcons(const QIcon& icon) {
@@ -649,10 +685,24 @@ void MainWindow::updateWindowTitle() {
         );
     }
 
+    if (!mapTabIconTimer.isActive())
+        mapTabIconTimer.start();
+}
+
+void MainWindow::updateMapTabIcon() {
+    if (!editor || !editor->layout)
+        return;
+
     // For some reason (perhaps on Qt < 6?) we had to clear the icon first here or mainTabBar wouldn't display correctly.
     ui->mainTabBar->setTabIcon(MainTab::Map, QIcon());
 
-    QPixmap pixmap = editor->layout->pixmap;
+    // Large layouts are displayed in chunks and have no full-size pixmap, so their icon is rendered separately.
+    QPixmap pixmap;
+    if (editor->map_item && editor->map_item->layout == editor->layout && editor->map_item->isChunked()) {
+        pixmap = QPixmap::fromImage(editor->layout->renderThumbnail());
+    } else {
+        pixmap = editor->layout->pixmap;
+    }
     if (!pixmap.isNull()) {
         ui->mainTabBar->setTabIcon(MainTab::Map, QIcon(pixmap));
     } else {
@@ -819,8 +869,10 @@ bool MainWindow::openProject(QString dir, bool initial) {
     // Create the project
     auto project = new Project(editor);
     project->setRoot(dir);
-    connect(project, &Project::fileChanged, this, &MainWindow::showFileWatcherWarning);
+    connect(project, &Project::filesChanged, this, &MainWindow::showFileWatcherWarning);
     connect(project, &Project::mapLoaded, this, &MainWindow::onMapLoaded);
+    connect(project, &Project::cacheSizeChanged, this, &MainWindow::updateCacheStatus);
+    connect(project, &Project::layoutUnloaded, this, &MainWindow::onLayoutUnloaded);
     connect(project, &Project::mapCreated, this, &MainWindow::onNewMapCreated);
     connect(project, &Project::layoutCreated, this, &MainWindow::onNewLayoutCreated);
     connect(project, &Project::tilesetCreated, this, &MainWindow::onNewTilesetCreated);
@@ -863,6 +915,10 @@ bool MainWindow::openProject(QString dir, bool initial) {
     Scripting::cb_ProjectOpened(dir);
     setWindowDisabled(false);
     porysplash->stop();
+
+    if (porymapConfig.preloadTilesets) {
+        this->editor->project->preloadTilesets();
+    }
     return true;
 }
 
@@ -1204,6 +1260,8 @@ bool MainWindow::setMap(const QString &mapName) {
     prefab.updatePrefabUi(editor->layout);
     updateTilesetEditor();
 
+    editor->project->prefetchMapNeighbors(editor->map);
+
     emit mapOpened(editor->map);
 
     return true;
@@ -1552,6 +1610,7 @@ void MainWindow::clearProjectUI() {
     ui->mapListToolBar_Locations->clearFilter();
     ui->mapListToolBar_Layouts->clearFilter();
     resetMapNavigation();
+    updateCacheStatus();
 }
 
 void MainWindow::scrollMapList(MapTree *list, const QString &itemName, bool expandItem) {
@@ -2354,6 +2413,29 @@ void MainWindow::on_actionShow_Grid_triggered() {
     this->editor->toggleGrid(ui->actionShow_Grid->isChecked());
 }
 
+void MainWindow::on_actionShow_Paint_Latency_toggled(bool enabled) {
+    if (enabled) PaintProfiler::reset();
+    PaintProfiler::setEnabled(enabled);
+    ui->graphicsView_Map->setLatencyHudVisible(enabled);
+}
+
+void MainWindow::on_actionExport_Paint_Latency_Report_triggered() {
+    if (PaintProfiler::numInteractions() == 0) {
+        InfoMessage::show(QStringLiteral("No paint latency has been recorded. Enable View > Show Paint Latency and edit the map first."), this);
+        return;
+    }
+
+    const QString defaultFilepath = QString("%1/paint_latency.json").arg(FileDialog::getDirectory());
+    const QString filepath = FileDialog::getSaveFileName(this, QStringLiteral("Export Paint Latency Report"), defaultFilepath, QStringLiteral("JSON Files (*.json)"));
+    if (filepath.isEmpty())
+        return;
+
+    QString error;
+    if (!PaintProfiler::writeJson(filepath, &error)) {
+        ErrorMessage::show(QString("Failed to export paint latency report to '%1'.").arg(filepath), error, this);
+    }
+}
+
 void MainWindow::on_actionGrid_Settings_triggered() {
     if (!this->gridSettingsDialog) {
         this->gridSettingsDialog = new GridSettingsDialog(&this->editor->gridSettings, this);
@@ -2677,7 +2759,10 @@ void MainWindow::on_slider_EmergeMapOpacity_valueChanged(int value) {
 void MainWindow::on_horizontalSlider_CollisionTransparency_valueChanged(int value) {
     this->editor->collisionOpacity = static_cast<qreal>(value) / 100;
     porymapConfig.collisionOpacity = value;
-    this->editor->collision_item->draw(true);
+
+    // The collision layer is drawn on top of the map with the item's opacity, so it doesn't need to be rendered again.
+    if (this->editor->collision_item)
+        this->editor->collision_item->setOpacity(this->editor->collisionOpacity);
 }
 
 void MainWindow::on_actionPencil_triggered()     { on_toolButton_Paint_clicked(); }
@@ -2714,6 +2799,12 @@ void MainWindow::onMapLoaded(Map *map) {
     connect(map, &Map::modified, [this, map] { markMapEdited(map); });
 }
 
+// Layouts can be unloaded in the background to free memory, so their icons in the layout list need to be updated.
+void MainWindow::onLayoutUnloaded(const QString &layoutId) {
+    if (this->layoutTreeModel)
+        this->layoutTreeModel->updateItem(layoutId);
+}
+
 void MainWindow::onTilesetsSaved(QString primaryTilesetLabel, QString secondaryTilesetLabel) {
     // If saved tilesets are currently in-use, update them and redraw
     // Otherwise overwrite the cache for the saved tileset
@@ -3026,6 +3117,7 @@ void MainWindow::on_actionAbout_Porymap_triggered()
 }
 
 void MainWindow::on_actionOpen_Log_File_triggered() {
+    flushLog();
     const QString logPath = getLogPath();
     const int lineCount = ParseUtil::textFileLineCount(logPath);
     this->editor->openInTextEditor(logPath, lineCount);
@@ -3198,6 +3290,28 @@ void MainWindow::on_actionRegion_Map_Editor_triggered() {
     Util::show(this->regionMapEditor);
 }
 
+void MainWindow::on_actionValidate_Project_triggered() {
+    if (!isProjectOpen())
+        return;
+
+    if (!this->projectValidatorDialog) {
+        this->projectValidatorDialog = new ProjectValidatorDialog(this->editor->project, this);
+        connect(this->projectValidatorDialog, &ProjectValidatorDialog::openMapRequested, this, &MainWindow::userSetMap);
+        this->projectValidatorDialog->run();
+    }
+    Util::show(this->projectValidatorDialog);
+}
+
+void MainWindow::on_actionMemory_Usage_triggered() {
+    if (!isProjectOpen())
+        return;
+
+    if (!this->memoryInspector) {
+        this->memoryInspector = new MemoryInspector(this->editor->project, this);
+    }
+    Util::show(this->memoryInspector);
+}
+
 void MainWindow::on_pushButton_CreatePrefab_clicked() {
     auto dialog = new PrefabCreationDialog(this, this->editor->metatile_selector_item, this->editor->layout);
     dialog->setAttribute(Qt::WA_DeleteOnClose);
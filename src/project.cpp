@@ -11,17 +11,26 @@
 #include "validator.h"
 #include "orderedjson.h"
 #include "utility.h"
+#include "editcommands.h"
+#include "scripting.h"
+#include "editor.h"
 
 #include <QDir>
+#include <QDirIterator>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonValue>
 #include <QFile>
+#include <QFileInfo>
 #include <QTextStream>
 #include <QStandardItem>
 #include <QMessageBox>
 #include <QRegularExpression>
+#include <QTimer>
+#include <QPixmapCache>
+#include <QThread>
+#include <QtConcurrent>
 #include <algorithm>
 
 int Project::num_tiles_primary = 512;
@@ -32,18 +41,55 @@ int Project::num_pals_total = 13;
 
 Project::Project(QObject *parent) :
     QObject(parent)
-{ }
+{
+    // Leave a thread free so that background loading (preloaded tilesets, prefetched maps) doesn't compete with tilesets requested by the user.
+    this->tilesetPreloadPool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() - 1));
+
+    // Most event sprites are 16x32 or 32x32, so this can hold thousands of them.
+    this->eventPixmapCache.setMaxCost(16 * 1024 * 1024);
+
+    this->speciesIconPool.setMaxThreadCount(1);
+    this->speciesIconPool.setExpiryTimeout(5000);
+}
 
 Project::~Project()
 {
+    cancelTilesetPreloads();
+    this->tilesetPreloadPool.waitForDone();
+    for (const auto &preload : this->canceledTilesetPreloads) {
+        delete preload.watcher;
+        delete preload.tileset;
+    }
+    this->canceledTilesetPreloads.clear();
+    resetFileWatcher();
     clearMaps();
     clearTilesetCache();
     clearMapLayouts();
     clearEventGraphics();
     clearHealLocations();
+    clearSpeciesIcons();
     QPixmapCache::clear();
 }
 
+// Returns the model for the list identified by 'key', creating it from 'items' if necessary.
+// The model is owned by the project, so any number of widgets can share it without copying the list.
+// Existing models are kept up to date by updateStringListModel when their list is re-read, not here.
+QStringListModel *Project::getStringListModel(const QString &key, const QStringList &items) {
+    QStringListModel *model = this->stringListModels.value(key);
+    if (!model) {
+        model = new QStringListModel(items, this);
+        this->stringListModels.insert(key, model);
+    }
+    return model;
+}
+
+// Called when the list identified by 'key' is read, so that the dropdowns sharing its model are only reset if it changed.
+void Project::updateStringListModel(const QString &key, const QStringList &items) {
+    QStringListModel *model = this->stringListModels.value(key);
+    if (model && model->stringList() != items)
+        model->setStringList(items);
+}
+
 void Project::setRoot(const QString &dir) {
     this->root = dir;
     FileDialog::setDirectory(dir);
@@ -186,6 +232,7 @@ bool Project::load() {
     resetFileWatcher();
     resetFileCache();
     QPixmapCache::clear();
+    clearSpeciesIcons();
 
     this->disabledSettingsNames.clear();
     bool success = readGlobalConstants()
@@ -264,14 +311,19 @@ QString Project::getProjectTitle() const {
 }
 
 void Project::clearMaps() {
+    cancelMapPrefetches();
     qDeleteAll(this->maps);
     this->maps.clear();
     this->loadedMapNames.clear();
 }
 
 void Project::clearTilesetCache() {
+    cancelTilesetPreloads();
     qDeleteAll(this->tilesetCache);
     this->tilesetCache.clear();
+    this->tilesetLastUsed.clear();
+    this->tilesetCacheSizes.clear();
+    this->tilesetCacheSize = 0;
 }
 
 void Project::cacheTileset(const QString &name, Tileset *tileset) {
@@ -283,6 +335,10 @@ void Project::cacheTileset(const QString &name, Tileset *tileset) {
         delete it.value();
     }
     this->tilesetCache.insert(name, tileset);
+    setTilesetCacheSize(name, tileset ? tileset->memoryUsage() : 0);
+
+    // Tilesets count as used when they're cached, otherwise preloaded tilesets would be the first to be unloaded.
+    touchTileset(name);
 }
 
 Map* Project::loadMap(const QString &mapName) {
@@ -305,8 +361,12 @@ Map* Project::loadMap(const QString &mapName) {
         return nullptr;
     }
 
-    if (isLoadedMap(mapName))
+    if (isLoadedMap(mapName)) {
+        // The map's layout may have been unloaded to stay within the cache memory limit, in which case we reload it now.
+        if (map->isPersistedToFile() && !isLoadedLayout(map->layoutId()) && !loadLayout(map->layoutId()))
+            return nullptr;
         return map;
+    }
 
     if (!loadMapData(map))
         return nullptr;
@@ -330,19 +390,32 @@ Layout *Project::loadLayout(const QString &layoutId) {
         return nullptr;
     }
 
-    if (isLoadedLayout(layoutId))
+    if (isLoadedLayout(layoutId)) {
+        touchLayout(layout);
         return layout;
+    }
+
+    // Use the layout's files if they were already read in the background, and haven't changed since.
+    LayoutFileData prefetched;
+    auto it = this->layoutFilePrefetches.find(layoutId);
+    if (it != this->layoutFilePrefetches.end()) {
+        prefetched = it.value().result();
+        this->layoutFilePrefetches.erase(it);
+    }
+    const bool usePrefetched = prefetched.isCurrent();
 
     // Force these to run even if one fails
     bool loadedTilesets = loadLayoutTilesets(layout);
-    bool loadedBlockdata = layout->loadBlockdata(this->root);
-    bool loadedBorder = layout->loadBorder(this->root);
+    bool loadedBlockdata = layout->loadBlockdata(this->root, usePrefetched ? &prefetched.blockdata : nullptr);
+    bool loadedBorder = layout->loadBorder(this->root, usePrefetched ? &prefetched.border : nullptr);
     if (!loadedTilesets || !loadedBlockdata || !loadedBorder) {
         // Error should already be logged.
         return nullptr;
     }
 
     this->loadedLayoutIds.insert(layoutId);
+    touchLayout(layout);
+    scheduleCacheEviction();
     return layout;
 }
 
@@ -378,9 +451,19 @@ QSet<QString> Project::getTopLevelMapFields() const {
 }
 
 QJsonDocument Project::readMapJson(const QString &mapName, QString *error) {
-    // Note: We are explicitly not adding mapFilepath to the fileWatcher here.
+    // Note: We are explicitly not adding mapFilepath to the file watcher here.
     //       All map.json files are read at launch, and adding them all to the filewatcher
     //       can easily exceed the 256 file limit that exists on some platforms.
+    auto it = this->mapJsonPrefetches.find(mapName);
+    if (it != this->mapJsonPrefetches.end()) {
+        const MapJsonData prefetched = it.value().result();
+        this->mapJsonPrefetches.erase(it);
+        // If the prefetch failed we read the file again below, so that the error can be reported.
+        if (prefetched.isCurrent()) {
+            return prefetched.doc;
+        }
+    }
+
     const QString mapFilepath = Map::getJsonFilepath(mapName);
     QJsonDocument doc;
     if (!parser.tryParseJsonFile(&doc, mapFilepath, error)) {
@@ -547,6 +630,14 @@ Map *Project::createNewMap(const Project::NewMapSettings &settings, const Map* t
     this->alphabeticalMapNames.append(map->name());
     Util::numericalModeSort(this->alphabeticalMapNames);
 
+    // Insert the new name into the shared map name model rather than resetting it for every dropdown.
+    QStringListModel *mapNamesModel = this->stringListModels.value("mapNames");
+    if (mapNamesModel) {
+        int row = this->alphabeticalMapNames.indexOf(map->name());
+        if (mapNamesModel->insertRows(row, 1))
+            mapNamesModel->setData(mapNamesModel->index(row), map->name());
+    }
+
     map->setIsPersistedToFile(false);
     this->maps.insert(map->name(), map);
 
@@ -595,6 +686,7 @@ Layout *Project::createNewLayout(const Layout::Settings &settings, const Layout
     this->mapLayouts.insert(layout->id, layout);
     this->orderedLayoutIds.append(layout->id);
     this->loadedLayoutIds.insert(layout->id);
+    touchLayout(layout);
     this->alphabeticalLayoutIds.append(layout->id);
     Util::numericalModeSort(this->alphabeticalLayoutIds);
 
@@ -604,6 +696,7 @@ Layout *Project::createNewLayout(const Layout::Settings &settings, const Layout
 }
 
 void Project::clearMapLayouts() {
+    cancelMapPrefetches();
     qDeleteAll(this->mapLayouts);
     this->mapLayouts.clear();
     qDeleteAll(this->mapLayoutsMaster);
@@ -612,6 +705,10 @@ void Project::clearMapLayouts() {
     this->orderedLayoutIds.clear();
     this->orderedLayoutIdsMaster.clear();
     this->loadedLayoutIds.clear();
+    this->layoutLastUsed.clear();
+    this->layoutCacheSizes.clear();
+    this->layoutCacheSize = 0;
+    this->displayedLayoutIds.clear();
     this->customLayoutsData = QJsonObject();
     this->failedLayoutsData.clear();
 }
@@ -763,15 +860,14 @@ bool Project::watchFile(const QString &filename) {
     if (!porymapConfig.monitorFiles)
         return true;
 
-    if (!this->fileWatcher) {
-        // Only create the file watcher when it's first needed (even an empty QFileSystemWatcher will consume system resources).
-        this->fileWatcher = new QFileSystemWatcher(this);
-        if (!this->fileWatcher) return false;
-        QObject::connect(this->fileWatcher, &QFileSystemWatcher::fileChanged, this, &Project::recordFileChange);
-    }
+    // The watcher is shared with the maps (which watch their scripts files), so it may report files this project isn't watching.
+    FileWatcher *fileWatcher = FileWatcher::instance();
+    QObject::connect(fileWatcher, &FileWatcher::filesChanged, this, &Project::recordFileChanges, Qt::UniqueConnection);
 
     QString filepath = filename.startsWith(this->root) ? filename : QString("%1/%2").arg(this->root).arg(filename);
-    if (!this->fileWatcher->addPath(filepath) && !this->fileWatcher->files().contains(filepath)) {
+    if (this->watchedFiles.contains(filepath))
+        return true;
+    if (!fileWatcher->addFile(filepath)) {
         // We failed to watch the file, and this wasn't a file we were already watching.
         // Record the filepath for logging later, assuming we should have been able to watch the file.
         if (QFileInfo::exists(filepath)) {
@@ -779,6 +875,7 @@ bool Project::watchFile(const QString &filename) {
         }
         return false;
     }
+    this->watchedFiles.insert(filepath);
     return true;
 }
 
@@ -791,11 +888,10 @@ bool Project::watchFiles(const QStringList &filenames) {
 }
 
 bool Project::stopFileWatch(const QString &filename) {
-    if (!this->fileWatcher)
-        return true;
-
     QString filepath = filename.startsWith(this->root) ? filename : QString("%1/%2").arg(this->root).arg(filename);
-    return this->fileWatcher->removePath(filepath);
+    if (!this->watchedFiles.remove(filepath))
+        return true;
+    return FileWatcher::instance()->removeFile(filepath);
 }
 
 void Project::ignoreWatchedFileTemporarily(const QString &filepath) {
@@ -809,40 +905,41 @@ void Project::ignoreWatchedFilesTemporarily(const QStringList &filepaths) {
     }
 }
 
-void Project::recordFileChange(const QString &filepath) {
-    // --From the Qt manual--
-    // Note: As a safety measure, many applications save an open file by writing a new file and then deleting the old one.
-    //       In your slot function, you can check watcher.files().contains(path).
-    //       If it returns false, check whether the file still exists and then call addPath() to continue watching it.
-    if (this->fileWatcher && !this->fileWatcher->files().contains(filepath) && QFileInfo::exists(filepath)) {
-        this->fileWatcher->addPath(filepath);
-    }
-
-    if (this->modifiedFiles.contains(filepath)) {
-        // We already recorded a change to this file
-        return;
-    }
+// The file watcher reports changes in batches (e.g. all the files changed by a git checkout), so we only notify once per batch.
+void Project::recordFileChanges(const QStringList &filepaths) {
+    QStringList newChanges;
+    for (const auto &filepath : filepaths) {
+        if (!this->watchedFiles.contains(filepath)) {
+            // Changes to files watched by the maps are handled by the maps.
+            continue;
+        }
+        if (this->modifiedFiles.contains(filepath)) {
+            // We already recorded a change to this file
+            continue;
+        }
 
-    if (this->modifiedFileTimestamps.contains(filepath)) {
-        if (QDateTime::currentMSecsSinceEpoch() < this->modifiedFileTimestamps[filepath]) {
-            // We're still ignoring changes to this file
-            return;
+        if (this->modifiedFileTimestamps.contains(filepath)) {
+            if (QDateTime::currentMSecsSinceEpoch() < this->modifiedFileTimestamps[filepath]) {
+                // We're still ignoring changes to this file
+                continue;
+            }
+            this->modifiedFileTimestamps.remove(filepath);
         }
-        this->modifiedFileTimestamps.remove(filepath);
+
+        this->modifiedFiles.insert(filepath);
+        newChanges.append(filepath);
     }
 
-    this->modifiedFiles.insert(filepath);
-    emit fileChanged(filepath);
+    if (!newChanges.isEmpty())
+        emit filesChanged(newChanges);
 }
 
 // When calling 'watchFile' we record failures rather than log them immediately.
 // We do this primarily to condense the warning if we fail to monitor any files.
 void Project::logFileWatchStatus() {
     Map::setFileWatchingEnabled(porymapConfig.monitorFiles);
-    if (!this->fileWatcher)
-        return;
 
-    int numSuccessful = this->fileWatcher->files().length();
+    int numSuccessful = this->watchedFiles.count();
     int numAttempted = numSuccessful + this->failedFileWatchPaths.count();
     if (numAttempted == 0)
         return;
@@ -857,7 +954,11 @@ void Project::logFileWatchStatus() {
         Map::setFileWatchingEnabled(false);
         return;
     } else {
-        logInfo(QString("Successfully monitoring %1/%2 project files").arg(numSuccessful).arg(numAttempted));
+        logInfo(QString("Successfully monitoring %1/%2 project files (in %3 directories, using %4 system file watches)")
+                        .arg(numSuccessful)
+                        .arg(numAttempted)
+                        .arg(FileWatcher::instance()->numWatchedDirectories())
+                        .arg(FileWatcher::instance()->numSystemWatches()));
     }
 
     for (const auto &failedPath : this->failedFileWatchPaths) {
@@ -867,8 +968,13 @@ void Project::logFileWatchStatus() {
 
 void Project::resetFileWatcher() {
     this->failedFileWatchPaths.clear();
-    delete this->fileWatcher;
-    this->fileWatcher = nullptr;
+    if (this->watchedFiles.isEmpty())
+        return;
+    FileWatcher *fileWatcher = FileWatcher::instance();
+    for (const auto &filepath : this->watchedFiles) {
+        fileWatcher->removeFile(filepath);
+    }
+    this->watchedFiles.clear();
 }
 
 bool Project::saveMapGroups() {
@@ -1215,12 +1321,18 @@ Tileset* Project::getTileset(const QString &label, bool forceLoad) {
         return nullptr;
     }
 
+    // If the tileset is currently being loaded in the background we wait for it to finish, rather than loading it twice.
+    if (this->tilesetPreloads.contains(label)) {
+        finishTilesetPreload(label);
+    }
+
     Tileset *tileset = nullptr;
 
     auto it = this->tilesetCache.constFind(label);
     if (it != this->tilesetCache.constEnd()) {
         tileset = it.value();
         if (!forceLoad) {
+            touchTileset(label);
             return tileset;
         }
     } else {
@@ -1229,42 +1341,16 @@ Tileset* Project::getTileset(const QString &label, bool forceLoad) {
         cacheTileset(label, nullptr);
     }
 
-    auto memberMap = Tileset::getHeaderMemberMap(this->usingAsmTilesets);
-    if (this->usingAsmTilesets) {
-        // Read asm tileset header. Backwards compatibility
-        const QString path = projectConfig.getFilePath(ProjectFilePath::tilesets_headers_asm);
-        const QStringList values = parser.getLabelValues(parser.parseAsm(path), label);
-        if (values.isEmpty()) {
-            logError(QString("Failed to find header data in '%1' for tileset '%2'.").arg(path).arg(label));
-            return nullptr;
-        }
-        if (tileset == nullptr) {
-            tileset = new Tileset;
-        }
-        tileset->name = label;
-        tileset->is_secondary = ParseUtil::gameStringToBool(values.value(memberMap.key("isSecondary")));
-        tileset->tiles_label = values.value(memberMap.key("tiles"));
-        tileset->palettes_label = values.value(memberMap.key("palettes"));
-        tileset->metatiles_label = values.value(memberMap.key("metatiles"));
-        tileset->metatile_attrs_label = values.value(memberMap.key("metatileAttributes"));
-    } else {
-        // Read C tileset header
-        const QString path = projectConfig.getFilePath(ProjectFilePath::tilesets_headers);
-        auto structs = parser.readCStructs(path, label, memberMap);
-        if (!structs.contains(label)) {
-            logError(QString("Failed to find header data in '%1' for tileset '%2'.").arg(path).arg(label));
-            return nullptr;
-        }
-        if (tileset == nullptr) {
-            tileset = new Tileset;
-        }
-        auto tilesetAttributes = structs[label];
-        tileset->name = label;
-        tileset->is_secondary = ParseUtil::gameStringToBool(tilesetAttributes.value("isSecondary"));
-        tileset->tiles_label = tilesetAttributes.value("tiles");
-        tileset->palettes_label = tilesetAttributes.value("palettes");
-        tileset->metatiles_label = tilesetAttributes.value("metatiles");
-        tileset->metatile_attrs_label = tilesetAttributes.value("metatileAttributes");
+    const bool isNewTileset = (tileset == nullptr);
+    if (isNewTileset) {
+        tileset = new Tileset;
+    }
+
+    QString error;
+    if (!readTilesetHeader(label, tileset, &error)) {
+        logError(error);
+        if (isNewTileset) delete tileset;
+        return nullptr;
     }
 
     if (!loadTilesetAssets(tileset)) {
@@ -1274,9 +1360,665 @@ Tileset* Project::getTileset(const QString &label, bool forceLoad) {
     }
 
     cacheTileset(tileset->name, tileset);
+    touchTileset(tileset->name);
+    scheduleCacheEviction();
     return tileset;
 }
 
+bool Project::readTilesetHeader(const QString &label, Tileset *tileset, QString *error) {
+    if (!this->tilesetHeadersRead)
+        readTilesetHeaders();
+
+    auto it = this->tilesetHeaders.constFind(label);
+    if (it == this->tilesetHeaders.constEnd()) {
+        const QString path = projectConfig.getFilePath(this->usingAsmTilesets ? ProjectFilePath::tilesets_headers_asm : ProjectFilePath::tilesets_headers);
+        if (error) *error = QString("Failed to find header data in '%1' for tileset '%2'.").arg(path).arg(label);
+        return false;
+    }
+    const QHash<QString, QString> &tilesetAttributes = it.value();
+    tileset->name = label;
+    tileset->is_secondary = ParseUtil::gameStringToBool(tilesetAttributes.value("isSecondary"));
+    tileset->tiles_label = tilesetAttributes.value("tiles");
+    tileset->palettes_label = tilesetAttributes.value("palettes");
+    tileset->metatiles_label = tilesetAttributes.value("metatiles");
+    tileset->metatile_attrs_label = tilesetAttributes.value("metatileAttributes");
+    return true;
+}
+
+// Parse the header of every tileset at once, rather than parsing the headers file again for each tileset that's loaded.
+void Project::readTilesetHeaders() {
+    this->tilesetHeaders.clear();
+    this->tilesetHeadersRead = true;
+
+    const auto memberMap = Tileset::getHeaderMemberMap(this->usingAsmTilesets);
+    if (this->usingAsmTilesets) {
+        // Read asm tileset headers. Backwards compatibility
+        const QList<QStringList> headers = parser.parseAsm(projectConfig.getFilePath(ProjectFilePath::tilesets_headers_asm));
+        for (const auto &label : this->tilesetLabelsOrdered) {
+            const QStringList values = parser.getLabelValues(headers, label);
+            if (values.isEmpty())
+                continue;
+            QHash<QString, QString> tilesetAttributes;
+            for (auto member = memberMap.constBegin(); member != memberMap.constEnd(); member++) {
+                tilesetAttributes.insert(member.value(), values.value(member.key()));
+            }
+            this->tilesetHeaders.insert(label, tilesetAttributes);
+        }
+    } else {
+        // Read C tileset headers
+        const auto structs = parser.readCStructs(projectConfig.getFilePath(ProjectFilePath::tilesets_headers), "", memberMap);
+        for (auto i = structs.cbegin(); i != structs.cend(); i++) {
+            this->tilesetHeaders.insert(i.key(), i.value());
+        }
+    }
+}
+
+// Begin loading every tileset used by the project's layouts in the background,
+// so that opening a map with tilesets we haven't seen yet doesn't need to wait for them to load.
+// Reading the tileset headers and asset paths relies on the (single-threaded) parser, so that part
+// happens on the main thread, one tileset per event loop iteration. Only decoding the assets happens on worker threads.
+void Project::preloadTilesets() {
+    QSet<QString> queued;
+    for (const auto &layoutId : this->orderedLayoutIds) {
+        const Layout *layout = this->mapLayouts.value(layoutId);
+        if (!layout) continue;
+        for (const auto &label : {layout->tileset_primary_label, layout->tileset_secondary_label}) {
+            if (label.isEmpty() || queued.contains(label) || this->tilesetCache.contains(label) || this->tilesetPreloads.contains(label))
+                continue;
+            if (!this->tilesetLabelsOrdered.contains(label))
+                continue;
+            queued.insert(label);
+            this->tilesetPreloadQueue.append(label);
+        }
+    }
+    if (!this->tilesetPreloadQueue.isEmpty()) {
+        QTimer::singleShot(0, this, &Project::preloadNextTileset);
+    }
+}
+
+void Project::preloadNextTileset() {
+    if (this->tilesetPreloadQueue.isEmpty())
+        return;
+
+    // Preloading would just cause other tilesets to be unloaded.
+    if (isOverCacheMemoryLimit()) {
+        this->tilesetPreloadQueue.clear();
+        return;
+    }
+
+    const QString label = this->tilesetPreloadQueue.takeFirst();
+    if (!this->tilesetCache.contains(label) && !this->tilesetPreloads.contains(label)) {
+        auto tileset = new Tileset;
+        if (readTilesetHeader(label, tileset, nullptr)) {
+            readTilesetPaths(tileset);
+            loadTilesetMetatileLabels(tileset);
+
+            auto watcher = new QFutureWatcher<bool>(this);
+            connect(watcher, &QFutureWatcher<bool>::finished, this, [this, label] {
+                finishTilesetPreload(label);
+                processMapPrefetches();
+            });
+            this->tilesetPreloads.insert(label, {tileset, watcher});
+            // The tileset is loaded entirely on this worker, so that preloads don't queue more work behind each other.
+            const int generation = this->tilesetPreloadGeneration.loadRelaxed();
+            watcher->setFuture(QtConcurrent::run(&this->tilesetPreloadPool, [this, tileset, generation] {
+                // Tilesets that haven't started loading when the preload is canceled are skipped.
+                if (generation != this->tilesetPreloadGeneration.loadRelaxed())
+                    return false;
+                // Any problems are reported if the tileset is loaded again normally, so a load that logs anything is discarded.
+                LogCapture capture;
+                return tileset->load() && capture.numMessages() == 0;
+            }));
+        } else {
+            // Header errors will be reported if the tileset is ever loaded normally.
+            delete tileset;
+        }
+    }
+
+    if (!this->tilesetPreloadQueue.isEmpty()) {
+        QTimer::singleShot(0, this, &Project::preloadNextTileset);
+    }
+}
+
+// Move a tileset that was being loaded in the background into the tileset cache, waiting for it to finish loading if necessary.
+void Project::finishTilesetPreload(const QString &label) {
+    auto it = this->tilesetPreloads.find(label);
+    if (it == this->tilesetPreloads.end())
+        return;
+    TilesetPreload preload = it.value();
+    this->tilesetPreloads.erase(it);
+
+    preload.watcher->disconnect(this);
+    preload.watcher->waitForFinished();
+    const bool success = preload.watcher->result();
+    preload.watcher->deleteLater();
+
+    // The tileset may have been loaded normally in the meantime (e.g. if it was created by the user).
+    // If the background load failed we discard the result, the errors will be reported again if the user tries to open it.
+    if (success && !this->tilesetCache.value(label)) {
+        cacheTileset(label, preload.tileset);
+    } else {
+        delete preload.tileset;
+    }
+}
+
+// Cancel the tileset preloads without waiting for them. Loads that are already running can't be interrupted,
+// so their tilesets are discarded once they finish.
+void Project::cancelTilesetPreloads() {
+    this->tilesetPreloadQueue.clear();
+    if (this->tilesetPreloads.isEmpty())
+        return;
+
+    this->tilesetPreloadGeneration.fetchAndAddRelaxed(1);
+    for (auto it = this->tilesetPreloads.begin(); it != this->tilesetPreloads.end(); it++) {
+        const TilesetPreload preload = it.value();
+        preload.watcher->disconnect(this);
+        this->canceledTilesetPreloads.append(preload);
+        connect(preload.watcher, &QFutureWatcher<bool>::finished, this, [this, preload] {
+            this->canceledTilesetPreloads.removeOne(preload);
+            preload.watcher->deleteLater();
+            delete preload.tileset;
+        });
+    }
+    this->tilesetPreloads.clear();
+}
+
+// Move a tileset to the front of the preload queue, e.g. because a map that uses it is being prefetched.
+void Project::prioritizeTilesetPreload(const QString &label) {
+    if (!porymapConfig.preloadTilesets)
+        return;
+    if (label.isEmpty() || !this->tilesetLabelsOrdered.contains(label))
+        return;
+    if (this->tilesetCache.contains(label) || this->tilesetPreloads.contains(label))
+        return;
+
+    const bool wasIdle = this->tilesetPreloadQueue.isEmpty();
+    this->tilesetPreloadQueue.removeOne(label);
+    this->tilesetPreloadQueue.prepend(label);
+    if (wasIdle) {
+        QTimer::singleShot(0, this, &Project::preloadNextTileset);
+    }
+}
+
+bool Project::isTilesetPreloadPending(const QString &label) const {
+    return this->tilesetPreloads.contains(label) || this->tilesetPreloadQueue.contains(label);
+}
+
+// Begin loading the maps the user is most likely to open next from the given map: the maps it's connected to,
+// the destinations of its warps, and the maps connected to its neighbors. At most 'mapPrefetchLimit' maps are
+// prefetched at a time, and any prefetches for a previously-opened map that aren't still wanted are dropped.
+// The map and layout files are read on worker threads, and the tilesets are loaded with the tileset preloader.
+void Project::prefetchMapNeighbors(const Map *map) {
+    QStringList candidates;
+    if (map) {
+        const auto connections = map->getConnections();
+        for (const auto &connection : connections) {
+            candidates.append(connection->targetMapName());
+        }
+        for (const auto &event : map->getEvents(Event::Group::Warp)) {
+            const auto warp = dynamic_cast<const WarpEvent*>(event);
+            if (warp) candidates.append(warp->getDestinationMap());
+        }
+        // The map's neighbors were already loaded to display its connections.
+        for (const auto &connection : connections) {
+            const Map *neighbor = this->maps.value(connection->targetMapName());
+            if (!neighbor || !isLoadedMap(neighbor->name())) continue;
+            for (const auto &neighborConnection : neighbor->getConnections()) {
+                candidates.append(neighborConnection->targetMapName());
+            }
+        }
+    }
+
+    QStringList queue;
+    QStringList tilesetLabels;
+    for (const auto &mapName : candidates) {
+        if (queue.length() >= porymapConfig.mapPrefetchLimit)
+            break;
+        if (queue.contains(mapName) || isLoadedMap(mapName) || this->erroredMaps.contains(mapName))
+            continue;
+        const Map *target = this->maps.value(mapName);
+        if (!target || !target->isPersistedToFile())
+            continue;
+        const Layout *layout = this->mapLayouts.value(target->layoutId());
+        if (!layout)
+            continue;
+        // Without tileset preloading, only maps whose tilesets are already loaded can be prefetched.
+        if (!porymapConfig.preloadTilesets && !isLoadedLayout(layout->id)
+         && (!this->tilesetCache.value(layout->tileset_primary_label) || !this->tilesetCache.value(layout->tileset_secondary_label)))
+            continue;
+        queue.append(mapName);
+        if (!isLoadedLayout(layout->id)) {
+            tilesetLabels.append(layout->tileset_primary_label);
+            tilesetLabels.append(layout->tileset_secondary_label);
+        }
+    }
+    this->mapPrefetchQueue = queue;
+    pruneMapPrefetches();
+
+    for (const auto &mapName : queue) {
+        prefetchMap(mapName);
+    }
+    // Prioritizing moves a tileset to the front of the queue, so go in reverse to preserve the order of the maps.
+    for (auto it = tilesetLabels.crbegin(); it != tilesetLabels.crend(); it++) {
+        prioritizeTilesetPreload(*it);
+    }
+}
+
+void Project::prefetchMap(const QString &mapName) {
+    const Map *map = this->maps.value(mapName);
+    const Layout *layout = map ? this->mapLayouts.value(map->layoutId()) : nullptr;
+    if (!layout)
+        return;
+
+    // Errors are ignored in the background. If the prefetch fails (or logs anything) the files will be read again
+    // when the user opens the map, and any errors will be reported then.
+    if (!this->mapJsonPrefetches.contains(mapName)) {
+        const QString filepath = Map::getJsonFilepath(mapName);
+        const QString root = this->root;
+        auto future = QtConcurrent::run(&this->tilesetPreloadPool, [filepath, root] {
+            MapJsonData data;
+            data.filepath = filepath;
+            data.lastModified = QFileInfo(filepath).lastModified();
+
+            // The project's parser isn't thread-safe, so the worker parses with its own.
+            LogCapture capture;
+            ParseUtil parser;
+            parser.setRoot(root);
+            parser.setUpdatesSplashScreen(false);
+            QJsonDocument doc;
+            if (parser.tryParseJsonFile(&doc, filepath) && capture.numMessages() == 0)
+                data.doc = doc;
+            return data;
+        });
+        this->mapJsonPrefetches.insert(mapName, future);
+        watchMapPrefetch(QFuture<void>(future));
+    }
+
+    if (!isLoadedLayout(layout->id) && !this->layoutFilePrefetches.contains(layout->id)
+     && !layout->blockdata_path.isEmpty() && !layout->border_path.isEmpty()) {
+        const QString blockdataPath = QString("%1/%2").arg(this->root).arg(layout->blockdata_path);
+        const QString borderPath = QString("%1/%2").arg(this->root).arg(layout->border_path);
+        auto future = QtConcurrent::run(&this->tilesetPreloadPool, [blockdataPath, borderPath] {
+            LayoutFileData data;
+            data.blockdataPath = blockdataPath;
+            data.borderPath = borderPath;
+            data.blockdataModified = QFileInfo(blockdataPath).lastModified();
+            data.borderModified = QFileInfo(borderPath).lastModified();
+
+            LogCapture capture;
+            QString blockdataError, borderError;
+            data.blockdata = Layout::readBlockdata(blockdataPath, &blockdataError);
+            data.border = Layout::readBlockdata(borderPath, &borderError);
+            data.isValid = blockdataError.isEmpty() && borderError.isEmpty() && capture.numMessages() == 0;
+            return data;
+        });
+        this->layoutFilePrefetches.insert(layout->id, future);
+        watchMapPrefetch(QFuture<void>(future));
+    }
+}
+
+// A file that was modified after its modification time was recorded may have been read in either state.
+static bool isUnmodifiedSince(const QString &filepath, const QDateTime &lastModified) {
+    return lastModified.isValid() && QFileInfo(filepath).lastModified() == lastModified;
+}
+
+bool Project::MapJsonData::isCurrent() const {
+    return !this->doc.isNull() && isUnmodifiedSince(this->filepath, this->lastModified);
+}
+
+bool Project::LayoutFileData::isCurrent() const {
+    return this->isValid
+        && isUnmodifiedSince(this->blockdataPath, this->blockdataModified)
+        && isUnmodifiedSince(this->borderPath, this->borderModified);
+}
+
+void Project::watchMapPrefetch(const QFuture<void> &future) {
+    auto watcher = new QFutureWatcher<void>(this);
+    connect(watcher, &QFutureWatcher<void>::finished, this, &Project::processMapPrefetches);
+    connect(watcher, &QFutureWatcher<void>::finished, watcher, &QObject::deleteLater);
+    watcher->setFuture(future);
+}
+
+// Finish loading one prefetched map per event loop iteration, once its files have been read and its tilesets are loaded.
+// Maps whose prefetch failed are dropped silently, any errors will be reported if the user opens the map.
+void Project::processMapPrefetches() {
+    for (auto it = this->mapPrefetchQueue.begin(); it != this->mapPrefetchQueue.end();) {
+        const QString mapName = *it;
+        const Map *map = this->maps.value(mapName);
+        const Layout *layout = map ? this->mapLayouts.value(map->layoutId()) : nullptr;
+        if (!layout || isLoadedMap(mapName)) {
+            it = this->mapPrefetchQueue.erase(it);
+            continue;
+        }
+
+        bool pending = false;
+        bool failed = false;
+        auto jsonIt = this->mapJsonPrefetches.constFind(mapName);
+        if (jsonIt == this->mapJsonPrefetches.constEnd()) {
+            failed = true;
+        } else if (!jsonIt.value().isFinished()) {
+            pending = true;
+        } else if (!jsonIt.value().result().isCurrent()) {
+            failed = true;
+        }
+        if (!isLoadedLayout(layout->id)) {
+            auto layoutIt = this->layoutFilePrefetches.constFind(layout->id);
+            if (layoutIt == this->layoutFilePrefetches.constEnd()) {
+                failed = true;
+            } else if (!layoutIt.value().isFinished()) {
+                pending = true;
+            } else if (!layoutIt.value().result().isCurrent()) {
+                failed = true;
+            }
+            for (const auto &label : {layout->tileset_primary_label, layout->tileset_secondary_label}) {
+                if (isTilesetPreloadPending(label)) {
+                    pending = true;
+                } else if (!this->tilesetCache.value(label)) {
+                    failed = true;
+                }
+            }
+        }
+
+        if (failed) {
+            it = this->mapPrefetchQueue.erase(it);
+        } else if (pending) {
+            it++;
+        } else {
+            this->mapPrefetchQueue.erase(it);
+            loadPrefetchedMap(mapName);
+            pruneMapPrefetches();
+            if (!this->mapPrefetchQueue.isEmpty()) {
+                QTimer::singleShot(0, this, &Project::processMapPrefetches);
+            }
+            return;
+        }
+    }
+    pruneMapPrefetches();
+}
+
+// Load a map whose files were prefetched. Unlike loadMap nothing is logged: if loading the map reports any problems
+// it's left unloaded, so that they'll be reported if the user opens the map and it's loaded again normally.
+bool Project::loadPrefetchedMap(const QString &mapName) {
+    Map *map = this->maps.value(mapName);
+    if (!map || isLoadedMap(mapName) || this->erroredMaps.contains(mapName))
+        return false;
+
+    const QString layoutId = map->layoutId();
+    const bool layoutWasLoaded = isLoadedLayout(layoutId);
+    Layout *previousLayout = map->layout();
+
+    LogCapture capture;
+    bool success = loadMapData(map);
+    if (success && map->isPersistedToFile() && !map->hasUnsavedChanges()) {
+        success = loadLayout(layoutId) != nullptr;
+    }
+    if (!success || capture.numMessages() > 0) {
+        // Discard whatever was read before the problem, so the map is read from scratch if the user opens it.
+        map->resetEvents();
+        map->deleteConnections();
+        map->setCustomAttributes(QJsonObject());
+        map->setLayout(previousLayout);
+
+        Layout *layout = this->mapLayouts.value(layoutId);
+        if (layout && !layoutWasLoaded) {
+            layout->unload();
+            this->loadedLayoutIds.remove(layoutId);
+            setLayoutCacheSize(layoutId, 0);
+        }
+        return false;
+    }
+
+    this->loadedMapNames.insert(mapName);
+    emit mapLoaded(map);
+    return true;
+}
+
+// Drop any prefetched file data that isn't needed by a map in the prefetch queue.
+// File reads that are still in progress aren't interrupted, but their results are discarded.
+void Project::pruneMapPrefetches() {
+    QSet<QString> layoutIds;
+    for (const auto &mapName : this->mapPrefetchQueue) {
+        layoutIds.insert(getMapLayoutId(mapName));
+    }
+    for (auto it = this->mapJsonPrefetches.begin(); it != this->mapJsonPrefetches.end();) {
+        if (this->mapPrefetchQueue.contains(it.key())) {
+            it++;
+        } else {
+            it = this->mapJsonPrefetches.erase(it);
+        }
+    }
+    for (auto it = this->layoutFilePrefetches.begin(); it != this->layoutFilePrefetches.end();) {
+        if (layoutIds.contains(it.key())) {
+            it++;
+        } else {
+            it = this->layoutFilePrefetches.erase(it);
+        }
+    }
+}
+
+void Project::cancelMapPrefetches() {
+    this->mapPrefetchQueue.clear();
+    pruneMapPrefetches();
+}
+
+void Project::touchLayout(const Layout *layout) {
+    this->layoutLastUsed.insert(layout->id, ++this->cacheUseCounter);
+    setLayoutCacheSize(layout->id, layout->memoryUsage());
+    touchTileset(layout->tileset_primary_label);
+    touchTileset(layout->tileset_secondary_label);
+}
+
+void Project::touchTileset(const QString &label) {
+    this->tilesetLastUsed.insert(label, ++this->cacheUseCounter);
+}
+
+// The cache's memory usage is kept as a running total of the size of each entry. Sizes are measured when an entry
+// is cached or used, rather than measuring every entry each time the total is needed.
+void Project::setLayoutCacheSize(const QString &layoutId, qint64 size) {
+    this->layoutCacheSize += size - this->layoutCacheSizes.value(layoutId);
+    if (size > 0) {
+        this->layoutCacheSizes.insert(layoutId, size);
+    } else {
+        this->layoutCacheSizes.remove(layoutId);
+    }
+}
+
+void Project::setTilesetCacheSize(const QString &label, qint64 size) {
+    this->tilesetCacheSize += size - this->tilesetCacheSizes.value(label);
+    if (size > 0) {
+        this->tilesetCacheSizes.insert(label, size);
+    } else {
+        this->tilesetCacheSizes.remove(label);
+    }
+}
+
+// Measure the displayed layouts and their tilesets again, since they're the ones that are being edited.
+void Project::updateDisplayedCacheSizes() {
+    for (const auto &layoutId : this->displayedLayoutIds) {
+        const Layout *layout = this->mapLayouts.value(layoutId);
+        if (!layout || !isLoadedLayout(layoutId))
+            continue;
+        setLayoutCacheSize(layoutId, layout->memoryUsage());
+        for (const auto &label : {layout->tileset_primary_label, layout->tileset_secondary_label}) {
+            const Tileset *tileset = this->tilesetCache.value(label);
+            if (tileset) setTilesetCacheSize(label, tileset->memoryUsage());
+        }
+    }
+}
+
+// Layouts on screen (the current layout and the layouts of the current map's connections) are never unloaded.
+void Project::setDisplayedLayouts(const QSet<QString> &layoutIds) {
+    this->displayedLayoutIds = layoutIds;
+}
+
+// While eviction is blocked no layouts or tilesets will be unloaded, e.g. while a window is holding onto layouts it isn't displaying.
+void Project::blockCacheEviction() {
+    this->cacheEvictionBlockers++;
+}
+
+void Project::unblockCacheEviction() {
+    if (this->cacheEvictionBlockers > 0 && --this->cacheEvictionBlockers == 0) {
+        scheduleCacheEviction();
+    }
+}
+
+qint64 Project::getLayoutCacheSize() const {
+    return this->layoutCacheSize;
+}
+
+qint64 Project::getTilesetCacheSize() const {
+    return this->tilesetCacheSize;
+}
+
+// A breakdown of the memory retained by the project's loaded data and caches, for diagnosing memory use.
+MemoryUsage Project::getMemoryUsage() const {
+    MemoryUsage usage(this->root);
+
+    // Layouts keep their edit history after they're unloaded, so unloaded layouts with history are included too.
+    MemoryUsage &layouts = usage.add("Layouts", 0, 0);
+    for (auto it = this->mapLayouts.constBegin(); it != this->mapLayouts.constEnd(); it++) {
+        const Layout *layout = it.value();
+        if (!layout || (!this->loadedLayoutIds.contains(it.key()) && layout->editHistory.count() == 0))
+            continue;
+        MemoryUsage &entry = layouts.add(layout->memoryBreakdown());
+        entry.add("Edit history", editHistoryMemoryUsage(&layout->editHistory), layout->editHistory.count());
+        layouts.count++;
+    }
+
+    MemoryUsage &tilesets = usage.add("Tilesets", 0, 0);
+    for (const auto &tileset : this->tilesetCache) {
+        if (!tileset) continue;
+        tilesets.add(tileset->memoryBreakdown());
+        tilesets.count++;
+    }
+
+    MemoryUsage &maps = usage.add("Maps", 0, 0);
+    for (const auto &mapName : this->loadedMapNames) {
+        const Map *map = this->maps.value(mapName);
+        if (!map) continue;
+        maps.add(map->memoryBreakdown());
+        maps.count++;
+    }
+
+    MemoryUsage &caches = usage.add("Caches");
+    caches.add("Event pixmaps", static_cast<qint64>(this->eventPixmapCache.totalCost()), this->eventPixmapCache.count());
+    caches.add("Species icons", static_cast<qint64>(this->speciesIconCache.totalCost()), this->speciesIconCache.count());
+    caches.add("Script images", Scripting::getImageCacheSize(), Scripting::numCachedImages());
+    caches.add("Overlay tiles", Scripting::getOverlayCacheSize(), Scripting::numOverlayCachedTiles());
+    caches.add("Collision atlas", Util::memoryUsage(Editor::collisionAtlas));
+
+    qint64 modelsSize = 0;
+    for (const auto &model : this->stringListModels) {
+        for (const auto &string : model->stringList()) {
+            modelsSize += string.size() * static_cast<qint64>(sizeof(QChar));
+        }
+    }
+    caches.add("Dropdown lists", modelsSize, this->stringListModels.size());
+
+    // Qt doesn't report how much of the QPixmapCache is in use, only its limit.
+    MemoryUsage &pixmapCache = caches.add("QPixmapCache", 0);
+    pixmapCache.note = QString("Usage is not reported, limit is %1 KiB").arg(QPixmapCache::cacheLimit());
+
+    usage.sortBySize();
+    return usage;
+}
+
+int Project::numLoadedTilesets() const {
+    int count = 0;
+    for (const auto &tileset : this->tilesetCache) {
+        if (tileset) count++;
+    }
+    return count;
+}
+
+// Layouts can only be unloaded if they can be reloaded from their files without losing anything.
+bool Project::canUnloadLayout(const Layout *layout) const {
+    return !this->displayedLayoutIds.contains(layout->id)
+        && !layout->hasUnsavedChanges()
+        && layout->editHistory.count() == 0;
+}
+
+bool Project::isOverCacheMemoryLimit() const {
+    const qint64 limit = static_cast<qint64>(porymapConfig.cacheMemoryLimit) * 1024 * 1024;
+    return limit > 0 && (getLayoutCacheSize() + getTilesetCacheSize()) > limit;
+}
+
+// Layouts and tilesets are usually loaded in bursts (e.g. a map and all its connections), so rather than
+// checking the memory limit after each one we check once the event loop regains control.
+void Project::scheduleCacheEviction() {
+    if (this->cacheEvictionScheduled)
+        return;
+    this->cacheEvictionScheduled = true;
+    QTimer::singleShot(0, this, &Project::enforceCacheMemoryLimit);
+}
+
+// If the loaded layouts and tilesets exceed the cache memory limit, unload the least recently used
+// layouts that aren't displayed or modified, then the least recently used tilesets that no loaded layout is using.
+// Anything that's unloaded will be loaded again the next time it's requested.
+void Project::enforceCacheMemoryLimit() {
+    this->cacheEvictionScheduled = false;
+    updateDisplayedCacheSizes();
+
+    const qint64 limit = static_cast<qint64>(porymapConfig.cacheMemoryLimit) * 1024 * 1024;
+    auto usage = [this] { return getLayoutCacheSize() + getTilesetCacheSize(); };
+    if (limit <= 0 || usage() <= limit || this->cacheEvictionBlockers > 0) {
+        emit cacheSizeChanged();
+        return;
+    }
+
+    QList<Layout*> layouts;
+    for (const auto &layoutId : this->loadedLayoutIds) {
+        Layout *layout = this->mapLayouts.value(layoutId);
+        if (layout && canUnloadLayout(layout)) {
+            layouts.append(layout);
+        }
+    }
+    std::sort(layouts.begin(), layouts.end(), [this](const Layout *a, const Layout *b) {
+        return this->layoutLastUsed.value(a->id) < this->layoutLastUsed.value(b->id);
+    });
+    int numUnloadedLayouts = 0;
+    for (const auto &layout : layouts) {
+        if (usage() <= limit) break;
+        layout->unload();
+        this->loadedLayoutIds.remove(layout->id);
+        setLayoutCacheSize(layout->id, 0);
+        numUnloadedLayouts++;
+        emit layoutUnloaded(layout->id);
+    }
+
+    QSet<const Tileset*> usedTilesets;
+    for (const auto &layoutId : this->loadedLayoutIds) {
+        const Layout *layout = this->mapLayouts.value(layoutId);
+        if (!layout) continue;
+        usedTilesets.insert(layout->tileset_primary);
+        usedTilesets.insert(layout->tileset_secondary);
+    }
+    QStringList tilesetLabels;
+    for (auto it = this->tilesetCache.constBegin(); it != this->tilesetCache.constEnd(); it++) {
+        const Tileset *tileset = it.value();
+        if (tileset && !usedTilesets.contains(tileset) && !tileset->hasUnsavedTilesImage()) {
+            tilesetLabels.append(it.key());
+        }
+    }
+    std::sort(tilesetLabels.begin(), tilesetLabels.end(), [this](const QString &a, const QString &b) {
+        return this->tilesetLastUsed.value(a) < this->tilesetLastUsed.value(b);
+    });
+    int numUnloadedTilesets = 0;
+    for (const auto &label : tilesetLabels) {
+        if (usage() <= limit) break;
+        delete this->tilesetCache.take(label);
+        setTilesetCacheSize(label, 0);
+        numUnloadedTilesets++;
+    }
+
+    if (numUnloadedLayouts > 0 || numUnloadedTilesets > 0) {
+        logInfo(QString("Unloaded %1 layout(s) and %2 tileset(s) to stay within the cache memory limit.")
+                    .arg(numUnloadedLayouts)
+                    .arg(numUnloadedTilesets));
+    }
+    emit cacheSizeChanged();
+}
+
 void Project::setNewLayoutBlockdata(Layout *layout) {
     layout->blockdata.clear();
     int width = layout->getWidth();
@@ -1285,6 +2027,7 @@ void Project::setNewLayoutBlockdata(Layout *layout) {
     for (int i = 0; i < width * height; i++) {
         layout->blockdata.append(block);
     }
+    layout->invalidateBlockIndex();
     layout->lastCommitBlocks.blocks = layout->blockdata;
     layout->lastCommitBlocks.layoutDimensions = QSize(width, height);
 }
@@ -1495,7 +2238,7 @@ bool Project::saveConfig() {
 bool Project::loadTilesetAssets(Tileset* tileset) {
     readTilesetPaths(tileset);
     loadTilesetMetatileLabels(tileset);
-    return tileset->load();
+    return tileset->load(QThreadPool::globalInstance());
 }
 
 void Project::readTilesetPaths(Tileset* tileset) {
@@ -1649,6 +2392,7 @@ Tileset *Project::createNewTileset(QString name, bool secondary, bool checkerboa
     ignoreWatchedFilesTemporarily({headersFilepath, graphicsFilepath, metatilesFilepath});
     QString baseName = Tileset::stripPrefix(name);
     tileset->appendToHeaders(headersFilepath, baseName, this->usingAsmTilesets);
+    this->tilesetHeadersRead = false;
     tileset->appendToGraphics(graphicsFilepath, baseName, this->usingAsmTilesets);
     tileset->appendToMetatiles(metatilesFilepath, baseName, this->usingAsmTilesets);
 
@@ -2039,6 +2783,7 @@ bool Project::readMapGroups() {
     this->mapConstantsToMapNames.insert(dynamicMapConstant, dynamicMapName);
     this->alphabeticalMapNames.append(dynamicMapName);
     Util::numericalModeSort(this->alphabeticalMapNames);
+    updateStringListModel("mapNames", this->alphabeticalMapNames);
 
     // Chuck the "connections_include_order" field, this is only for matching.
     if (!projectConfig.preserveMatchingOnlyData) {
@@ -2282,6 +3027,8 @@ bool Project::readTilesetLabels() {
     this->primaryTilesetLabels.clear();
     this->secondaryTilesetLabels.clear();
     this->tilesetLabelsOrdered.clear();
+    this->tilesetHeaders.clear();
+    this->tilesetHeadersRead = false;
     clearTilesetCache();
 
     QString filename = projectConfig.getFilePath(ProjectFilePath::tilesets_headers);
@@ -2307,7 +3054,9 @@ bool Project::readTilesetLabels() {
         const auto structs = parser.readCStructs(filename, "", Tileset::getHeaderMemberMap(this->usingAsmTilesets));
         for (auto i = structs.cbegin(); i != structs.cend(); i++){
             appendTilesetLabel(i.key(), i.value().value("isSecondary"));
+            this->tilesetHeaders.insert(i.key(), i.value());
         }
+        this->tilesetHeadersRead = true;
     }
 
     Util::numericalModeSort(this->primaryTilesetLabels);
@@ -2769,6 +3518,7 @@ bool Project::readItemNames() {
     this->itemNames = parser.readCDefineNames(filename, {projectConfig.getIdentifier(ProjectIdentifier::regex_items)}, &error);
     if (!error.isEmpty())
         logWarn(QString("Failed to read item constants from '%1': %2").arg(filename).arg(error));
+    updateStringListModel("itemNames", this->itemNames);
     return true;
 }
 
@@ -2779,6 +3529,7 @@ bool Project::readFlagNames() {
     this->flagNames = parser.readCDefineNames(filename, {projectConfig.getIdentifier(ProjectIdentifier::regex_flags)}, &error);
     if (!error.isEmpty())
         logWarn(QString("Failed to read flag constants from '%1': %2").arg(filename).arg(error));
+    updateStringListModel("flagNames", this->flagNames);
     return true;
 }
 
@@ -2789,6 +3540,7 @@ bool Project::readVarNames() {
     this->varNames = parser.readCDefineNames(filename, {projectConfig.getIdentifier(ProjectIdentifier::regex_vars)}, &error);
     if (!error.isEmpty())
         logWarn(QString("Failed to read var constants from '%1': %2").arg(filename).arg(error));
+    updateStringListModel("varNames", this->varNames);
     return true;
 }
 
@@ -2799,6 +3551,7 @@ bool Project::readMovementTypes() {
     this->movementTypes = parser.readCDefineNames(filename, {projectConfig.getIdentifier(ProjectIdentifier::regex_movement_types)}, &error);
     if (!error.isEmpty())
         logWarn(QString("Failed to read movement type constants from '%1': %2").arg(filename).arg(error));
+    updateStringListModel("movementTypes", this->movementTypes);
     return true;
 }
 
@@ -2852,6 +3605,7 @@ bool Project::readCoordEventWeatherNames() {
     this->coordEventWeatherNames = parser.readCDefineNames(filename, {projectConfig.getIdentifier(ProjectIdentifier::regex_coord_event_weather)}, &error);
     if (!error.isEmpty())
         logWarn(QString("Failed to read coord event weather constants from '%1': %2").arg(filename).arg(error));
+    updateStringListModel("coordEventWeatherNames", this->coordEventWeatherNames);
     return true;
 }
 
@@ -2865,6 +3619,7 @@ bool Project::readSecretBaseIds() {
     this->secretBaseIds = parser.readCDefineNames(filename, {projectConfig.getIdentifier(ProjectIdentifier::regex_secret_bases)}, &error);
     if (!error.isEmpty())
         logWarn(QString("Failed to read secret base id constants from '%1': %2").arg(filename).arg(error));
+    updateStringListModel("secretBaseIds", this->secretBaseIds);
     return true;
 }
 
@@ -2875,6 +3630,7 @@ bool Project::readBgEventFacingDirections() {
     this->bgEventFacingDirections = parser.readCDefineNames(filename, {projectConfig.getIdentifier(ProjectIdentifier::regex_sign_facing_directions)}, &error);
     if (!error.isEmpty())
         logWarn(QString("Failed to read bg event facing direction constants from '%1': %2").arg(filename).arg(error));
+    updateStringListModel("bgEventFacingDirections", this->bgEventFacingDirections);
     return true;
 }
 
@@ -2885,6 +3641,7 @@ bool Project::readTrainerTypes() {
     this->trainerTypes = parser.readCDefineNames(filename, {projectConfig.getIdentifier(ProjectIdentifier::regex_trainer_types)}, &error);
     if (!error.isEmpty())
         logWarn(QString("Failed to read trainer type constants from '%1': %2").arg(filename).arg(error));
+    updateStringListModel("trainerTypes", this->trainerTypes);
     return true;
 }
 
@@ -2939,6 +3696,7 @@ bool Project::readObjEventGfxConstants() {
     this->gfxDefines.clear();
     for (auto it = defines.constBegin(); it != defines.constEnd(); it++)
         this->gfxDefines.insert(it.key(), it.value());
+    updateStringListModel("gfxDefines", this->gfxDefines.keys());
 
     return true;
 }
@@ -3082,8 +3840,104 @@ void Project::loadEventPixmap(Event *event, bool forceLoad) {
 }
 
 void Project::clearEventGraphics() {
+    for (const auto &gfx : this->eventGraphicsMap) {
+        if (gfx->loader) {
+            // The decode can't be interrupted, but we don't need to wait for it to finish.
+            gfx->loader->disconnect(this);
+            gfx->loader->deleteLater();
+        }
+    }
     qDeleteAll(this->eventGraphicsMap);
     this->eventGraphicsMap.clear();
+    this->eventPixmapCache.clear();
+}
+
+// Decode an event's spritesheet and cut it into frames. Returns an empty list if the image couldn't be read.
+// This only reads the image file, so it's safe to call from a worker thread.
+static QList<QImage> readEventSpriteFrames(const QString &filepath, int spriteWidth, int spriteHeight, bool inanimate) {
+    const QImage spritesheet(filepath);
+    if (spritesheet.width() == 0 || spritesheet.height() == 0)
+        return {};
+
+    // If we were unable to find the dimensions of a frame within the spritesheet we'll use the full image dimensions.
+    if (spriteWidth <= 0) spriteWidth = spritesheet.width();
+    if (spriteHeight <= 0) spriteHeight = spritesheet.height();
+
+    // Inanimate events will only ever use the first frame of their spritesheet.
+    const int numFrames = inanimate ? 1 : qMax(1, (spritesheet.width() / spriteWidth) * (spritesheet.height() / spriteHeight));
+
+    QList<QImage> frames;
+    for (int frame = 0; frame < numFrames; frame++) {
+        int x = frame * spriteWidth;
+        int y = ((frame * spriteWidth) / spritesheet.width()) * spriteHeight;
+        QImage img = spritesheet.copy(x % spritesheet.width(),
+                                      y % spritesheet.height(),
+                                      spriteWidth,
+                                      spriteHeight);
+        // Set first palette color fully transparent.
+        img.setColor(0, qRgba(0, 0, 0, 0));
+        frames.append(img);
+    }
+    return frames;
+}
+
+// Begin decoding an event's spritesheet in the background. Until it's finished, events using it will display their default sprite.
+void Project::startEventGraphicsLoad(EventGraphics *gfx) {
+    if (gfx->loaded || gfx->loader)
+        return;
+
+    if (gfx->filepath.isEmpty()) {
+        gfx->loaded = true;
+        return;
+    }
+
+    const QString filepath = QString("%1/%2").arg(this->root).arg(gfx->filepath);
+    const int spriteWidth = gfx->spriteWidth;
+    const int spriteHeight = gfx->spriteHeight;
+    const bool inanimate = gfx->inanimate;
+
+    gfx->loader = new QFutureWatcher<QList<QImage>>(this);
+    connect(gfx->loader, &QFutureWatcher<QList<QImage>>::finished, this, [this, gfx] {
+        finishEventGraphicsLoad(gfx);
+        emit eventGraphicsLoaded({gfx->name});
+    });
+    gfx->loader->setFuture(QtConcurrent::run(&this->eventGraphicsPool, [filepath, spriteWidth, spriteHeight, inanimate] {
+        return readEventSpriteFrames(filepath, spriteWidth, spriteHeight, inanimate);
+    }));
+}
+
+void Project::finishEventGraphicsLoad(EventGraphics *gfx) {
+    if (!gfx->loader)
+        return;
+
+    auto loader = gfx->loader;
+    gfx->loader = nullptr;
+    loader->disconnect(this);
+    loader->waitForFinished();
+    gfx->frames = loader->result();
+    loader->deleteLater();
+
+    // Set this whether we were successful or not, we only need to try to load it once.
+    gfx->loaded = true;
+    if (gfx->frames.isEmpty()) {
+        logWarn(QString("Failed to open '%1' for event's sprite. Event will use a default sprite instead.").arg(gfx->filepath));
+    }
+}
+
+// Wait for any event sprites that are being decoded in the background, e.g. before exporting an image of a map.
+// Returns true if any sprites finished loading, in which case events displaying a default sprite should be reloaded.
+bool Project::finishEventGraphicsLoads() {
+    QStringList finished;
+    for (const auto &gfx : this->eventGraphicsMap) {
+        if (gfx->loader) {
+            finishEventGraphicsLoad(gfx);
+            finished.append(gfx->name);
+        }
+    }
+    if (finished.isEmpty())
+        return false;
+    emit eventGraphicsLoaded(finished);
+    return true;
 }
 
 bool Project::readEventGraphics() {
@@ -3127,6 +3981,7 @@ bool Project::readEventGraphics() {
         const QHash<QString, QString> gfxInfoAttributes = gfxInfos[info_label];
 
         auto gfx = new EventGraphics;
+        gfx->name = gfxName;
 
         // We need the .png filepath for the event's sprite. This is buried behind a few levels of indirection.
         // The 'images' field gives us the name of the table containing the sprite's image data.
@@ -3138,9 +3993,9 @@ bool Project::readEventGraphics() {
         gfx_label = gfx_label.section(re_parens, 1, 1);
         gfx->filepath = fixGraphicPath(graphicIncbins[gfx_label]);
 
-        // Note: gfx has a 'spritesheet' field that will contain a QImage for the event's sprite.
-        //       We don't create this QImage yet. Reading the image now is unnecessary overhead for startup.
-        //       We'll read the image file when the event's sprite is first requested to be drawn.
+        // Note: gfx has a 'frames' field that will contain the QImages for the event's sprite.
+        //       We don't create these yet. Reading the image now is unnecessary overhead for startup.
+        //       We'll decode the image file in the background when the event's sprite is first requested to be drawn.
 
         // The .png file is expected to be a spritesheet that can have multiple frames.
         // We only want to show one frame at a time, so we need to know the dimensions of each frame.
@@ -3193,76 +4048,56 @@ QPixmap Project::getEventPixmap(const QString &gfxName, const QString &movementN
 }
 
 QPixmap Project::getEventPixmap(const QString &gfxName, int frame, bool hFlip) {
-    QPixmap pixmap;
-    const QString cacheKey = QString("EVENT#%1#%2#%3").arg(gfxName).arg(frame).arg(hFlip ? "1" : "0");
-    if (QPixmapCache::find(cacheKey, &pixmap)) {
-        return pixmap;
+    const QString cacheKey = QString("%1#%2#%3").arg(gfxName).arg(frame).arg(hFlip ? "1" : "0");
+    const QPixmap *cachedPixmap = this->eventPixmapCache.object(cacheKey);
+    if (cachedPixmap) {
+        return *cachedPixmap;
     }
 
-    EventGraphics* gfx = this->eventGraphicsMap.value(gfxName, nullptr);
-    if (!gfx) {
-        // Invalid gfx constant. If this is a number, try to use that instead.
-        bool ok;
-        int gfxNum = ParseUtil::gameStringToInt(gfxName, &ok);
-        if (ok) gfx = this->eventGraphicsMap.value(this->gfxDefines.key(gfxNum, "NULL"), nullptr);
-    }
+    EventGraphics* gfx = this->eventGraphicsMap.value(getEventGraphicsName(gfxName), nullptr);
     if (gfx && !gfx->loaded) {
-        // This is the first request for this event's sprite. We'll attempt to load it now.
-        if (!gfx->filepath.isEmpty()) {
-            gfx->spritesheet = QImage(QString("%1/%2").arg(this->root).arg(gfx->filepath));
-            if (gfx->spritesheet.isNull()) {
-                logWarn(QString("Failed to open '%1' for event's sprite. Event will use a default sprite instead.").arg(gfx->filepath));
-            } else {
-                // If we were unable to find the dimensions of a frame within the spritesheet we'll use the full image dimensions.
-                if (gfx->spriteWidth <= 0) {
-                    gfx->spriteWidth = gfx->spritesheet.width();
-                }
-                if (gfx->spriteHeight <= 0) {
-                    gfx->spriteHeight = gfx->spritesheet.height();
-                }
-            }
-        }
-        // Set this whether we were successful or not, we only need to try to load it once.
-        gfx->loaded = true;
+        // This is the first request for this event's sprite. It will be decoded in the background,
+        // and the caller will display a default sprite until we emit 'eventGraphicsLoaded'.
+        startEventGraphicsLoad(gfx);
     }
-    if (!gfx || gfx->spritesheet.width() == 0 || gfx->spritesheet.height() == 0) {
-        // Either we didn't recognize the gfxName, or we were unable to load the sprite's image.
+    if (!gfx || !gfx->loaded || gfx->frames.isEmpty()) {
+        // Either we didn't recognize the gfxName, the sprite's image isn't loaded yet, or we were unable to load it.
         return QPixmap();
     }
 
-    QImage img;
-    if (gfx->inanimate) {
-        img = gfx->spritesheet.copy(0, 0, gfx->spriteWidth, gfx->spriteHeight);
-    } else {
-        int x = frame * gfx->spriteWidth;
-        int y = ((frame * gfx->spriteWidth) / gfx->spritesheet.width()) * gfx->spriteHeight;
-
-        img = gfx->spritesheet.copy(x % gfx->spritesheet.width(),
-                                    y % gfx->spritesheet.height(),
-                                    gfx->spriteWidth,
-                                    gfx->spriteHeight);
-        if (hFlip) {
-            img = img.transformed(QTransform().scale(-1, 1));
-        }
+    QImage img = gfx->frames.at(qMax(0, frame) % gfx->frames.length());
+    if (!gfx->inanimate && hFlip) {
+        img = img.transformed(QTransform().scale(-1, 1));
     }
-    // Set first palette color fully transparent.
-    img.setColor(0, qRgba(0, 0, 0, 0));
 
-    pixmap = QPixmap::fromImage(img);
-    QPixmapCache::insert(cacheKey, pixmap);
+    const QPixmap pixmap = QPixmap::fromImage(img);
+    this->eventPixmapCache.insert(cacheKey, new QPixmap(pixmap), Util::memoryUsage(pixmap));
     return pixmap;
 }
 
+// Returns the name of the graphics used by an object event with the given gfx value.
+QString Project::getEventGraphicsName(const QString &gfxName) const {
+    if (this->eventGraphicsMap.contains(gfxName))
+        return gfxName;
+
+    // Invalid gfx constant. If this is a number, try to use that instead.
+    bool ok;
+    int gfxNum = ParseUtil::gameStringToInt(gfxName, &ok);
+    return ok ? this->gfxDefines.key(gfxNum, "NULL") : QString();
+}
+
 QPixmap Project::getEventPixmap(Event::Group group) {
     if (group == Event::Group::None)
         return QPixmap();
 
-    QPixmap pixmap;
-    const QString cacheKey = QString("EVENT#%1").arg(Event::groupToString(group));
-    if (QPixmapCache::find(cacheKey, &pixmap)) {
-        return pixmap;
+    const QString cacheKey = Event::groupToString(group);
+    const QPixmap *cachedPixmap = this->eventPixmapCache.object(cacheKey);
+    if (cachedPixmap) {
+        return *cachedPixmap;
     }
 
+    QPixmap pixmap;
+
     const int defaultWidth = 16;
     const int defaultHeight = 16;
     static const QPixmap defaultIcons = QPixmap(":/images/Entities_16x16.png");
@@ -3283,11 +4118,12 @@ QPixmap Project::getEventPixmap(Event::Group group) {
             logWarn(QString("Failed to load custom event icon '%1', using default icon.").arg(customIconPath));
         }
     }
-    QPixmapCache::insert(cacheKey, pixmap);
+    this->eventPixmapCache.insert(cacheKey, new QPixmap(pixmap), Util::memoryUsage(pixmap));
     return pixmap;
 }
 
 bool Project::readSpeciesIconPaths() {
+    clearSpeciesIcons();
     this->speciesToIconPath.clear();
     this->speciesNames.clear();
 
@@ -3307,6 +4143,11 @@ bool Project::readSpeciesIconPaths() {
     }
     this->speciesNames.sort();
 
+    // Size the icon cache so that it can hold a 32x32 icon for every species (plus some headroom for the placeholder and
+    // for species added later), rather than evicting icons that are still in use in a project with many species.
+    static const int iconSize = 32 * 32 * 4;
+    this->speciesIconCache.setMaxCost(qMax(1024, this->speciesNames.length() + 64) * iconSize);
+
     // If we successfully found the species icon table we can use this data to get the filepath for each species icon.
     // For any species not in the table, or if we failed to find the table at all, we will have to predict where the icon file is.
     // That can require checking a lot of files (especially for projects with many species), so to save time on startup we only
@@ -3355,21 +4196,26 @@ QString Project::getDefaultSpeciesIconPath(const QString &species) {
     }
 
     // Ex: For 'SPECIES_FOO_BAR_BAZ' search for files by permuting through directories using 'foo_bar_baz'.
+    // If this fails the species will use a placeholder icon, which getSpeciesIcon warns about when it's displayed.
     const QString speciesPrefix = projectConfig.getIdentifier(ProjectIdentifier::define_species_prefix);
     const QString path = findSpeciesIconPath({species.mid(speciesPrefix.length()).toLower()});
     this->speciesToIconPath.insert(species, path);
-
-    // We failed to find a default icon path, this species will use a placeholder icon.
-    // If the user has no custom icon path for this species, tell them they can provide one.
-    if (path.isEmpty() && projectConfig.getPokemonIconPath(species).isEmpty()) {
-        logWarn(QString("Failed to find Pokémon icon for '%1'. The filepath can be specified under 'Options->Project Settings'").arg(species));
-    }
     return path;
 }
 
+QString Project::getSpeciesIconBasePath() const {
+    return QString("%1/%2").arg(this->root).arg(projectConfig.getFilePath(ProjectFilePath::pokemon_gfx));
+}
+
+QString Project::findSpeciesIconPath(const QStringList &names) {
+    indexSpeciesIconDirs();
+    return findSpeciesIconPath(names, getSpeciesIconBasePath(), this->speciesIconDirs);
+}
+
 // The name permuting in here is overkill, but it's making up for some of the fragility in the way we find pokémon icon paths.
 // For pokeemerald-expansion in particular this function is solely responsible for finding pokémon icons, because they have no icon table.
-QString Project::findSpeciesIconPath(const QStringList &names) const {
+// This doesn't use the project, so it's safe to call from a worker thread.
+QString Project::findSpeciesIconPath(const QStringList &names, const QString &basePath, const QHash<QString, QString> &iconDirs) {
     QStringList possibleDirNames = names;
 
     // Permute paths with underscores.
@@ -3387,38 +4233,164 @@ QString Project::findSpeciesIconPath(const QStringList &names) const {
     possibleDirNames.append(permutedNames);
     possibleDirNames.removeDuplicates();
 
-    const QString basePath = QString("%1/%2").arg(this->root).arg(projectConfig.getFilePath(ProjectFilePath::pokemon_gfx));
+    // Candidates are checked against an index of the icon directories, rather than checking if each file exists.
     for (const auto &dir : possibleDirNames) {
-        if (dir.isEmpty()) continue;
-
-        const QString path = QString("%1%2/icon.png").arg(basePath).arg(dir);
-        if (QFile::exists(path))
-            return path;
+        auto it = iconDirs.constFind(dir.toLower());
+        if (dir.isEmpty() || it == iconDirs.constEnd()) continue;
+        return QString("%1%2/icon.png").arg(basePath).arg(it.value());
     }
     return QString();
 }
 
+// Find every directory under the Pokémon graphics folder that has an icon file. The keys are lowercase.
+// This only reads the file system, so it's safe to call from a worker thread.
+QHash<QString, QString> Project::readSpeciesIconDirs(const QString &basePath) {
+    QHash<QString, QString> iconDirs;
+    const QDir baseDir(basePath);
+    QDirIterator it(baseDir.path(), {"icon.png"}, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        const QString dir = baseDir.relativeFilePath(it.fileInfo().path());
+        iconDirs.insert(dir.toLower(), dir);
+    }
+    return iconDirs;
+}
+
+// Record every directory under the Pokémon graphics folder that has an icon file. This is only done once,
+// rather than checking for the icon files of each species (of which there may be several thousand candidates).
+void Project::indexSpeciesIconDirs() {
+    if (this->speciesIconDirsIndexed)
+        return;
+    this->speciesIconDirsIndexed = true;
+    this->speciesIconDirs = readSpeciesIconDirs(getSpeciesIconBasePath());
+}
+
+void Project::clearSpeciesIcons() {
+    if (this->speciesIconLoader) {
+        // The decode can't be interrupted, but we don't need to wait for it to finish.
+        this->speciesIconLoader->disconnect(this);
+        this->speciesIconLoader->deleteLater();
+        this->speciesIconLoader = nullptr;
+    }
+    this->speciesIconsPreloaded = false;
+    this->speciesIconCache.clear();
+    this->missingSpeciesIcons.clear();
+    this->speciesIconDirs.clear();
+    this->speciesIconDirsIndexed = false;
+}
+
+QString Project::getSpeciesIconFilepath(const QString &species) {
+    // Prefer path from config. If not present, use the path parsed from project files
+    QString path = Project::getExistingFilepath(projectConfig.getPokemonIconPath(species));
+    if (path.isEmpty()) {
+        path = getDefaultSpeciesIconPath(species);
+    }
+    return path;
+}
+
+// Read a species icon, keeping only its first frame. This only reads the image file, so it's safe to call from a worker thread.
+static QImage readSpeciesIconImage(const QString &filepath) {
+    QImage img(filepath);
+    if (img.isNull())
+        return img;
+    img.setColor(0, qRgba(0, 0, 0, 0));
+    return img.copy(0, 0, 32, 32);
+}
+
+static QPixmap speciesIconFromImage(const QImage &img) {
+    if (img.isNull()) {
+        // No icon for this species, use placeholder
+        static const QPixmap placeholder = QPixmap(QStringLiteral(":images/pokemon_icon_placeholder.png"));
+        return placeholder;
+    }
+    return QPixmap::fromImage(img);
+}
+
+// Cache the icon for a species. Species without an icon are cached with the placeholder, so we don't look for their icon again.
+void Project::recordSpeciesIcon(const QString &species, const QImage &image) {
+    const QPixmap pixmap = speciesIconFromImage(image);
+    this->speciesIconCache.insert(species, new QPixmap(pixmap), Util::memoryUsage(pixmap));
+    if (image.isNull())
+        this->missingSpeciesIcons.insert(species);
+}
+
 QPixmap Project::getSpeciesIcon(const QString &species) {
-    QPixmap pixmap;
-    if (!QPixmapCache::find(species, &pixmap)) {
-        // Prefer path from config. If not present, use the path parsed from project files
-        QString path = Project::getExistingFilepath(projectConfig.getPokemonIconPath(species));
-        if (path.isEmpty()) {
-            path = getDefaultSpeciesIconPath(species);
-        }
-
-        QImage img(path);
-        if (img.isNull()) {
-            // No icon for this species, use placeholder
-            static const QPixmap placeholder = QPixmap(QStringLiteral(":images/pokemon_icon_placeholder.png"));
-            pixmap = placeholder;
-        } else {
-            img.setColor(0, qRgba(0, 0, 0, 0));
-            pixmap = QPixmap::fromImage(img).copy(0, 0, 32, 32);
-            QPixmapCache::insert(species, pixmap);
+    // If this species is still waiting to be decoded by preloadSpeciesIcons, the background result will be discarded.
+    if (!this->speciesIconCache.contains(species))
+        recordSpeciesIcon(species, readSpeciesIconImage(getSpeciesIconFilepath(species)));
+
+    // Warn about a missing icon the first time it's displayed. If the user has no custom icon path for this species, tell them they can provide one.
+    if (this->missingSpeciesIcons.remove(species) && projectConfig.getPokemonIconPath(species).isEmpty()) {
+        logWarn(QString("Failed to find Pokémon icon for '%1'. The filepath can be specified under 'Options->Project Settings'").arg(species));
+    }
+
+    const QPixmap *cached = this->speciesIconCache.object(species);
+    return cached ? *cached : speciesIconFromImage(QImage());
+}
+
+// Decode the icons for every species in the background, so that the encounter tables
+// and species dropdowns don't need to read any files while they're being painted.
+void Project::preloadSpeciesIcons() {
+    if (this->speciesIconsPreloaded)
+        return;
+    this->speciesIconsPreloaded = true;
+
+    // Only the paths that are already known are filled in here. Searching for the rest (e.g. every species in
+    // pokeemerald-expansion, which has no icon table) is left to the worker thread.
+    QList<SpeciesIconLoad> loads;
+    for (const auto &species : this->speciesNames) {
+        if (this->speciesIconCache.contains(species))
+            continue;
+        SpeciesIconLoad load;
+        load.species = species;
+        const QString customPath = projectConfig.getPokemonIconPath(species);
+        if (!customPath.isEmpty()) {
+            load.filepath = Project::getExistingFilepath(customPath);
         }
+        if (load.filepath.isEmpty()) {
+            auto it = this->speciesToIconPath.constFind(species);
+            if (it != this->speciesToIconPath.constEnd()) {
+                load.filepath = it.value();
+            } else {
+                load.findDefaultPath = true;
+            }
+        }
+        loads.append(load);
     }
-    return pixmap;
+    if (loads.isEmpty())
+        return;
+
+    this->speciesIconLoader = new QFutureWatcher<QList<SpeciesIconLoad>>(this);
+    connect(this->speciesIconLoader, &QFutureWatcher<QList<SpeciesIconLoad>>::finished, this, [this] {
+        auto loader = this->speciesIconLoader;
+        this->speciesIconLoader = nullptr;
+        const QList<SpeciesIconLoad> icons = loader->result();
+        loader->deleteLater();
+
+        for (const auto &icon : icons) {
+            if (icon.findDefaultPath && !this->speciesToIconPath.contains(icon.species))
+                this->speciesToIconPath.insert(icon.species, icon.filepath);
+            if (!this->speciesIconCache.contains(icon.species))
+                recordSpeciesIcon(icon.species, icon.image);
+        }
+    });
+
+    const QString basePath = getSpeciesIconBasePath();
+    const QString speciesPrefix = projectConfig.getIdentifier(ProjectIdentifier::define_species_prefix);
+    // The worker indexes the icon directories itself if they haven't been indexed yet.
+    QHash<QString, QString> iconDirs = this->speciesIconDirsIndexed ? this->speciesIconDirs : QHash<QString, QString>();
+    const bool iconDirsIndexed = this->speciesIconDirsIndexed;
+    this->speciesIconLoader->setFuture(QtConcurrent::run(&this->speciesIconPool, [loads, basePath, speciesPrefix, iconDirs, iconDirsIndexed]() mutable {
+        QThread::currentThread()->setPriority(QThread::LowPriority);
+        if (!iconDirsIndexed)
+            iconDirs = readSpeciesIconDirs(basePath);
+        for (auto &load : loads) {
+            if (load.findDefaultPath)
+                load.filepath = findSpeciesIconPath({load.species.mid(speciesPrefix.length()).toLower()}, basePath, iconDirs);
+            load.image = readSpeciesIconImage(load.filepath);
+        }
+        return loads;
+    }));
 }
 
 int Project::getMapDataSize(int width, int height) const {
@@ -358,6 +358,7 @@ void MainWindow::setTilesetPalette(Tileset *tileset, int paletteIndex, QList<QLi
         tileset->palettes[paletteIndex][i] = qRgb(colors[i][0], colors[i][1], colors[i][2]);
         tileset->palettePreviews[paletteIndex][i] = qRgb(colors[i][0], colors[i][1], colors[i][2]);
     }
+    tileset->markChanged();
 }
 
 void MainWindow::setPrimaryTilesetPalette(int paletteIndex, QList<QList<int>> colors, bool forceRedraw) {
@@ -465,6 +466,7 @@ void MainWindow::setTilesetPalettePreview(Tileset *tileset, int paletteIndex, QL
             continue;
         tileset->palettePreviews[paletteIndex][i] = qRgb(colors[i][0], colors[i][1], colors[i][2]);
     }
+    tileset->markChanged();
 }
 
 void MainWindow::setPrimaryTilesetPalettePreview(int paletteIndex, QList<QList<int>> colors, bool forceRedraw) {
@@ -569,14 +571,18 @@ QString MainWindow::getSecondaryTileset() {
 
 void MainWindow::saveMetatilesByMetatileId(int metatileId) {
     Tileset * tileset = Tileset::getMetatileTileset(metatileId, this->editor->layout->tileset_primary, this->editor->layout->tileset_secondary);
-    if (tileset)
+    if (tileset) {
+        tileset->markChanged();
         tileset->saveMetatiles();
+    }
 }
 
 void MainWindow::saveMetatileAttributesByMetatileId(int metatileId) {
     Tileset * tileset = Tileset::getMetatileTileset(metatileId, this->editor->layout->tileset_primary, this->editor->layout->tileset_secondary);
-    if (tileset)
+    if (tileset) {
+        tileset->markChanged();
         tileset->saveMetatileAttributes();
+    }
 
     // If the tileset editor is open it needs to be refreshed with the new changes.
     // Rather than do a full refresh (which is costly) we tell the editor it will need
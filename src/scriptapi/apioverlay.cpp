@@ -4,9 +4,40 @@
 #include "imageproviders.h"
 #include "editor.h"
 
-void MapView::updateScene() {
-    if (this->scene()) {
+#include <QTimer>
+
+// Repainting is deferred until control returns to the event loop, so that a script adding
+// many overlay items at once only causes one update, limited to the area that changed.
+void MapView::updateScene(bool fullUpdate) {
+    if (fullUpdate)
+        this->sceneNeedsFullUpdate = true;
+    if (!this->sceneUpdateScheduled) {
+        this->sceneUpdateScheduled = true;
+        QTimer::singleShot(0, this, &MapView::flushSceneUpdate);
+    }
+}
+
+void MapView::flushSceneUpdate() {
+    this->sceneUpdateScheduled = false;
+    bool fullUpdate = this->sceneNeedsFullUpdate;
+    this->sceneNeedsFullUpdate = false;
+
+    QRectF dirtyRect;
+    for (auto overlay : this->overlayMap) {
+        if (overlay->isFullyDirty()) {
+            fullUpdate = true;
+        } else {
+            dirtyRect |= overlay->getDirtySceneRect();
+        }
+        overlay->clearDirty();
+    }
+
+    if (!this->scene())
+        return;
+    if (fullUpdate) {
         this->scene()->update();
+    } else if (!dirtyRect.isNull()) {
+        this->scene()->update(dirtyRect);
     }
 }
 
@@ -18,7 +49,7 @@ void MapView::clear(int layer) {
 // Overload. No layer provided, clear all layers
 void MapView::clear() {
     this->clearOverlayMap();
-    this->updateScene();
+    this->updateScene(true);
 }
 
 void MapView::hide(int layer) {
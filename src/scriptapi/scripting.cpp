@@ -5,6 +5,7 @@
 #include "log.h"
 #include "config.h"
 #include "mainwindow.h"
+#include "paintprofiler.h"
 
 const QMap<CallbackType, QString> callbackFunctions = {
     {OnProjectOpened, "onProjectOpened"},
@@ -159,6 +160,7 @@ bool Scripting::tryErrorJS(QJSValue js) {
 }
 
 void Scripting::invokeCallback(CallbackType type, QJSValueList args) {
+    PaintProfiler::Scope profilerScope(PaintProfiler::Phase::Scripts);
     for (QJSValue module : this->modules) {
         QString functionName = callbackFunctions[type];
         QJSValue callbackFunction = module.property(functionName);
@@ -429,5 +431,28 @@ const QImage * Scripting::getImage(const QString &inputFilepath, bool useCache)
     return image;
 }
 
+int Scripting::numCachedImages() {
+    return instance ? instance->imageCache.size() : 0;
+}
+
+qint64 Scripting::getImageCacheSize() {
+    if (!instance)
+        return 0;
+    qint64 size = 0;
+    for (const auto &image : instance->imageCache) {
+        if (image) size += Util::memoryUsage(*image);
+    }
+    return size;
+}
+
+// Overlays are only drawn by scripts, so their cached tiles are reported with the other script caches.
+int Scripting::numOverlayCachedTiles() {
+    return instance ? instance->mainWindow->ui->graphicsView_Map->numOverlayCachedTiles() : 0;
+}
+
+qint64 Scripting::getOverlayCacheSize() {
+    return instance ? instance->mainWindow->ui->graphicsView_Map->getOverlayCacheSize() : 0;
+}
+
 
 #endif // __has_include(<QQmlEngine>)
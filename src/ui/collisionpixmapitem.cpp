@@ -5,11 +5,20 @@
 void CollisionPixmapItem::draw(bool ignoreCache) {
     if (this->layout) {
         this->layout->setCollisionItem(this);
-        setPixmap(this->layout->renderCollision(ignoreCache));
+        if (shouldDrawChunked()) {
+            drawChunks(ignoreCache);
+        } else {
+            clearChunks();
+            renderPixmap(ignoreCache, [this, ignoreCache] { return this->layout->renderCollision(ignoreCache); });
+        }
         setOpacity(*this->opacity);
     }
 }
 
+QImage CollisionPixmapItem::renderChunk(const QRect &area) {
+    return this->layout->renderCollisionArea(area);
+}
+
 void CollisionPixmapItem::paint(QGraphicsSceneMouseEvent *event) {
     if (event->type() == QEvent::GraphicsSceneMouseRelease) {
         actionId_++;
@@ -4,6 +4,7 @@
 #include "editor.h"
 
 #include <math.h>
+#include <QStyleOptionGraphicsItem>
 
 ConnectionPixmapItem::ConnectionPixmapItem(MapConnection* connection)
     : QGraphicsPixmapItem(connection->render()),
@@ -53,6 +54,18 @@ void ConnectionPixmapItem::render(bool ignoreCache) {
     this->setPixmap(pixmap);
 }
 
+// When zoomed out, draw a downsampled copy of the pixmap rather than scaling the full pixmap.
+void ConnectionPixmapItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) {
+    const int level = PixmapPyramid::levelForTransform(painter);
+    if (level == 0 || pixmap().isNull()) {
+        QGraphicsPixmapItem::paint(painter, option, widget);
+        return;
+    }
+    if (this->pyramid.source().cacheKey() != pixmap().cacheKey())
+        this->pyramid.setSource(pixmap());
+    this->pyramid.paint(painter, offset(), option->exposedRect.translated(-offset()), level);
+}
+
 QVariant ConnectionPixmapItem::itemChange(GraphicsItemChange change, const QVariant &value)
 {
     if (change == ItemPositionChange) {
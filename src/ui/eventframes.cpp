@@ -192,6 +192,19 @@ void EventFrame::populateDropdown(NoScrollComboBox * combo, const QStringList &i
     combo->setTextItem(savedText);
 }
 
+void EventFrame::populateDropdown(NoScrollComboBox * combo, QStringListModel *model) {
+    // Same as above, but for lists owned by the project. The model is shared with every other
+    // frame displaying the same list, so we only need to attach it once. Typed text must not be
+    // inserted into the model, otherwise it would show up in every other dropdown.
+    if (!model || combo->model() == model)
+        return;
+    const QSignalBlocker b(combo);
+    const QString savedText = combo->currentText();
+    combo->setInsertPolicy(QComboBox::NoInsert);
+    combo->setModel(model);
+    combo->setTextItem(savedText);
+}
+
 void EventFrame::populateScriptDropdown(NoScrollComboBox * combo, Project * project) {
     // The script dropdown and autocomplete are populated with scripts used by the map's events and from its scripts file.
     Map *map = this->event ? this->event->getMap() : nullptr;
@@ -227,10 +240,8 @@ void EventFrame::populateMapNameDropdown(NoScrollComboBox * combo, Project * pro
     if (!project)
         return;
 
-    populateDropdown(combo, project->mapNames());
-
-    // This frame type displays map names, so when a new map is created we need to repopulate it.
-    connect(project, &Project::mapCreated, this, &EventFrame::invalidateValues, Qt::UniqueConnection);
+    // The shared model is updated by the project when a new map is created, so there's no need to repopulate.
+    populateDropdown(combo, project->getStringListModel("mapNames", project->mapNames()));
 }
 
 void EventFrame::populateIdNameDropdown(NoScrollComboBox * combo, Project * project, const QString &mapName, Event::Group group) {
@@ -456,10 +467,10 @@ void ObjectFrame::populate(Project *project) {
     const QSignalBlocker blocker(this);
     EventFrame::populate(project);
 
-    populateDropdown(this->combo_sprite, project->gfxDefines.keys());
-    populateDropdown(this->combo_movement, project->movementTypes);
-    populateDropdown(this->combo_flag, project->flagNames);
-    populateDropdown(this->combo_trainer_type, project->trainerTypes);
+    populateDropdown(this->combo_sprite, project->getStringListModel("gfxDefines", project->gfxDefines.keys()));
+    populateDropdown(this->combo_movement, project->getStringListModel("movementTypes", project->movementTypes));
+    populateDropdown(this->combo_flag, project->getStringListModel("flagNames", project->flagNames));
+    populateDropdown(this->combo_trainer_type, project->getStringListModel("trainerTypes", project->trainerTypes));
     populateScriptDropdown(this->combo_script, project);
 }
 
@@ -777,7 +788,7 @@ void TriggerFrame::populate(Project *project) {
     const QSignalBlocker blocker(this);
     EventFrame::populate(project);
 
-    populateDropdown(this->combo_var, project->varNames);
+    populateDropdown(this->combo_var, project->getStringListModel("varNames", project->varNames));
     populateScriptDropdown(this->combo_script, project);
 }
 
@@ -827,7 +838,7 @@ void WeatherTriggerFrame::populate(Project *project) {
     const QSignalBlocker blocker(this);
     EventFrame::populate(project);
 
-    populateDropdown(this->combo_weather, project->coordEventWeatherNames);
+    populateDropdown(this->combo_weather, project->getStringListModel("coordEventWeatherNames", project->coordEventWeatherNames));
 }
 
 
@@ -894,7 +905,7 @@ void SignFrame::populate(Project *project) {
     const QSignalBlocker blocker(this);
     EventFrame::populate(project);
 
-    populateDropdown(this->combo_facing_dir, project->bgEventFacingDirections);
+    populateDropdown(this->combo_facing_dir, project->getStringListModel("bgEventFacingDirections", project->bgEventFacingDirections));
     populateScriptDropdown(this->combo_script, project);
 }
 
@@ -1010,8 +1021,8 @@ void HiddenItemFrame::populate(Project *project) {
     const QSignalBlocker blocker(this);
     EventFrame::populate(project);
 
-    populateDropdown(this->combo_item, project->itemNames);
-    populateDropdown(this->combo_flag, project->flagNames);
+    populateDropdown(this->combo_item, project->getStringListModel("itemNames", project->itemNames));
+    populateDropdown(this->combo_flag, project->getStringListModel("flagNames", project->flagNames));
 }
 
 
@@ -1062,7 +1073,7 @@ void SecretBaseFrame::populate(Project *project) {
     const QSignalBlocker blocker(this);
     EventFrame::populate(project);
 
-    populateDropdown(this->combo_base_id, project->secretBaseIds);
+    populateDropdown(this->combo_base_id, project->getStringListModel("secretBaseIds", project->secretBaseIds));
 }
 
 
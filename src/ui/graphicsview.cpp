@@ -1,6 +1,9 @@
 #include "graphicsview.h"
 #include "mapview.h"
 #include "editor.h"
+#include "paintprofiler.h"
+
+#include <QFontDatabase>
 
 void MapView::moveEvent(QMoveEvent *event) {
     QGraphicsView::moveEvent(event);
@@ -17,9 +20,74 @@ void MapView::keyPressEvent(QKeyEvent *event) {
     }
 }
 
-void MapView::drawForeground(QPainter *painter, const QRectF&) {
+void MapView::paintEvent(QPaintEvent *event) {
+    PaintProfiler::Scope profilerScope(PaintProfiler::Phase::Repaint);
+    GraphicsView::paintEvent(event);
+}
+
+void MapView::setLatencyHudVisible(bool visible) {
+    if (!visible) {
+        this->latencyHudTimer.stop();
+        if (this->latencyHud) this->latencyHud->hide();
+        return;
+    }
+
+    if (!this->latencyHud) {
+        // The HUD is a separate opaque widget so that updating it doesn't repaint the map view underneath (and record more frames).
+        this->latencyHud = new QLabel(this);
+        this->latencyHud->setObjectName("label_LatencyHud");
+        this->latencyHud->setAttribute(Qt::WA_TransparentForMouseEvents);
+        this->latencyHud->setAutoFillBackground(true);
+        this->latencyHud->setFrameShape(QFrame::Box);
+        this->latencyHud->setMargin(3);
+        this->latencyHud->setTextFormat(Qt::PlainText);
+        this->latencyHud->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+
+        this->latencyHudTimer.setInterval(500);
+        connect(&this->latencyHudTimer, &QTimer::timeout, this, &MapView::updateLatencyHud);
+    }
+    updateLatencyHud();
+    this->latencyHud->show();
+    this->latencyHud->raise();
+    this->latencyHudTimer.start();
+}
+
+void MapView::updateLatencyHud() {
+    if (!this->latencyHud)
+        return;
+
+    const PaintProfiler::Stats latency = PaintProfiler::latencyStats();
+    const PaintProfiler::Stats frames = PaintProfiler::frameStats();
+    QStringList lines;
+    lines.append(QString("Latency  p50 %1  p95 %2  max %3 ms")
+                    .arg(latency.p50, 6, 'f', 2)
+                    .arg(latency.p95, 6, 'f', 2)
+                    .arg(latency.max, 6, 'f', 2));
+    for (int i = 0; i < static_cast<int>(PaintProfiler::Phase::Count); i++) {
+        const auto phase = static_cast<PaintProfiler::Phase>(i);
+        const PaintProfiler::Stats stats = PaintProfiler::phaseStats(phase);
+        lines.append(QString("  %1 mean %2  p95 %3 ms")
+                        .arg(PaintProfiler::phaseName(phase), -8)
+                        .arg(stats.mean, 6, 'f', 2)
+                        .arg(stats.p95, 6, 'f', 2));
+    }
+    lines.append(QString("Frames   p50 %1  p95 %2  max %3 ms")
+                    .arg(frames.p50, 6, 'f', 2)
+                    .arg(frames.p95, 6, 'f', 2)
+                    .arg(frames.max, 6, 'f', 2));
+    lines.append(QString("%1 edit(s), %2 frame(s) sampled").arg(latency.count).arg(frames.count));
+
+    this->latencyHud->setText(lines.join("\n"));
+    this->latencyHud->adjustSize();
+
+    // Keep the HUD in the top-right corner of the visible map area.
+    const QRect area = viewport()->geometry();
+    this->latencyHud->move(area.right() - this->latencyHud->width() - 6, area.top() + 6);
+}
+
+void MapView::drawForeground(QPainter *painter, const QRectF &rect) {
     for (auto i = this->overlayMap.constBegin(); i != this->overlayMap.constEnd(); i++) {
-        i.value()->renderItems(painter);
+        i.value()->renderItems(painter, rect);
     }
 
     if (!editor) return;
@@ -31,14 +99,15 @@ void MapView::drawForeground(QPainter *painter, const QRectF&) {
     // Draw map grid
     if (editor->mapGrid && editor->mapGrid->isVisible()) {
         painter->save();
+        QRectF gridRect = rect;
         if (editor->layout) {
             // We're clipping here to hide parts of the grid that are outside the map.
             const QRectF mapRect(-0.5, -0.5, editor->layout->pixelWidth() + 1.5, editor->layout->pixelHeight() + 1.5);
             painter->setClipping(true);
             painter->setClipRect(mapRect);
+            gridRect &= mapRect;
         }
-        for (auto item : editor->mapGrid->childItems())
-            item->paint(painter, &option, this);
+        editor->mapGrid->paint(painter, gridRect);
         painter->restore();
     }
 
@@ -65,6 +134,22 @@ Overlay * MapView::getOverlay(int layer) {
     return overlay;
 }
 
+qint64 MapView::getOverlayCacheSize() const {
+    qint64 size = 0;
+    for (const auto &overlay : this->overlayMap) {
+        size += overlay->getFlattenedTilesSize();
+    }
+    return size;
+}
+
+int MapView::numOverlayCachedTiles() const {
+    int count = 0;
+    for (const auto &overlay : this->overlayMap) {
+        count += overlay->numFlattenedTiles();
+    }
+    return count;
+}
+
 void ConnectionsView::keyPressEvent(QKeyEvent *event) {
     if (event->key() == Qt::Key_Delete || event->key() == Qt::Key_Backspace) {
         emit pressedDelete();
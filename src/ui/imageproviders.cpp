@@ -12,6 +12,36 @@ QImage getCollisionMetatileImage(int collision, int elevation) {
     return image ? *image : QImage();
 }
 
+// Write the collision icon for the given block to 'image' at pixel position (x, y), replacing what was there.
+// Rows are copied directly from the collision atlas, which is much faster than painting when drawing a whole layout.
+void drawCollisionMetatileImage(QImage *image, int x, int y, Block block) {
+    const QImage &atlas = Editor::collisionAtlas;
+    const int w = Metatile::pixelWidth(), h = Metatile::pixelHeight();
+    const QRect iconRect(block.collision() * w, block.elevation() * h, w, h);
+    if (!image || !atlas.rect().contains(iconRect))
+        return;
+
+    const QRect dest = QRect(x, y, w, h) & image->rect();
+    if (dest.isEmpty())
+        return;
+
+    if (image->format() != atlas.format()) {
+        QPainter painter(image);
+        painter.setCompositionMode(QPainter::CompositionMode_Source);
+        painter.drawImage(QPoint(x, y), atlas, iconRect);
+        return;
+    }
+
+    const int bytesPerPixel = atlas.depth() / 8;
+    const int srcX = iconRect.x() + (dest.x() - x);
+    const int srcY = iconRect.y() + (dest.y() - y);
+    for (int row = 0; row < dest.height(); row++) {
+        memcpy(image->scanLine(dest.y() + row) + dest.x() * bytesPerPixel,
+               atlas.constScanLine(srcY + row) + srcX * bytesPerPixel,
+               dest.width() * bytesPerPixel);
+    }
+}
+
 QImage getMetatileImage(uint16_t metatileId, const Layout *layout, bool useTruePalettes) {
     Metatile* metatile = Tileset::getMetatile(metatileId,
                                               layout ? layout->tileset_primary : nullptr,
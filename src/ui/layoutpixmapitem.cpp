@@ -1,9 +1,15 @@
 #include "layoutpixmapitem.h"
+#include "collisionpixmapitem.h"
 #include "metatile.h"
 #include "log.h"
 #include "scripting.h"
+#include "utility.h"
 
 #include "editcommands.h"
+#include "paintprofiler.h"
+
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
 
 #define SWAP(a, b) do { if (a != b) { a ^= b; b ^= a; a ^= b; } } while (0)
 
@@ -46,6 +52,11 @@ void LayoutPixmapItem::paint(QGraphicsSceneMouseEvent *event) {
 void LayoutPixmapItem::shift(QGraphicsSceneMouseEvent *event) {
     if (layout) {
         if (event->type() == QEvent::GraphicsSceneMouseRelease) {
+            // The blocks are shifted while dragging, but the edit is only committed once it's finished.
+            if (!this->shiftStartBlockdata.isEmpty() && this->layout->blockdata != this->shiftStartBlockdata) {
+                this->layout->editHistory.push(new ShiftMetatiles(this->layout, this->shiftStartBlockdata, this->layout->blockdata, actionId_));
+            }
+            this->shiftStartBlockdata.clear();
             actionId_++;
         } else {
             QPoint pos = Metatile::coordFromPixmapCoord(event->pos());
@@ -62,6 +73,7 @@ void LayoutPixmapItem::shift(QGraphicsSceneMouseEvent *event) {
             if (event->type() == QEvent::GraphicsSceneMousePress) {
                 selection_origin = QPoint(pos.x(), pos.y());
                 selection.clear();
+                this->shiftStartBlockdata = this->layout->blockdata;
             } else if (event->type() == QEvent::GraphicsSceneMouseMove) {
                 if (pos.x() != selection_origin.x() || pos.y() != selection_origin.y()) {
                     int xDelta = pos.x() - selection_origin.x();
@@ -70,6 +82,8 @@ void LayoutPixmapItem::shift(QGraphicsSceneMouseEvent *event) {
                     selection_origin = QPoint(pos.x(), pos.y());
                     selection.clear();
                     draw();
+                    if (this->layout->collisionItem)
+                        this->layout->collisionItem->draw();
                 }
             }
         }
@@ -77,26 +91,8 @@ void LayoutPixmapItem::shift(QGraphicsSceneMouseEvent *event) {
 }
 
 void LayoutPixmapItem::shift(int xDelta, int yDelta, bool fromScriptCall) {
-    Blockdata oldMetatiles = this->layout->blockdata;
-
-    for (int i = 0; i < this->layout->getWidth(); i++)
-    for (int j = 0; j < this->layout->getHeight(); j++) {
-        int destX = i + xDelta;
-        int destY = j + yDelta;
-        if (destX < 0)
-            do { destX += this->layout->getWidth(); } while (destX < 0);
-        if (destY < 0)
-            do { destY += this->layout->getHeight(); } while (destY < 0);
-        destX %= this->layout->getWidth();
-        destY %= this->layout->getHeight();
-
-        int blockIndex = j * this->layout->getWidth() + i;
-        Block srcBlock = oldMetatiles.value(blockIndex);
-        this->layout->setBlock(destX, destY, srcBlock);
-    }
-
-    if (!fromScriptCall && this->layout->blockdata != oldMetatiles) {
-        this->layout->editHistory.push(new ShiftMetatiles(this->layout, oldMetatiles, this->layout->blockdata, actionId_));
+    this->layout->shiftBlocks(xDelta, yDelta);
+    if (!fromScriptCall) {
         Scripting::cb_MapShifted(xDelta, yDelta);
     }
 }
@@ -427,27 +423,24 @@ void LayoutPixmapItem::magicFill(
         Blockdata oldMetatiles = !fromScriptCall ? this->layout->blockdata : Blockdata();
 
         bool setCollisions = selectedCollisions.length() == selectedMetatiles.length();
-        uint16_t metatileId = block.metatileId();
-        for (int y = 0; y < this->layout->getHeight(); y++) {
-            for (int x = 0; x < this->layout->getWidth(); x++) {
-                if (this->layout->getBlock(x, y, &block) && block.metatileId() == metatileId) {
-                    int xDiff = x - initialX;
-                    int yDiff = y - initialY;
-                    int i = xDiff % selectionDimensions.width();
-                    int j = yDiff % selectionDimensions.height();
-                    if (i < 0) i = selectionDimensions.width() + i;
-                    if (j < 0) j = selectionDimensions.height() + j;
-                    int index = j * selectionDimensions.width() + i;
-                    if (index < selectedMetatiles.length() && selectedMetatiles.at(index).enabled) {
-                        block.setMetatileId(selectedMetatiles.at(index).metatileId);
-                        if (setCollisions) {
-                            CollisionSelectionItem item = selectedCollisions.at(index);
-                            block.setCollision(item.collision);
-                            block.setElevation(item.elevation);
-                        }
-                        this->layout->setBlock(x, y, block, !fromScriptCall);
-                    }
+        for (const QPoint &pos : this->layout->getMetatilePositions(block.metatileId())) {
+            if (!this->layout->getBlock(pos, &block))
+                continue;
+            int xDiff = pos.x() - initialX;
+            int yDiff = pos.y() - initialY;
+            int i = xDiff % selectionDimensions.width();
+            int j = yDiff % selectionDimensions.height();
+            if (i < 0) i = selectionDimensions.width() + i;
+            if (j < 0) j = selectionDimensions.height() + j;
+            int index = j * selectionDimensions.width() + i;
+            if (index < selectedMetatiles.length() && selectedMetatiles.at(index).enabled) {
+                block.setMetatileId(selectedMetatiles.at(index).metatileId);
+                if (setCollisions) {
+                    CollisionSelectionItem item = selectedCollisions.at(index);
+                    block.setCollision(item.collision);
+                    block.setElevation(item.elevation);
                 }
+                this->layout->setBlock(pos, block, !fromScriptCall);
             }
         }
 
@@ -688,10 +681,195 @@ void LayoutPixmapItem::select(QGraphicsSceneMouseEvent *event) {
 }
 
 void LayoutPixmapItem::draw(bool ignoreCache) {
+    PaintProfiler::Scope profilerScope(PaintProfiler::Phase::Render);
     if (this->layout) {
         layout->setLayoutItem(this);
-        setPixmap(this->layout->render(ignoreCache));
+        if (shouldDrawChunked()) {
+            drawChunks(ignoreCache);
+        } else {
+            clearChunks();
+            renderPixmap(ignoreCache, [this, ignoreCache] { return this->layout->render(ignoreCache); });
+        }
+    }
+}
+
+// Render the item's pixmap with 'render'. The blocks the layout recorded as changed since the last draw
+// give the area that changed, so that only that area of the downsampled copies needs to be updated.
+void LayoutPixmapItem::renderPixmap(bool ignoreCache, const std::function<QPixmap()> &render) {
+    QVector<int> changedBlocks;
+    const bool changesKnown = takeChangedBlocks(&changedBlocks);
+    if (ignoreCache || !changesKnown || this->pyramid.isEmpty()) {
+        setPixmap(render());
+        this->pyramid.setSource(pixmap());
+    } else {
+        const QRect changedRect = getChangedPixelRect(changedBlocks);
+        const qint64 oldCacheKey = pixmap().cacheKey();
+        setPixmap(render());
+        if (changedRect.isEmpty() && pixmap().cacheKey() != oldCacheKey) {
+            // The layout was rendered somewhere else since our last draw, so we can't tell what changed.
+            this->pyramid.setSource(pixmap());
+        } else {
+            this->pyramid.updateSource(pixmap(), changedRect);
+        }
+    }
+}
+
+QRect LayoutPixmapItem::getChangedPixelRect(const QVector<int> &changedBlocks) const {
+    const int width = this->layout->getWidth();
+    if (width <= 0)
+        return QRect(QPoint(0, 0), this->layout->pixelSize());
+
+    QRect changedRect;
+    for (const int &i : changedBlocks) {
+        changedRect |= QRect((i % width) * Metatile::pixelWidth(), (i / width) * Metatile::pixelHeight(), Metatile::pixelWidth(), Metatile::pixelHeight());
+    }
+    return changedRect;
+}
+
+bool LayoutPixmapItem::shouldDrawChunked() const {
+    return this->layout && (this->layout->getWidth() * this->layout->getHeight()) > maxUnchunkedArea;
+}
+
+QImage LayoutPixmapItem::renderChunk(const QRect &area) {
+    return this->layout->renderArea(area);
+}
+
+// Get the indexes of the blocks that changed since this item last drew its layout, as recorded by the layout.
+// Returns false if they aren't known, in which case everything should be redrawn.
+bool LayoutPixmapItem::takeChangedBlocks(QVector<int> *changedBlocks) {
+    const bool known = this->drawnLayout == this->layout && this->layout->getChangedBlocks(this->drawnBlockChangeCount, changedBlocks);
+    this->drawnLayout = this->layout;
+    this->drawnBlockChangeCount = this->layout->blockChangeCount();
+    return known;
+}
+
+// Invalidate the chunks whose blocks changed since the last draw. They'll be rendered again when they're next painted.
+void LayoutPixmapItem::drawChunks(bool ignoreCache) {
+    QVector<int> changedBlocks;
+    if (!takeChangedBlocks(&changedBlocks))
+        ignoreCache = true;
+
+    const QSize pixelSize = this->layout->pixelSize();
+    if (!this->chunked || this->chunkedPixelSize != pixelSize) {
+        if (!pixmap().isNull()) {
+            setPixmap(QPixmap());
+        }
+        prepareGeometryChange();
+        this->chunked = true;
+        this->chunkedPixelSize = pixelSize;
+        ignoreCache = true;
+    }
+
+    const int width = this->layout->getWidth();
+    if (ignoreCache || width <= 0) {
+        this->chunkCache.clear();
+        update();
+    } else {
+        QSet<quint64> dirtyChunks;
+        for (const int &i : changedBlocks) {
+            dirtyChunks.insert(chunkKey((i % width) / chunkSize, (i / width) / chunkSize));
+        }
+        for (const quint64 &key : dirtyChunks) {
+            const int x = chunkKeyX(key);
+            const int y = chunkKeyY(key);
+            for (int level = 0; level <= PixmapPyramid::maxLevel; level++) {
+                this->chunkCache.remove(chunkKey(x, y, level));
+            }
+            update(getChunkPixelRect(x, y));
+        }
+    }
+}
+
+void LayoutPixmapItem::clearChunks() {
+    if (!this->chunked)
+        return;
+    prepareGeometryChange();
+    this->chunked = false;
+    this->chunkedPixelSize = QSize();
+    this->chunkCache.clear();
+    this->pyramid.setSource(QPixmap());
+}
+
+QRect LayoutPixmapItem::getChunkPixelRect(int x, int y) const {
+    const int chunkPixelWidth = chunkSize * Metatile::pixelWidth();
+    const int chunkPixelHeight = chunkSize * Metatile::pixelHeight();
+    return QRect(x * chunkPixelWidth, y * chunkPixelHeight, chunkPixelWidth, chunkPixelHeight);
+}
+
+MemoryUsage LayoutPixmapItem::memoryBreakdown(const QString &name) const {
+    MemoryUsage usage(name);
+    usage.add("Chunk cache", static_cast<qint64>(this->chunkCache.totalCost()) * 1024, this->chunkCache.count());
+    usage.add("Pixmap pyramid", this->pyramid.memoryUsage(), this->pyramid.numBuiltLevels());
+    return usage;
+}
+
+QPixmap LayoutPixmapItem::getChunk(int x, int y, int level) {
+    const quint64 key = chunkKey(x, y, level);
+    const QPixmap *cachedChunk = this->chunkCache.object(key);
+    if (cachedChunk)
+        return *cachedChunk;
+
+    // Downsampled chunks are made from the full-size chunk.
+    QPixmap chunk = (level > 0) ? PixmapPyramid::downsample(getChunk(x, y), level)
+                                : QPixmap::fromImage(renderChunk(QRect(x * chunkSize, y * chunkSize, chunkSize, chunkSize)));
+    int cost = qMax(static_cast<qint64>(1), Util::memoryUsage(chunk) / 1024);
+    this->chunkCache.insert(key, new QPixmap(chunk), cost);
+    return chunk;
+}
+
+QRectF LayoutPixmapItem::boundingRect() const {
+    if (!this->chunked)
+        return QGraphicsPixmapItem::boundingRect();
+    return QRectF(offset(), QSizeF(this->chunkedPixelSize));
+}
+
+QPainterPath LayoutPixmapItem::shape() const {
+    if (!this->chunked)
+        return QGraphicsPixmapItem::shape();
+    QPainterPath path;
+    path.addRect(boundingRect());
+    return path;
+}
+
+void LayoutPixmapItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) {
+    const int level = PixmapPyramid::levelForTransform(painter);
+    if (!this->chunked) {
+        if (level == 0 || pixmap().isNull()) {
+            QGraphicsPixmapItem::paint(painter, option, widget);
+        } else {
+            if (this->pyramid.source().cacheKey() != pixmap().cacheKey())
+                this->pyramid.setSource(pixmap());
+            this->pyramid.paint(painter, offset(), option->exposedRect.translated(-offset()), level);
+        }
+        return;
+    }
+
+    // Only draw the chunks in the area that needs repainting.
+    const QRect exposedRect = option->exposedRect.translated(-offset()).toAlignedRect() & QRect(QPoint(0, 0), this->chunkedPixelSize);
+    if (exposedRect.isEmpty())
+        return;
+
+    const int chunkPixelWidth = chunkSize * Metatile::pixelWidth();
+    const int chunkPixelHeight = chunkSize * Metatile::pixelHeight();
+    for (int y = exposedRect.top() / chunkPixelHeight; y <= exposedRect.bottom() / chunkPixelHeight; y++)
+    for (int x = exposedRect.left() / chunkPixelWidth; x <= exposedRect.right() / chunkPixelWidth; x++) {
+        const QRect chunkRect = getChunkPixelRect(x, y);
+        if (level == 0) {
+            painter->drawPixmap(offset() + chunkRect.topLeft(), getChunk(x, y));
+        } else {
+            const QPixmap chunk = getChunk(x, y, level);
+            painter->drawPixmap(QRectF(offset() + chunkRect.topLeft(), QSizeF(chunkRect.size())), chunk, QRectF(chunk.rect()));
+        }
+    }
+}
+
+QVariant LayoutPixmapItem::itemChange(GraphicsItemChange change, const QVariant &value) {
+    // Hidden items don't need to hold on to their rendered chunks.
+    if (change == QGraphicsItem::ItemVisibleHasChanged && !value.toBool()) {
+        this->chunkCache.clear();
+        this->pyramid.clear();
     }
+    return QGraphicsPixmapItem::itemChange(change, value);
 }
 
 void LayoutPixmapItem::hoverMoveEvent(QGraphicsSceneHoverEvent *event) {
@@ -714,6 +892,8 @@ void LayoutPixmapItem::hoverLeaveEvent(QGraphicsSceneHoverEvent *) {
 }
 
 void LayoutPixmapItem::mousePressEvent(QGraphicsSceneMouseEvent *event) {
+    PaintProfiler::beginInteraction();
+    PaintProfiler::Scope profilerScope(PaintProfiler::Phase::Input);
     this->metatilePos = Metatile::coordFromPixmapCoord(event->pos());
     this->paint_tile_initial_x = this->straight_path_initial_x = this->metatilePos.x();
     this->paint_tile_initial_y = this->straight_path_initial_y = this->metatilePos.y();
@@ -726,12 +906,16 @@ void LayoutPixmapItem::mouseMoveEvent(QGraphicsSceneMouseEvent *event) {
     if (pos == this->metatilePos)
         return;
 
+    PaintProfiler::beginInteraction();
+    PaintProfiler::Scope profilerScope(PaintProfiler::Phase::Input);
     this->metatilePos = pos;
     emit hoverChanged(pos);
     emit mouseEvent(event, this);
 }
 
 void LayoutPixmapItem::mouseReleaseEvent(QGraphicsSceneMouseEvent *event) {
+    PaintProfiler::beginInteraction();
+    PaintProfiler::Scope profilerScope(PaintProfiler::Phase::Input);
     this->lockedAxis = LayoutPixmapItem::Axis::None;
     emit endPaint(event, this);
     emit mouseEvent(event, this);
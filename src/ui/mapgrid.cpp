@@ -0,0 +1,107 @@
+#include "mapgrid.h"
+
+#include <QtMath>
+
+void MapGrid::setSettings(const GridSettings &settings) {
+    if (m_settings == settings)
+        return;
+    m_settings = settings;
+    m_tile = QPixmap();
+    m_tileScale = 0;
+}
+
+void MapGrid::paint(QPainter *painter, const QRectF &rect) {
+    if (!m_visible || m_settings.width == 0 || m_settings.height == 0 || rect.isEmpty())
+        return;
+
+    // Scale from the grid's coordinates to pixels on the device.
+    const QTransform transform = painter->transform();
+    const qreal scale = transform.m11() * painter->device()->devicePixelRatioF();
+    if (transform.isRotating() || scale <= 0 || transform.m11() != transform.m22() || !updateTile(scale)) {
+        paintLines(painter, rect);
+        return;
+    }
+
+    QTransform brushTransform;
+    brushTransform.translate(m_settings.offsetX, m_settings.offsetY);
+    brushTransform.scale(1.0 / scale, 1.0 / scale);
+    QBrush brush(m_tile);
+    brush.setTransform(brushTransform);
+
+    painter->save();
+    painter->setRenderHint(QPainter::SmoothPixmapTransform, false);
+    painter->fillRect(rect, brush);
+    painter->restore();
+}
+
+// Render the tile for the given scale. Returns false if the grid can't be tiled at this scale.
+bool MapGrid::updateTile(qreal scale) {
+    if (scale == m_tileScale)
+        return m_canTile;
+    m_tileScale = scale;
+    m_tile = QPixmap();
+    m_canTile = false;
+
+    // The tile needs to be a whole number of pixels, or it would drift from the grid as it repeats.
+    // Use the smallest number of cells that gives us that.
+    auto isWhole = [](qreal value) { return qAbs(value - qRound(value)) < 0.001; };
+    int numCells = 0;
+    for (int i = 1; i <= maxTileCells; i++) {
+        if (isWhole(i * m_settings.width * scale) && isWhole(i * m_settings.height * scale)) {
+            numCells = i;
+            break;
+        }
+    }
+    if (numCells == 0)
+        return false;
+
+    const int tileWidth = qRound(numCells * m_settings.width * scale);
+    const int tileHeight = qRound(numCells * m_settings.height * scale);
+    if (tileWidth <= 0 || tileHeight <= 0 || tileWidth > maxTilePixelSize || tileHeight > maxTilePixelSize)
+        return false;
+
+    // Lines from neighboring tiles can reach into this one, so draw the lines in the cells around it too.
+    // 'paintLines' is relative to the grid's offset, so we undo that to put a grid corner at the tile's origin.
+    m_tile = QPixmap(tileWidth, tileHeight);
+    m_tile.fill(Qt::transparent);
+    QPainter painter(&m_tile);
+    painter.scale(scale, scale);
+    painter.translate(-m_settings.offsetX, -m_settings.offsetY);
+    paintLines(&painter, QRectF(m_settings.offsetX, m_settings.offsetY, numCells * m_settings.width, numCells * m_settings.height));
+    painter.end();
+
+    m_canTile = true;
+    return true;
+}
+
+// Draw each of the grid lines that cross 'rect'.
+void MapGrid::paintLines(QPainter *painter, const QRectF &rect) const {
+    const int width = m_settings.width;
+    const int height = m_settings.height;
+
+    // The dash patterns need to start at a line intersection, so the lines start one cell before 'rect'.
+    const int left = m_settings.offsetX + (qFloor((rect.left() - m_settings.offsetX) / width) - 1) * width;
+    const int top = m_settings.offsetY + (qFloor((rect.top() - m_settings.offsetY) / height) - 1) * height;
+    const qreal right = rect.right() + width;
+    const qreal bottom = rect.bottom() + height;
+
+    painter->save();
+    painter->setClipRect(rect, Qt::IntersectClip);
+
+    QPen pen;
+    pen.setColor(m_settings.color);
+
+    // Vertical lines
+    pen.setDashPattern(m_settings.getVerticalDashPattern());
+    painter->setPen(pen);
+    for (int x = left; x <= right; x += width)
+        painter->drawLine(QLineF(x, top, x, bottom));
+
+    // Horizontal lines
+    pen.setDashPattern(m_settings.getHorizontalDashPattern());
+    painter->setPen(pen);
+    for (int y = top; y <= bottom; y += height)
+        painter->drawLine(QLineF(left, y, right, y));
+
+    painter->restore();
+}
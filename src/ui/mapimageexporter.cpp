@@ -46,6 +46,9 @@ MapImageExporter::MapImageExporter(QWidget *parent, Project *project, Map *map,
     setAttribute(Qt::WA_DeleteOnClose);
     ui->setupUi(this);
 
+    // We hold onto the layouts we're exporting, so they shouldn't be unloaded while the exporter is open.
+    if (m_project) m_project->blockCacheEviction();
+
     m_scene = new CheckeredBgScene(QSize(8,8), this);
     m_preview = m_scene->addPixmap(QPixmap());
     ui->graphicsView_Preview->setScene(m_scene);
@@ -78,6 +81,7 @@ MapImageExporter::MapImageExporter(QWidget *parent, Project *project, Map *map,
 }
 
 MapImageExporter::~MapImageExporter() {
+    if (m_project) m_project->unblockCacheEviction();
     delete m_timelapseGifImage;
     delete ui;
 }
@@ -677,12 +681,19 @@ void MapImageExporter::paintEvents(QPainter *painter, const Map *map) {
     if (!eventsEnabled())
         return;
 
+    // Event sprites are loaded in the background. Request them all, then wait for any that aren't ready yet.
+    for (const auto &event : map->getEvents()) {
+        m_project->loadEventPixmap(event);
+    }
+    m_project->finishEventGraphicsLoads();
+
     auto savedOpacity = painter->opacity();
     for (const auto &group : Event::groups()) {
         if (!m_settings.showEvents.contains(group))
             continue;
         for (const auto &event : map->getEvents(group)) {
-            m_project->loadEventPixmap(event);
+            // Events that were waiting for their sprite are still using the default sprite.
+            m_project->loadEventPixmap(event, event->getUsesDefaultPixmap());
             if (m_mode != ImageExporterMode::Timelapse) {
                 // GIF format doesn't support partial transparency, so we can't do this in Timelapse mode.
                 painter->setOpacity(event->getUsesDefaultPixmap() ? 0.7 : 1.0);
@@ -83,6 +83,13 @@ QModelIndex MapListModel::indexOf(const QString &itemName) const {
     return QModelIndex();
 }
 
+// Redraw an item whose icon may have changed, e.g. because its map or layout was loaded or unloaded.
+void MapListModel::updateItem(const QString &itemName) {
+    const QModelIndex index = this->indexOf(itemName);
+    if (index.isValid())
+        emit dataChanged(index, index, {Qt::DecorationRole});
+}
+
 void MapListModel::removeItemAt(const QModelIndex &index) {
     QStandardItem *item = this->itemAt(index)->child(index.row(), index.column());
     if (!item)
@@ -0,0 +1,163 @@
+#include "memoryinspector.h"
+#include "project.h"
+#include "filedialog.h"
+#include "message.h"
+
+#include <QVBoxLayout>
+#include <QDialogButtonBox>
+#include <QHeaderView>
+#include <QScrollBar>
+#include <QJsonDocument>
+#include <QDateTime>
+#include <QSaveFile>
+
+enum UsageColumn {
+    NameColumn,
+    SizeColumn,
+    CountColumn,
+    NoteColumn,
+};
+
+// Items are identified by their path in the tree so that they stay expanded when the tree is rebuilt.
+static const int PathRole = Qt::UserRole;
+
+MemoryInspector::MemoryInspector(Project *project, QWidget *parent) :
+    QDialog(parent),
+    project(project)
+{
+    setAttribute(Qt::WA_DeleteOnClose);
+    setWindowTitle(QStringLiteral("Memory Usage"));
+    resize(700, 600);
+
+    auto layout = new QVBoxLayout(this);
+
+    this->label_Summary = new QLabel(this);
+    this->label_Summary->setWordWrap(true);
+    layout->addWidget(this->label_Summary);
+
+    this->tree_Usage = new QTreeWidget(this);
+    this->tree_Usage->setHeaderLabels({"Name", "Size", "Count", "Note"});
+    this->tree_Usage->setUniformRowHeights(true);
+    this->tree_Usage->header()->setSectionResizeMode(UsageColumn::NameColumn, QHeaderView::Stretch);
+    this->tree_Usage->header()->setStretchLastSection(false);
+    layout->addWidget(this->tree_Usage);
+
+    this->checkBox_AutoRefresh = new QCheckBox(QStringLiteral("Refresh automatically"), this);
+    this->checkBox_AutoRefresh->setChecked(true);
+    layout->addWidget(this->checkBox_AutoRefresh);
+
+    auto buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    auto button_Refresh = buttonBox->addButton(QStringLiteral("Refresh"), QDialogButtonBox::ActionRole);
+    this->button_Export = buttonBox->addButton(QStringLiteral("Export..."), QDialogButtonBox::ActionRole);
+    this->button_Export->setToolTip(QStringLiteral("Save the current breakdown as a JSON file."));
+    layout->addWidget(buttonBox);
+
+    connect(buttonBox, &QDialogButtonBox::rejected, this, &MemoryInspector::close);
+    connect(button_Refresh, &QPushButton::clicked, this, &MemoryInspector::refresh);
+    connect(this->button_Export, &QPushButton::clicked, this, &MemoryInspector::exportUsage);
+    connect(this->checkBox_AutoRefresh, &QCheckBox::toggled, [this](bool enabled) {
+        if (enabled && isVisible()) {
+            refresh();
+            this->refreshTimer.start();
+        } else {
+            this->refreshTimer.stop();
+        }
+    });
+
+    this->refreshTimer.setInterval(1000);
+    connect(&this->refreshTimer, &QTimer::timeout, this, &MemoryInspector::refresh);
+}
+
+void MemoryInspector::showEvent(QShowEvent *event) {
+    QDialog::showEvent(event);
+    refresh();
+    if (this->checkBox_AutoRefresh->isChecked())
+        this->refreshTimer.start();
+}
+
+void MemoryInspector::hideEvent(QHideEvent *event) {
+    QDialog::hideEvent(event);
+    this->refreshTimer.stop();
+}
+
+QSet<QString> MemoryInspector::getExpandedPaths() const {
+    QSet<QString> paths;
+    QList<QTreeWidgetItem*> items;
+    for (int i = 0; i < this->tree_Usage->topLevelItemCount(); i++) {
+        items.append(this->tree_Usage->topLevelItem(i));
+    }
+    while (!items.isEmpty()) {
+        QTreeWidgetItem *item = items.takeLast();
+        if (!item->isExpanded())
+            continue;
+        paths.insert(item->data(UsageColumn::NameColumn, PathRole).toString());
+        for (int i = 0; i < item->childCount(); i++) {
+            items.append(item->child(i));
+        }
+    }
+    return paths;
+}
+
+void MemoryInspector::populateItem(QTreeWidgetItem *item, const MemoryUsage &usage, const QString &path, const QSet<QString> &expandedPaths) {
+    item->setText(UsageColumn::NameColumn, usage.name);
+    item->setData(UsageColumn::NameColumn, PathRole, path);
+    item->setText(UsageColumn::SizeColumn, locale().formattedDataSize(usage.total()));
+    item->setTextAlignment(UsageColumn::SizeColumn, Qt::AlignRight | Qt::AlignVCenter);
+    if (usage.count >= 0) {
+        item->setText(UsageColumn::CountColumn, QString::number(usage.count));
+        item->setTextAlignment(UsageColumn::CountColumn, Qt::AlignRight | Qt::AlignVCenter);
+    }
+    item->setText(UsageColumn::NoteColumn, usage.note);
+
+    for (const auto &child : usage.children) {
+        populateItem(new QTreeWidgetItem(item), child, path + "/" + child.name, expandedPaths);
+    }
+    item->setExpanded(expandedPaths.contains(path));
+}
+
+void MemoryInspector::refresh() {
+    if (!this->project) {
+        this->tree_Usage->clear();
+        this->label_Summary->setText(QStringLiteral("No project is open."));
+        this->button_Export->setEnabled(false);
+        return;
+    }
+
+    const bool firstRefresh = this->tree_Usage->topLevelItemCount() == 0;
+    QSet<QString> expandedPaths = getExpandedPaths();
+    const int scrollPosition = this->tree_Usage->verticalScrollBar()->value();
+
+    this->usage = this->project->getMemoryUsage();
+
+    this->tree_Usage->setUpdatesEnabled(false);
+    this->tree_Usage->clear();
+    for (const auto &child : this->usage.children) {
+        if (firstRefresh) expandedPaths.insert(child.name);
+        populateItem(new QTreeWidgetItem(this->tree_Usage), child, child.name, expandedPaths);
+    }
+    this->tree_Usage->resizeColumnToContents(UsageColumn::SizeColumn);
+    this->tree_Usage->resizeColumnToContents(UsageColumn::CountColumn);
+    this->tree_Usage->verticalScrollBar()->setValue(scrollPosition);
+    this->tree_Usage->setUpdatesEnabled(true);
+
+    this->label_Summary->setText(QString("Estimated total: %1. Sizes are estimates of the data porymap holds, not the process's actual memory use.")
+                                    .arg(locale().formattedDataSize(this->usage.total())));
+    this->button_Export->setEnabled(true);
+}
+
+void MemoryInspector::exportUsage() {
+    const QString defaultFilepath = QString("%1/memory_usage.json").arg(FileDialog::getDirectory());
+    const QString filepath = FileDialog::getSaveFileName(this, QStringLiteral("Export Memory Usage"), defaultFilepath, QStringLiteral("JSON Files (*.json)"));
+    if (filepath.isEmpty())
+        return;
+
+    QJsonObject obj = this->usage.toJson();
+    obj["timestamp"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+
+    QSaveFile file(filepath);
+    if (!file.open(QIODevice::WriteOnly)
+     || file.write(QJsonDocument(obj).toJson(QJsonDocument::Indented)) < 0
+     || !file.commit()) {
+        ErrorMessage::show(QString("Failed to export memory usage to '%1'.").arg(filepath), file.errorString(), this);
+    }
+}
@@ -2,6 +2,12 @@
 #include "overlay.h"
 #include "scripting.h"
 #include "log.h"
+#include "utility.h"
+
+#include <QFontMetricsF>
+#include <QtMath>
+#include <algorithm>
+#include <cmath>
 
 void OverlayText::render(QPainter *painter) {
     QFont font = painter->font();
@@ -11,6 +17,16 @@ void OverlayText::render(QPainter *painter) {
     painter->drawStaticText(this->x, this->y, this->text);
 }
 
+QRectF OverlayText::calculateBounds() const {
+    // The text is drawn with the painter's font family, which we don't know yet. Measure with the
+    // default font and pad the result by the font size so that the bounds are large enough regardless.
+    QFont font;
+    font.setPixelSize(qMax(1, this->fontSize));
+    QRectF rect = QFontMetricsF(font).boundingRect(QRectF(), Qt::AlignLeft | Qt::AlignTop, this->text.text());
+    rect.translate(this->x, this->y);
+    return rect.adjusted(-this->fontSize, -this->fontSize, this->fontSize, this->fontSize);
+}
+
 void OverlayPath::render(QPainter *painter) {
     painter->fillPath(this->path, this->fillColor);
     painter->setPen(this->borderColor);
@@ -21,8 +37,31 @@ void OverlayPixmap::render(QPainter *painter) {
     painter->drawPixmap(this->x, this->y, this->pixmap);
 }
 
-void Overlay::renderItems(QPainter *painter) {
-    if (this->hidden) return;
+QTransform Overlay::getTransform() const {
+    QTransform transform;
+    transform.translate(this->x, this->y);
+    transform.rotate(this->angle);
+    transform.scale(this->hScale, this->vScale);
+    return transform;
+}
+
+// 'exposedRect' is the area of the scene that needs to be painted. If it's invalid, all the items are painted.
+void Overlay::renderItems(QPainter *painter, const QRectF &exposedRect) {
+    if (this->hidden || this->items.isEmpty()) return;
+
+    const QTransform transform = getTransform();
+    if (!transform.isInvertible()) return;
+
+    // Get the area of the layer that needs to be painted.
+    QRectF rect;
+    if (exposedRect.isValid()) {
+        QRectF sceneRect = exposedRect;
+        if (this->clippingRect)
+            sceneRect &= *this->clippingRect;
+        if (sceneRect.isEmpty())
+            return;
+        rect = transform.inverted().mapRect(sceneRect);
+    }
 
     painter->save();
 
@@ -31,36 +70,210 @@ void Overlay::renderItems(QPainter *painter) {
         painter->setClipRect(*this->clippingRect);
     }
 
-    QTransform transform = painter->transform();
-    transform.translate(this->x, this->y);
-    transform.rotate(this->angle);
-    transform.scale(this->hScale, this->vScale);
-    painter->setTransform(transform);
+    painter->setTransform(transform * painter->transform());
 
-    painter->setOpacity(this->opacity);
-    for (auto item : this->items)
-        item->render(painter);
+    if (!renderFlattened(painter, rect)) {
+        painter->setOpacity(this->opacity);
+        for (const int &index : getItemIndexes(rect))
+            this->items.at(index)->render(painter);
+    }
 
     painter->restore();
 }
 
+QRect Overlay::getBucketRange(const QRectF &rect) {
+    return QRect(QPoint(qFloor(rect.left() / bucketSize), qFloor(rect.top() / bucketSize)),
+                 QPoint(qFloor(rect.right() / bucketSize), qFloor(rect.bottom() / bucketSize)));
+}
+
+// Returns the indexes of the items that intersect 'rect', in the order they should be drawn.
+// If 'rect' is invalid, all the items are returned.
+QList<int> Overlay::getItemIndexes(const QRectF &rect) const {
+    QList<int> indexes;
+    if (!rect.isValid()) {
+        for (int i = 0; i < this->items.length(); i++)
+            indexes.append(i);
+        return indexes;
+    }
+
+    const QRect range = getBucketRange(rect & this->itemsBoundingRect);
+    if (range.isEmpty() || static_cast<qint64>(range.width()) * range.height() >= this->buckets.size()) {
+        // The area covers most of the buckets, it's faster to just check every item.
+        for (int i = 0; i < this->items.length(); i++) {
+            if (this->items.at(i)->boundingRect().intersects(rect))
+                indexes.append(i);
+        }
+        return indexes;
+    }
+
+    for (int y = range.top(); y <= range.bottom(); y++)
+    for (int x = range.left(); x <= range.right(); x++) {
+        auto it = this->buckets.constFind(bucketKey(x, y));
+        if (it == this->buckets.constEnd())
+            continue;
+        for (const int &index : it.value()) {
+            if (this->items.at(index)->boundingRect().intersects(rect))
+                indexes.append(index);
+        }
+    }
+    for (const int &index : this->unbucketedItems) {
+        if (this->items.at(index)->boundingRect().intersects(rect))
+            indexes.append(index);
+    }
+
+    // Items that overlap several buckets will appear more than once.
+    std::sort(indexes.begin(), indexes.end());
+    indexes.erase(std::unique(indexes.begin(), indexes.end()), indexes.end());
+    return indexes;
+}
+
+// Draw the layer using the cached tiles of its items. Returns false if the layer shouldn't be drawn this way.
+bool Overlay::renderFlattened(QPainter *painter, const QRectF &rect) {
+    if (this->items.length() < flattenThreshold)
+        return false;
+
+    const qreal viewScale = qSqrt(qAbs(painter->transform().determinant()));
+    if (viewScale <= 0 || viewScale > maxFlattenedScale)
+        return false;
+
+    const qreal scale = qPow(2, qCeil(std::log2(viewScale)));
+    if (scale != this->flattenedScale) {
+        this->flattenedTiles.clear();
+        this->flattenedScale = scale;
+    }
+
+    // The layer's opacity is applied while rendering the tiles.
+    painter->setOpacity(1.0);
+
+    const QRectF area = rect.isValid() ? (rect & this->itemsBoundingRect) : this->itemsBoundingRect;
+    if (area.isEmpty())
+        return true;
+
+    const QRect range = getBucketRange(area);
+    for (int y = range.top(); y <= range.bottom(); y++)
+    for (int x = range.left(); x <= range.right(); x++) {
+        const QPixmap tile = getFlattenedTile(x, y, scale, painter);
+        if (!tile.isNull())
+            painter->drawPixmap(QRectF(x * bucketSize, y * bucketSize, bucketSize, bucketSize), tile, QRectF(tile.rect()));
+    }
+    return true;
+}
+
+QPixmap Overlay::getFlattenedTile(int x, int y, qreal scale, const QPainter *painter) {
+    const quint64 key = bucketKey(x, y);
+    const QPixmap *cachedTile = this->flattenedTiles.object(key);
+    if (cachedTile)
+        return *cachedTile;
+
+    QPixmap tile;
+    const QRectF tileRect(x * bucketSize, y * bucketSize, bucketSize, bucketSize);
+    const QList<int> indexes = getItemIndexes(tileRect);
+    if (!indexes.isEmpty()) {
+        const int size = qCeil(bucketSize * scale);
+        tile = QPixmap(size, size);
+        tile.fill(Qt::transparent);
+        QPainter tilePainter(&tile);
+        tilePainter.setRenderHints(painter->renderHints());
+        tilePainter.setFont(painter->font());
+        tilePainter.scale(scale, scale);
+        tilePainter.translate(-tileRect.topLeft());
+        tilePainter.setOpacity(this->opacity);
+        for (const int &index : indexes)
+            this->items.at(index)->render(&tilePainter);
+        tilePainter.end();
+    }
+    this->flattenedTiles.insert(key, new QPixmap(tile), qMax(1, static_cast<int>(Util::memoryUsage(tile) / 1024)));
+    return tile;
+}
+
+// Remove the cached tiles that overlap 'rect', so that they're rendered again when they're next painted.
+void Overlay::removeFlattenedTiles(const QRectF &rect) {
+    if (this->flattenedTiles.isEmpty())
+        return;
+
+    const QRect range = getBucketRange(rect);
+    if (static_cast<qint64>(range.width()) * range.height() > this->flattenedTiles.count()) {
+        // The area covers more tiles than are cached, it's faster to check each cached tile.
+        const QList<quint64> keys = this->flattenedTiles.keys();
+        for (const quint64 &key : keys) {
+            if (range.contains(bucketKeyX(key), bucketKeyY(key)))
+                this->flattenedTiles.remove(key);
+        }
+    } else {
+        for (int y = range.top(); y <= range.bottom(); y++)
+        for (int x = range.left(); x <= range.right(); x++) {
+            this->flattenedTiles.remove(bucketKey(x, y));
+        }
+    }
+}
+
+void Overlay::addItem(OverlayItem *item) {
+    const int index = this->items.length();
+    this->items.append(item);
+
+    const QRectF bounds = item->boundingRect();
+    const QRect range = getBucketRange(bounds);
+    if (static_cast<qint64>(range.width()) * range.height() > maxItemBuckets) {
+        this->unbucketedItems.append(index);
+    } else {
+        for (int y = range.top(); y <= range.bottom(); y++)
+        for (int x = range.left(); x <= range.right(); x++) {
+            this->buckets[bucketKey(x, y)].append(index);
+        }
+    }
+    this->itemsBoundingRect |= bounds;
+    this->dirtyRect |= bounds;
+    removeFlattenedTiles(bounds);
+}
+
 void Overlay::clearItems() {
     for (auto item : this->items) {
         delete item;
     }
     this->items.clear();
+    this->buckets.clear();
+    this->unbucketedItems.clear();
+    this->flattenedTiles.clear();
+    this->dirtyRect |= this->itemsBoundingRect;
+    this->itemsBoundingRect = QRectF();
 }
 
 QList<OverlayItem*> Overlay::getItems() {
     return this->items;
 }
 
+QList<OverlayItem*> Overlay::getItems(const QRectF &rect) const {
+    QList<OverlayItem*> result;
+    for (const int &index : getItemIndexes(rect))
+        result.append(this->items.at(index));
+    return result;
+}
+
+QRectF Overlay::getDirtySceneRect() const {
+    if (this->hidden || this->dirtyRect.isNull())
+        return QRectF();
+    QRectF rect = getTransform().mapRect(this->dirtyRect).adjusted(-1, -1, 1, 1);
+    if (this->clippingRect)
+        rect &= *this->clippingRect;
+    return rect;
+}
+
+void Overlay::setFullyDirty() {
+    this->fullyDirty = true;
+}
+
+void Overlay::clearDirty() {
+    this->fullyDirty = false;
+    this->dirtyRect = QRectF();
+}
+
 bool Overlay::getHidden() {
     return this->hidden;
 }
 
 void Overlay::setHidden(bool hidden) {
     this->hidden = hidden;
+    setFullyDirty();
 }
 
 int Overlay::getOpacity() {
@@ -73,6 +286,8 @@ void Overlay::setOpacity(int opacity) {
         return;
     }
     this->opacity = static_cast<qreal>(opacity) / 100;
+    this->flattenedTiles.clear();
+    setFullyDirty();
 }
 
 int Overlay::getX() {
@@ -85,10 +300,12 @@ int Overlay::getY() {
 
 void Overlay::setX(int x) {
     this->x = x;
+    setFullyDirty();
 }
 
 void Overlay::setY(int y) {
     this->y = y;
+    setFullyDirty();
 }
 
 qreal Overlay::getHScale() {
@@ -101,15 +318,18 @@ qreal Overlay::getVScale() {
 
 void Overlay::setHScale(qreal scale) {
     this->hScale = scale;
+    setFullyDirty();
 }
 
 void Overlay::setVScale(qreal scale) {
     this->vScale = scale;
+    setFullyDirty();
 }
 
 void Overlay::setScale(qreal hScale, qreal vScale) {
     this->hScale = hScale;
     this->vScale = vScale;
+    setFullyDirty();
 }
 
 int Overlay::getRotation() {
@@ -119,11 +339,13 @@ int Overlay::getRotation() {
 void Overlay::setRotation(int angle) {
     this->angle = angle;
     this->clampAngle();
+    setFullyDirty();
 }
 
 void Overlay::rotate(int degrees) {
     this->angle += degrees;
     this->clampAngle();
+    setFullyDirty();
 }
 
 void Overlay::clampAngle() {
@@ -139,6 +361,7 @@ void Overlay::setClippingRect(QRectF rect) {
         delete this->clippingRect;
     }
     this->clippingRect = new QRectF(rect);
+    setFullyDirty();
 }
 
 void Overlay::clearClippingRect() {
@@ -146,16 +369,19 @@ void Overlay::clearClippingRect() {
         delete this->clippingRect;
     }
     this->clippingRect = nullptr;
+    setFullyDirty();
 }
 
 void Overlay::setPosition(int x, int y) {
     this->x = x;
     this->y = y;
+    setFullyDirty();
 }
 
 void Overlay::move(int deltaX, int deltaY) {
     this->x += deltaX;
     this->y += deltaY;
+    setFullyDirty();
 }
 
 QColor Overlay::getColor(QString colorStr) {
@@ -170,7 +396,7 @@ QColor Overlay::getColor(QString colorStr) {
 }
 
 void Overlay::addText(const QString text, int x, int y, QString colorStr, int fontSize) {
-    this->items.append(new OverlayText(text, x, y, getColor(colorStr), fontSize));
+    addItem(new OverlayText(text, x, y, getColor(colorStr), fontSize));
 }
 
 bool Overlay::addRect(int x, int y, int width, int height, QString borderColorStr, QString fillColorStr, int rounding) {
@@ -181,7 +407,7 @@ bool Overlay::addRect(int x, int y, int width, int height, QString borderColorSt
 
     QPainterPath path;
     path.addRoundedRect(QRectF(x, y, width, height), rounding, rounding, Qt::RelativeSize);
-    this->items.append(new OverlayPath(path, getColor(borderColorStr), getColor(fillColorStr)));
+    addItem(new OverlayPath(path, getColor(borderColorStr), getColor(fillColorStr)));
     return true;
 }
 
@@ -198,7 +424,7 @@ bool Overlay::addPath(QList<int> xCoords, QList<int> yCoords, QString borderColo
     for (int i = 1; i < numPoints; i++)
         path.lineTo(xCoords.at(i), yCoords.at(i));
 
-    this->items.append(new OverlayPath(path, getColor(borderColorStr), getColor(fillColorStr)));
+    addItem(new OverlayPath(path, getColor(borderColorStr), getColor(fillColorStr)));
     return true;
 }
 
@@ -245,7 +471,7 @@ bool Overlay::addImage(int x, int y, QString filepath, bool useCache, int width,
     if (setTransparency)
         image.setColor(0, qRgba(0, 0, 0, 0));
 
-    this->items.append(new OverlayPixmap(x, y, QPixmap::fromImage(image)));
+    addItem(new OverlayPixmap(x, y, QPixmap::fromImage(image)));
     return true;
 }
 
@@ -254,7 +480,7 @@ bool Overlay::addImage(int x, int y, QImage image) {
         logError(QString("Failed to load custom image"));
         return false;
     }
-    this->items.append(new OverlayPixmap(x, y, QPixmap::fromImage(image)));
+    addItem(new OverlayPixmap(x, y, QPixmap::fromImage(image)));
     return true;
 }
 
@@ -96,6 +96,7 @@ void PaletteEditor::setRgb(int colorIndex, QRgb rgb) {
     Tileset *tileset = getTileset(paletteId);
     tileset->palettes[paletteId][colorIndex] = rgb;
     tileset->palettePreviews[paletteId][colorIndex] = rgb;
+    tileset->markChanged();
     emit changedPaletteColor();
 }
 
@@ -105,6 +106,7 @@ void PaletteEditor::setPalette(int paletteId, const QList<QRgb> &palette) {
         tileset->palettes[paletteId][i] = palette.value(i);
         tileset->palettePreviews[paletteId][i] = palette.value(i);
     }
+    tileset->markChanged();
     refreshColorInputs();
     emit changedPaletteColor();
 }
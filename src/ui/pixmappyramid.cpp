@@ -0,0 +1,126 @@
+#include "pixmappyramid.h"
+#include "utility.h"
+
+// The most downsampled level that can be drawn at the painter's scale without being scaled up.
+int PixmapPyramid::levelForTransform(QPainter *painter) {
+    const QTransform transform = painter->worldTransform();
+    if (transform.isRotating())
+        return 0;
+    const qreal scale = qMax(qAbs(transform.m11()), qAbs(transform.m22())) * painter->device()->devicePixelRatioF();
+    int level = 0;
+    while (level < maxLevel && scale * (1 << (level + 1)) <= 1.0001) {
+        level++;
+    }
+    return level;
+}
+
+void PixmapPyramid::setSource(const QPixmap &source) {
+    m_source = source;
+    clear();
+}
+
+void PixmapPyramid::updateSource(const QPixmap &source, const QRect &changedRect) {
+    if (source.size() != m_source.size()) {
+        setSource(source);
+        return;
+    }
+    m_source = source;
+    if (changedRect.isEmpty())
+        return;
+    for (int i = 0; i < maxLevel; i++) {
+        if (!m_levels[i].isNull())
+            m_dirtyRects[i] |= changedRect;
+    }
+}
+
+void PixmapPyramid::clear() {
+    for (int i = 0; i < maxLevel; i++) {
+        m_levels[i] = QPixmap();
+        m_dirtyRects[i] = QRect();
+    }
+}
+
+bool PixmapPyramid::isEmpty() const {
+    for (int i = 0; i < maxLevel; i++) {
+        if (!m_levels[i].isNull())
+            return false;
+    }
+    return true;
+}
+
+qint64 PixmapPyramid::memoryUsage() const {
+    qint64 size = 0;
+    for (int i = 0; i < maxLevel; i++) {
+        size += Util::memoryUsage(m_levels[i]);
+    }
+    return size;
+}
+
+int PixmapPyramid::numBuiltLevels() const {
+    int count = 0;
+    for (int i = 0; i < maxLevel; i++) {
+        if (!m_levels[i].isNull())
+            count++;
+    }
+    return count;
+}
+
+QPixmap PixmapPyramid::downsample(const QPixmap &pixmap, int level) {
+    if (pixmap.isNull() || level <= 0)
+        return pixmap;
+    const int factor = 1 << level;
+    const QSize size(qMax(1, pixmap.width() / factor), qMax(1, pixmap.height() / factor));
+    return pixmap.scaled(size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+}
+
+QPixmap PixmapPyramid::level(int level) {
+    if (level <= 0 || m_source.isNull())
+        return m_source;
+    level = qMin(level, maxLevel);
+
+    // Each level is built from the one above it.
+    const QPixmap parent = this->level(level - 1);
+    QPixmap &pixmap = m_levels[level - 1];
+    QRect &dirtyRect = m_dirtyRects[level - 1];
+    if (pixmap.isNull()) {
+        pixmap = downsample(parent, 1);
+        dirtyRect = QRect();
+        return pixmap;
+    }
+    if (dirtyRect.isNull())
+        return pixmap;
+
+    // Downsample the changed area again. It's aligned so that each pixel of this level is built from the same parent pixels as before.
+    const int factor = 1 << level;
+    const int left = (dirtyRect.left() / factor) * 2;
+    const int top = (dirtyRect.top() / factor) * 2;
+    const int right = ((dirtyRect.right() / factor) + 1) * 2;
+    const int bottom = ((dirtyRect.bottom() / factor) + 1) * 2;
+    const QRect parentRect = QRect(left, top, right - left, bottom - top) & QRect(QPoint(0, 0), pixmap.size() * 2);
+    dirtyRect = QRect();
+    if (parentRect.isEmpty())
+        return pixmap;
+
+    QPainter painter(&pixmap);
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
+    painter.drawPixmap(parentRect.topLeft() / 2, downsample(parent.copy(parentRect), 1));
+    painter.end();
+    return pixmap;
+}
+
+void PixmapPyramid::paint(QPainter *painter, const QPointF &pos, const QRectF &exposedRect, int level) {
+    const QPixmap pixmap = this->level(level);
+    if (pixmap.isNull())
+        return;
+
+    const qreal factor = m_source.width() / static_cast<qreal>(pixmap.width());
+    const QRectF sourceRect = QRectF(exposedRect.topLeft() / factor, exposedRect.size() / factor) & QRectF(pixmap.rect());
+    if (sourceRect.isEmpty())
+        return;
+
+    painter->save();
+    painter->translate(pos);
+    painter->scale(factor, m_source.height() / static_cast<qreal>(pixmap.height()));
+    painter->drawPixmap(sourceRect, pixmap, sourceRect);
+    painter->restore();
+}
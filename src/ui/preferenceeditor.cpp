@@ -92,6 +92,10 @@ void PreferenceEditor::updateFields() {
     ui->checkBox_CheckForUpdates->setChecked(porymapConfig.checkForUpdates);
     ui->checkBox_DisableEventWarning->setChecked(porymapConfig.eventDeleteWarningDisabled);
     ui->checkBox_ShowProjectLoadingScreen->setChecked(porymapConfig.showProjectLoadingScreen);
+    ui->checkBox_PreloadTilesets->setChecked(porymapConfig.preloadTilesets);
+    ui->spinBox_MapPrefetchLimit->setValue(porymapConfig.mapPrefetchLimit);
+    ui->spinBox_CacheMemoryLimit->setValue(porymapConfig.cacheMemoryLimit);
+    ui->spinBox_TilesetEditorHistoryLimit->setValue(porymapConfig.tilesetEditorHistoryLimit);
 
     if (porymapConfig.scriptAutocompleteMode == ScriptAutocompleteMode::MapOnly) {
         ui->radioButton_AutocompleteMapScripts->setChecked(true);
@@ -138,6 +142,10 @@ void PreferenceEditor::saveFields() {
     porymapConfig.checkForUpdates = ui->checkBox_CheckForUpdates->isChecked();
     porymapConfig.eventDeleteWarningDisabled = ui->checkBox_DisableEventWarning->isChecked();
     porymapConfig.showProjectLoadingScreen = ui->checkBox_ShowProjectLoadingScreen->isChecked();
+    porymapConfig.preloadTilesets = ui->checkBox_PreloadTilesets->isChecked();
+    porymapConfig.mapPrefetchLimit = ui->spinBox_MapPrefetchLimit->value();
+    porymapConfig.cacheMemoryLimit = ui->spinBox_CacheMemoryLimit->value();
+    porymapConfig.tilesetEditorHistoryLimit = ui->spinBox_TilesetEditorHistoryLimit->value();
 
     porymapConfig.statusBarLogTypes.clear();
     if (ui->checkBox_StatusErrors->isChecked()) porymapConfig.statusBarLogTypes.insert(LogType::LOG_ERROR);
@@ -0,0 +1,117 @@
+#include "projectvalidatordialog.h"
+#include "project.h"
+#include "filedialog.h"
+#include "message.h"
+
+#include <QVBoxLayout>
+#include <QDialogButtonBox>
+#include <QHeaderView>
+
+enum IssueColumn {
+    SeverityColumn,
+    SourceColumn,
+    MessageColumn,
+    FileColumn,
+};
+
+ProjectValidatorDialog::ProjectValidatorDialog(Project *project, QWidget *parent) :
+    QDialog(parent),
+    project(project),
+    validator(new ProjectValidator(project, this))
+{
+    setAttribute(Qt::WA_DeleteOnClose);
+    setWindowTitle(QStringLiteral("Validate Project"));
+    resize(900, 500);
+
+    auto layout = new QVBoxLayout(this);
+
+    this->label_Summary = new QLabel(this);
+    this->label_Summary->setWordWrap(true);
+    layout->addWidget(this->label_Summary);
+
+    this->progressBar = new QProgressBar(this);
+    layout->addWidget(this->progressBar);
+
+    this->tree_Issues = new QTreeWidget(this);
+    this->tree_Issues->setHeaderLabels({"Severity", "Source", "Message", "File"});
+    this->tree_Issues->setRootIsDecorated(false);
+    this->tree_Issues->setUniformRowHeights(true);
+    this->tree_Issues->setSortingEnabled(true);
+    this->tree_Issues->setToolTip(QStringLiteral("Double-click an issue to open its map."));
+    this->tree_Issues->header()->setSectionResizeMode(IssueColumn::MessageColumn, QHeaderView::Stretch);
+    this->tree_Issues->header()->setStretchLastSection(false);
+    layout->addWidget(this->tree_Issues);
+
+    auto buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    this->button_Run = buttonBox->addButton(QStringLiteral("Run Again"), QDialogButtonBox::ActionRole);
+    this->button_Export = buttonBox->addButton(QStringLiteral("Export..."), QDialogButtonBox::ActionRole);
+    this->button_Export->setToolTip(QStringLiteral("Save the results as a JSON file."));
+    layout->addWidget(buttonBox);
+
+    connect(buttonBox, &QDialogButtonBox::rejected, this, &ProjectValidatorDialog::close);
+    connect(this->button_Run, &QPushButton::clicked, this, &ProjectValidatorDialog::run);
+    connect(this->button_Export, &QPushButton::clicked, this, &ProjectValidatorDialog::exportResults);
+    connect(this->tree_Issues, &QTreeWidget::itemDoubleClicked, [this](QTreeWidgetItem *item) {
+        const QString mapName = item->text(IssueColumn::SourceColumn);
+        if (this->project && this->project->isKnownMap(mapName))
+            emit openMapRequested(mapName);
+    });
+
+    connect(this->validator, &ProjectValidator::progressChanged, [this](int done, int total) {
+        this->progressBar->setMaximum(total);
+        this->progressBar->setValue(done);
+    });
+    connect(this->validator, &ProjectValidator::finished, this, &ProjectValidatorDialog::displayResults);
+}
+
+void ProjectValidatorDialog::run() {
+    this->tree_Issues->clear();
+    this->label_Summary->setText(QStringLiteral("Checking project files..."));
+    this->progressBar->setValue(0);
+    this->progressBar->setVisible(true);
+    this->button_Run->setEnabled(false);
+    this->button_Export->setEnabled(false);
+    this->validator->start();
+}
+
+void ProjectValidatorDialog::displayResults() {
+    this->progressBar->setVisible(false);
+    this->button_Run->setEnabled(true);
+
+    const QList<ProjectValidator::Issue> issues = this->validator->issues();
+    QList<QTreeWidgetItem*> items;
+    for (const auto &issue : issues) {
+        auto item = new QTreeWidgetItem();
+        item->setText(IssueColumn::SeverityColumn, ProjectValidator::severityToString(issue.severity));
+        item->setText(IssueColumn::SourceColumn, issue.source);
+        item->setText(IssueColumn::MessageColumn, issue.message);
+        item->setText(IssueColumn::FileColumn, issue.file);
+        item->setToolTip(IssueColumn::MessageColumn, issue.message);
+        items.append(item);
+    }
+    this->tree_Issues->setSortingEnabled(false);
+    this->tree_Issues->addTopLevelItems(items);
+    this->tree_Issues->setSortingEnabled(true);
+    this->tree_Issues->resizeColumnToContents(IssueColumn::SeverityColumn);
+    this->tree_Issues->resizeColumnToContents(IssueColumn::SourceColumn);
+
+    this->label_Summary->setText(QString("Checked %1 maps and %2 layouts in %3 seconds. Found %4 error(s) and %5 warning(s).")
+                                    .arg(this->validator->numMapsChecked())
+                                    .arg(this->validator->numLayoutsChecked())
+                                    .arg(this->validator->elapsedMs() / 1000.0, 0, 'f', 2)
+                                    .arg(this->validator->numErrors())
+                                    .arg(this->validator->numWarnings()));
+    this->button_Export->setEnabled(true);
+}
+
+void ProjectValidatorDialog::exportResults() {
+    const QString defaultFilepath = QString("%1/validation.json").arg(FileDialog::getDirectory());
+    const QString filepath = FileDialog::getSaveFileName(this, QStringLiteral("Export Validation Results"), defaultFilepath, QStringLiteral("JSON Files (*.json)"));
+    if (filepath.isEmpty())
+        return;
+
+    QString error;
+    if (!this->validator->writeJson(filepath, &error)) {
+        ErrorMessage::show(QString("Failed to export validation results to '%1'.").arg(filepath), error, this);
+    }
+}
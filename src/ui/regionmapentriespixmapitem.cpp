@@ -21,7 +21,7 @@ void RegionMapEntriesPixmapItem::draw() {
 
     QPainter painter(&image);
     for (int i = 0; i < region_map->tilemapSize(); i++) {
-        QImage bottom_img = this->tile_selector->tileImg(region_map->getTile(i));
+        QImage bottom_img = this->tile_selector->tileImg(region_map->getTileValue(i));
         QImage top_img(this->cellWidth, this->cellHeight, QImage::Format_RGBA8888);
         int x = i % region_map->tilemapWidth();
         int y = i / region_map->tilemapWidth();
@@ -7,7 +7,7 @@ void RegionMapLayoutPixmapItem::draw() {
 
     QPainter painter(&image);
     for (int i = 0; i < region_map->tilemapSize(); i++) {
-        QImage bottom_img = this->tile_selector->tileImg(region_map->getTile(i));
+        QImage bottom_img = this->tile_selector->tileImg(region_map->getTileValue(i));
         QImage top_img(this->cellWidth, this->cellHeight, QImage::Format_RGBA8888);
         if (region_map->squareHasMap(i)) {
             top_img.fill(Qt::gray);
@@ -5,10 +5,11 @@ void RegionMapPixmapItem::draw() {
     if (!region_map) return;
 
     QImage image(region_map->pixelWidth(), region_map->pixelHeight(), QImage::Format_RGBA8888);
+    image.fill(Qt::transparent);
 
     QPainter painter(&image);
     for (int i = 0; i < region_map->tilemapSize(); i++) {
-        QImage img = this->tile_selector->tileImg(region_map->getTile(i));
+        QImage img = this->tile_selector->tileImg(region_map->getTileValue(i));
         int x = i % region_map->tilemapWidth();
         int y = i / region_map->tilemapWidth();
         QPoint pos = QPoint(x * 8, y * 8);
@@ -19,6 +20,34 @@ void RegionMapPixmapItem::draw() {
     this->setPixmap(QPixmap::fromImage(image));
 }
 
+// Redraw only the tiles at the given tilemap indexes.
+void RegionMapPixmapItem::drawTiles(const QList<int> &indexes) {
+    if (!region_map || indexes.isEmpty()) return;
+
+    QPixmap pixmap = this->pixmap();
+    if (pixmap.width() != region_map->pixelWidth() || pixmap.height() != region_map->pixelHeight()) {
+        draw();
+        return;
+    }
+
+    // Release the item's reference to the pixmap so that painting on it doesn't make a copy.
+    this->setPixmap(QPixmap());
+
+    QPainter painter(&pixmap);
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
+    for (int i : indexes) {
+        if (i < 0 || i >= region_map->tilemapSize())
+            continue;
+        QImage img = this->tile_selector->tileImg(region_map->getTileValue(i));
+        int x = i % region_map->tilemapWidth();
+        int y = i / region_map->tilemapWidth();
+        painter.drawImage(QPoint(x * 8, y * 8), img);
+    }
+    painter.end();
+
+    this->setPixmap(pixmap);
+}
+
 void RegionMapPixmapItem::paint(QGraphicsSceneMouseEvent *event) {
     if (region_map) {
         QPointF pos = event->pos();
@@ -31,36 +60,40 @@ void RegionMapPixmapItem::paint(QGraphicsSceneMouseEvent *event) {
                 this->tile_selector->tile_vFlip,
                 this->tile_selector->tile_palette
             );
-        draw();
+        drawTiles({index});
     }
 }
 
-void RegionMapPixmapItem::floodFill(int x, int y, std::shared_ptr<TilemapTile> oldTile, std::shared_ptr<TilemapTile> newTile) {
-    // out of bounds
-    if (x < 0
-     || y < 0
-     || x >= this->region_map->tilemapWidth()
-     || y >= this->region_map->tilemapHeight()) {
+void RegionMapPixmapItem::floodFill(int x, int y, unsigned oldTile, unsigned newTile) {
+    if (oldTile == newTile)
         return;
-    }
 
-    auto tile = this->region_map->getTile(x, y);
-    if (!tile->operator==(*oldTile) || tile->operator==(*newTile)) {
-        return;
-    }
+    QList<int> filledIndexes;
+    QList<QPoint> todo = { QPoint(x, y) };
+    while (!todo.isEmpty()) {
+        QPoint pos = todo.takeLast();
+
+        // out of bounds
+        if (pos.x() < 0
+         || pos.y() < 0
+         || pos.x() >= this->region_map->tilemapWidth()
+         || pos.y() >= this->region_map->tilemapHeight()) {
+            continue;
+        }
 
-    int index = x + y * this->region_map->tilemapWidth();
-    this->region_map->setTileData(index,
-        newTile->id(),
-        newTile->hFlip(),
-        newTile->vFlip(),
-        newTile->palette()
-    );
-
-    floodFill(x + 1, y, oldTile, newTile);
-    floodFill(x - 1, y, oldTile, newTile);
-    floodFill(x, y + 1, oldTile, newTile);
-    floodFill(x, y - 1, oldTile, newTile);
+        int index = pos.x() + pos.y() * this->region_map->tilemapWidth();
+        if (this->region_map->getTileValue(index) != oldTile) {
+            continue;
+        }
+        this->region_map->setTileValue(index, newTile);
+        filledIndexes.append(index);
+
+        todo.append(QPoint(pos.x() + 1, pos.y()));
+        todo.append(QPoint(pos.x() - 1, pos.y()));
+        todo.append(QPoint(pos.x(), pos.y() + 1));
+        todo.append(QPoint(pos.x(), pos.y() - 1));
+    }
+    drawTiles(filledIndexes);
 }
 
 void RegionMapPixmapItem::fill(QGraphicsSceneMouseEvent *event) {
@@ -69,33 +102,15 @@ void RegionMapPixmapItem::fill(QGraphicsSceneMouseEvent *event) {
         int x = static_cast<int>(pos.x()) / 8;
         int y = static_cast<int>(pos.y()) / 8;
         int index = x + y * this->region_map->tilemapWidth();
-        std::shared_ptr<TilemapTile> currentTile, newTile, oldTile;
-        currentTile = this->region_map->getTile(index);
-        switch(this->tile_selector->format) {
-            case TilemapFormat::Plain:
-                oldTile = std::make_shared<PlainTile>(currentTile->raw());
-                newTile = std::make_shared<PlainTile>(currentTile->raw());
-                newTile->setId(this->tile_selector->selectedTile);
-                break;
-            case TilemapFormat::BPP_4:
-                oldTile = std::make_shared<BPP4Tile>(currentTile->raw());
-                newTile = std::make_shared<BPP4Tile>(currentTile->raw());
-                newTile->setId(this->tile_selector->selectedTile);
-                newTile->setHFlip(this->tile_selector->tile_hFlip);
-                newTile->setVFlip(this->tile_selector->tile_vFlip);
-                newTile->setPalette(this->tile_selector->tile_palette);
-                break;
-            case TilemapFormat::BPP_8:
-                oldTile = std::make_shared<BPP8Tile>(currentTile->raw());
-                newTile = std::make_shared<BPP8Tile>(currentTile->raw());
-                newTile->setId(this->tile_selector->selectedTile);
-                newTile->setId(this->tile_selector->selectedTile);
-                newTile->setHFlip(this->tile_selector->tile_hFlip);
-                newTile->setVFlip(this->tile_selector->tile_vFlip);
-                break;
-        }
+        // Properties that the tilemap's format doesn't support (e.g. palettes for 8bpp tiles) are ignored by 'tileValue'.
+        unsigned oldTile = this->region_map->getTileValue(index);
+        unsigned newTile = this->region_map->tileValue(
+                this->tile_selector->selectedTile,
+                this->tile_selector->tile_hFlip,
+                this->tile_selector->tile_vFlip,
+                this->tile_selector->tile_palette
+            );
         floodFill(x, y, oldTile, newTile);
-        draw();
     }
 }
 
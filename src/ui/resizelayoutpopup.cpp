@@ -92,7 +92,7 @@ void ResizeLayoutPopup::setupLayoutView() {
     this->ui->spinBox_borderHeight->setValue(this->layout->getBorderHeight());
 
     // Layout stuff
-    this->layoutPixmap = new BoundedPixmapItem(this->layout->pixmap, Metatile::pixelSize());
+    this->layoutPixmap = new BoundedPixmapItem(this->layout->render(), Metatile::pixelSize());
     this->scene->addItem(layoutPixmap);
     int maxWidth = this->project->getMaxMapWidth();
     int maxHeight = this->project->getMaxMapHeight();
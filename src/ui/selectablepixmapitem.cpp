@@ -115,27 +115,34 @@ void SelectablePixmapItem::drawSelectionRect(const QPoint &origin, const QSize &
     if (!selectionRect.intersects(pixmap.rect()))
         return;
 
+    QPainter painter(&pixmap);
+    paintSelectionRect(&painter, selectionRect, style);
+    painter.end();
+
+    this->setPixmap(pixmap);
+}
+
+void SelectablePixmapItem::paintSelectionRect(QPainter *painter, const QRect &selectionRect, Qt::PenStyle style) {
     auto fillPen = QPen(QColor(Qt::white));
     auto borderPen = QPen(QColor(Qt::black));
     borderPen.setStyle(style);
 
-    QPainter painter(&pixmap);
+    painter->save();
     if (style == Qt::SolidLine) {
-        painter.setPen(fillPen);
-        painter.drawRect(selectionRect - QMargins(1,1,1,1));
-        painter.setPen(borderPen);
-        painter.drawRect(selectionRect);
-        painter.drawRect(selectionRect - QMargins(2,2,2,2));
+        painter->setPen(fillPen);
+        painter->drawRect(selectionRect - QMargins(1,1,1,1));
+        painter->setPen(borderPen);
+        painter->drawRect(selectionRect);
+        painter->drawRect(selectionRect - QMargins(2,2,2,2));
     } else {
         // Having separately sized rectangles with anything but a
         // solid line looks a little wonky because the dashes wont align.
         // For non-solid styles we'll draw a base white rectangle, then draw
         // a styled black rectangle on top
-        painter.setPen(fillPen);
-        painter.drawRect(selectionRect);
-        painter.setPen(borderPen);
-        painter.drawRect(selectionRect);
+        painter->setPen(fillPen);
+        painter->drawRect(selectionRect);
+        painter->setPen(borderPen);
+        painter->drawRect(selectionRect);
     }
-
-    this->setPixmap(pixmap);
+    painter->restore();
 }
@@ -85,11 +85,29 @@ QImage TilemapTileSelector::setPalette(int paletteIndex) {
     return tilesetImage;
 }
 
+QImage TilemapTileSelector::getPalettedTileset(int paletteIndex) {
+    auto it = this->palettedTilesetCache.constFind(paletteIndex);
+    if (it != this->palettedTilesetCache.constEnd())
+        return it.value();
+
+    QImage tilesetImage = setPalette(paletteIndex);
+    this->palettedTilesetCache.insert(paletteIndex, tilesetImage);
+    return tilesetImage;
+}
+
 QImage TilemapTileSelector::tileImg(shared_ptr<TilemapTile> tile) {
-    unsigned tileId = tile->id();
-    QPoint pos = getTileIdCoords(tileId);
+    return tile ? tileImg(tile->raw()) : QImage();
+}
+
+QImage TilemapTileSelector::tileImg(unsigned raw) {
+    auto it = this->tileImageCache.constFind(raw);
+    if (it != this->tileImageCache.constEnd())
+        return it.value();
+
+    auto tile = makeTilemapTile(this->format, raw);
+    QPoint pos = getTileIdCoords(tile->id());
 
-    QImage tilesetImage = setPalette(tile->palette());
+    QImage tilesetImage = getPalettedTileset(tile->palette());
 
     // take a tile from the tileset
     QImage img = tilesetImage.copy(pos.x() * this->cellWidth, pos.y() * this->cellHeight, this->cellWidth, this->cellHeight);
@@ -101,6 +119,7 @@ QImage TilemapTileSelector::tileImg(shared_ptr<TilemapTile> tile) {
     img = img.mirrored(tile->hFlip(), tile->vFlip());
 #endif
 
+    this->tileImageCache.insert(raw, img);
     return img;
 }
 
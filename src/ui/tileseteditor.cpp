@@ -15,6 +15,99 @@
 #include <QDialogButtonBox>
 #include <QCloseEvent>
 #include <QImageReader>
+#include <algorithm>
+
+MetatileHistoryItem::MetatileHistoryItem(uint16_t metatileId, const Metatile &prevMetatile, const Metatile &newMetatile, const QString &prevLabel, const QString &newLabel) {
+    this->metatileId = metatileId;
+    this->prevNumTiles = prevMetatile.tiles.length();
+    this->newNumTiles = newMetatile.tiles.length();
+
+    const int numTiles = qMax(this->prevNumTiles, this->newNumTiles);
+    for (int i = 0; i < numTiles; i++) {
+        const Tile prev = prevMetatile.tiles.value(i);
+        const Tile next = newMetatile.tiles.value(i);
+        if (prev != next)
+            this->tileChanges.append(TileChange{i, prev, next});
+    }
+
+    for (int i = Metatile::Attr::Behavior; i <= Metatile::Attr::Unused; i++) {
+        const auto attr = static_cast<Metatile::Attr>(i);
+        const uint32_t prev = prevMetatile.getAttribute(attr);
+        const uint32_t next = newMetatile.getAttribute(attr);
+        if (prev != next)
+            this->attributeChanges.append(AttributeChange{attr, prev, next});
+    }
+
+    if (prevLabel != newLabel) {
+        this->labelChanged = true;
+        this->prevLabel = prevLabel;
+        this->newLabel = newLabel;
+    }
+}
+
+// Combines the changes from a later edit to the same metatile into this one.
+bool MetatileHistoryItem::merge(const MetatileHistoryItem &other) {
+    if (this->isSwap || other.isSwap || this->metatileId != other.metatileId)
+        return false;
+
+    for (const auto &change : other.tileChanges) {
+        auto it = std::find_if(this->tileChanges.begin(), this->tileChanges.end(),
+                               [&change](const TileChange &c) { return c.index == change.index; });
+        if (it != this->tileChanges.end()) {
+            it->next = change.next;
+        } else {
+            this->tileChanges.append(change);
+        }
+    }
+    this->tileChanges.erase(std::remove_if(this->tileChanges.begin(), this->tileChanges.end(),
+                                           [](const TileChange &c) { return c.prev == c.next; }),
+                            this->tileChanges.end());
+
+    for (const auto &change : other.attributeChanges) {
+        auto it = std::find_if(this->attributeChanges.begin(), this->attributeChanges.end(),
+                               [&change](const AttributeChange &c) { return c.attr == change.attr; });
+        if (it != this->attributeChanges.end()) {
+            it->next = change.next;
+        } else {
+            this->attributeChanges.append(change);
+        }
+    }
+    this->attributeChanges.erase(std::remove_if(this->attributeChanges.begin(), this->attributeChanges.end(),
+                                                [](const AttributeChange &c) { return c.prev == c.next; }),
+                                 this->attributeChanges.end());
+
+    if (other.labelChanged) {
+        if (!this->labelChanged)
+            this->prevLabel = other.prevLabel;
+        this->newLabel = other.newLabel;
+        this->labelChanged = (this->prevLabel != this->newLabel);
+    }
+    this->newNumTiles = other.newNumTiles;
+    return true;
+}
+
+void MetatileHistoryItem::apply(Metatile *metatile, bool undo) const {
+    const int numTiles = undo ? this->prevNumTiles : this->newNumTiles;
+    while (metatile->tiles.length() < numTiles)
+        metatile->tiles.append(Tile());
+    while (metatile->tiles.length() > numTiles)
+        metatile->tiles.removeLast();
+
+    for (const auto &change : this->tileChanges) {
+        if (change.index < metatile->tiles.length())
+            metatile->tiles[change.index] = undo ? change.prev : change.next;
+    }
+    for (const auto &change : this->attributeChanges) {
+        metatile->setAttribute(change.attr, undo ? change.prev : change.next);
+    }
+}
+
+qint64 MetatileHistoryItem::memoryUsage() const {
+    return sizeof(MetatileHistoryItem)
+         + this->tileChanges.size() * sizeof(TileChange)
+         + this->attributeChanges.size() * sizeof(AttributeChange)
+         + (this->prevLabel.size() + this->newLabel.size()) * sizeof(QChar);
+}
 
 TilesetEditor::TilesetEditor(Project *project, Layout *layout, QWidget *parent) :
     QMainWindow(parent),
@@ -535,7 +628,7 @@ void TilesetEditor::paintSelectedLayerTiles(const QPoint &pos, bool paletteOnly)
     if (!this->metatile) return;
 
     bool changed = false;
-    Metatile *prevMetatile = new Metatile(*this->metatile);
+    const Metatile prevMetatile = *this->metatile;
     QSize dimensions = this->tileSelector->getSelectionDimensions();
     QList<Tile> tiles = this->tileSelector->getSelectedTiles();
     int srcTileIndex = 0;
@@ -563,16 +656,14 @@ void TilesetEditor::paintSelectedLayerTiles(const QPoint &pos, bool paletteOnly)
             changed = true;
         }
     }
-    if (!changed) {
-        delete prevMetatile;
+    if (!changed)
         return;
-    }
 
     this->metatileSelector->drawSelectedMetatile();
     this->metatileLayersItem->draw();
     updateLayerTileStatus();
     this->tileSelector->draw();
-    this->commitMetatileChange(prevMetatile);
+    this->commitMetatileChange(prevMetatile, true);
 }
 
 void TilesetEditor::onMetatileLayerSelectionChanged(const QPoint &selectionOrigin, const QSize &size) {
@@ -627,23 +718,24 @@ void TilesetEditor::commitMetatileLabel() {
     QString oldLabel = Tileset::getOwnedMetatileLabel(metatileId, this->primaryTileset, this->secondaryTileset);
     QString newLabel = this->ui->lineEdit_MetatileLabel->text();
     if (oldLabel != newLabel) {
-        Metatile *prevMetatile = new Metatile(*this->metatile);
         Tileset::setMetatileLabel(metatileId, newLabel, this->primaryTileset, this->secondaryTileset);
-        this->commitMetatileAndLabelChange(prevMetatile, oldLabel);
+        this->commitMetatileAndLabelChange(*this->metatile, oldLabel);
     }
 }
 
-void TilesetEditor::commitMetatileAndLabelChange(Metatile * prevMetatile, QString prevLabel) {
+void TilesetEditor::commitMetatileAndLabelChange(const Metatile &prevMetatile, QString prevLabel, bool isLayerPaint) {
     if (!this->metatile) return;
 
-    commit(new MetatileHistoryItem(this->getSelectedMetatileId(),
-                                    prevMetatile, new Metatile(*this->metatile),
-                                    prevLabel, this->ui->lineEdit_MetatileLabel->text()));
+    auto item = new MetatileHistoryItem(this->getSelectedMetatileId(),
+                                        prevMetatile, *this->metatile,
+                                        prevLabel, this->ui->lineEdit_MetatileLabel->text());
+    item->isLayerPaint = isLayerPaint;
+    commit(item);
 }
 
-void TilesetEditor::commitMetatileChange(Metatile * prevMetatile)
+void TilesetEditor::commitMetatileChange(const Metatile &prevMetatile, bool isLayerPaint)
 {
-    this->commitMetatileAndLabelChange(prevMetatile, this->ui->lineEdit_MetatileLabel->text());
+    this->commitMetatileAndLabelChange(prevMetatile, this->ui->lineEdit_MetatileLabel->text(), isLayerPaint);
 }
 
 uint32_t TilesetEditor::attributeNameToValue(Metatile::Attr attribute, const QString &text, bool *ok) {
@@ -674,7 +766,7 @@ void TilesetEditor::commitAttributeFromComboBox(Metatile::Attr attribute, NoScro
     bool ok;
     uint32_t newValue = this->attributeNameToValue(attribute, combo->currentText(), &ok);
     if (ok && newValue != this->metatile->getAttribute(attribute)) {
-        Metatile *prevMetatile = new Metatile(*this->metatile);
+        const Metatile prevMetatile = *this->metatile;
         this->metatile->setAttribute(attribute, newValue);
         this->commitMetatileChange(prevMetatile);
 
@@ -694,7 +786,7 @@ void TilesetEditor::onRawAttributesEdited() {
 
     uint32_t newAttributes = ui->spinBox_RawAttributesValue->value();
      if (newAttributes != this->metatile->getAttributes()) {
-        Metatile *prevMetatile = new Metatile(*this->metatile);
+        const Metatile prevMetatile = *this->metatile;
         this->metatile->setAttributes(newAttributes);
         this->commitMetatileChange(prevMetatile);
     }
@@ -940,14 +1032,16 @@ bool TilesetEditor::replaceMetatile(uint16_t metatileId, const Metatile &src, QS
 
     // Update tile usage if any tiles changed
     if (this->tileSelector && this->tileSelector->showUnused) {
+        bool tilesChanged = false;
         int numTiles = projectConfig.getNumTilesInMetatile();
         for (int i = 0; i < numTiles; i++) {
             if (src.tiles[i].tileId != dest->tiles[i].tileId) {
                 this->tileSelector->usedTiles[src.tiles[i].tileId] += 1;
                 this->tileSelector->usedTiles[dest->tiles[i].tileId] -= 1;
+                tilesChanged = true;
             }
         }
-        this->tileSelector->draw();
+        if (tilesChanged) this->tileSelector->draw();
     }
 
     this->metatile = dest;
@@ -962,16 +1056,60 @@ bool TilesetEditor::replaceMetatile(uint16_t metatileId, const Metatile &src, QS
 
 void TilesetEditor::initMetatileHistory() {
     this->metatileHistory.clear();
+    this->metatileHistorySize = 0;
+    this->lastLayerPaintTimer.invalidate();
     updateEditHistoryActions();
     this->hasUnsavedChanges = false;
 }
 
 void TilesetEditor::commit(MetatileHistoryItem *item) {
-    this->metatileHistory.push(item);
+    // Painting in the metatile layers view creates an edit for every tile painted.
+    // Consecutive paint strokes on the same metatile are merged into one edit, as long as they're close together in time.
+    static const qint64 layerPaintMergeInterval = 1000;
+    const bool canMerge = item->isLayerPaint
+                       && this->lastLayerPaintTimer.isValid()
+                       && this->lastLayerPaintTimer.elapsed() < layerPaintMergeInterval
+                       && !this->metatileHistory.canRedo()
+                       && !this->metatileHistory.isSaved();
+    MetatileHistoryItem *head = this->metatileHistory.current();
+    const qint64 headSize = head ? head->memoryUsage() : 0;
+    if (canMerge && head && head->merge(*item)) {
+        delete item;
+        item = head;
+        this->metatileHistorySize += head->memoryUsage() - headSize;
+    } else {
+        // Pushing discards any edits that were undone.
+        for (int i = this->metatileHistory.index() + 1; i < this->metatileHistory.length(); i++) {
+            this->metatileHistorySize -= this->metatileHistory.at(i)->memoryUsage();
+        }
+        this->metatileHistory.push(item);
+        this->metatileHistorySize += item->memoryUsage();
+    }
+
+    if (item->isLayerPaint) {
+        this->lastLayerPaintTimer.start();
+    } else {
+        this->lastLayerPaintTimer.invalidate();
+    }
+
+    enforceMetatileHistoryLimit();
     updateEditHistoryActions();
     this->hasUnsavedChanges = true;
 }
 
+// Discard the oldest edits if the edit history is using more memory than the user's limit.
+void TilesetEditor::enforceMetatileHistoryLimit() {
+    if (porymapConfig.tilesetEditorHistoryLimit <= 0)
+        return;
+    const qint64 limit = static_cast<qint64>(porymapConfig.tilesetEditorHistoryLimit) * 1024 * 1024;
+
+    // Always keep the most recent edit, so it can be undone.
+    while (this->metatileHistorySize > limit && this->metatileHistory.index() > 0) {
+        this->metatileHistorySize -= this->metatileHistory.at(0)->memoryUsage();
+        this->metatileHistory.removeOldest();
+    }
+}
+
 void TilesetEditor::updateEditHistoryActions() {
     ui->actionUndo->setEnabled(this->metatileHistory.canUndo());
     ui->actionRedo->setEnabled(this->metatileHistory.canRedo());
@@ -981,27 +1119,46 @@ void TilesetEditor::on_actionUndo_triggered() {
     MetatileHistoryItem *commit = this->metatileHistory.current();
     if (!commit) return;
     this->metatileHistory.back();
+    this->lastLayerPaintTimer.invalidate();
 
     if (commit->isSwap) {
         swapMetatiles(commit->swapMetatileId, commit->metatileId);
-    } else if (commit->prevMetatile) {
-        replaceMetatile(commit->metatileId, *commit->prevMetatile, commit->prevLabel);
-    };
+    } else {
+        applyMetatileHistoryItem(commit, true);
+    }
     updateEditHistoryActions();
 }
 
 void TilesetEditor::on_actionRedo_triggered() {
     MetatileHistoryItem *commit = this->metatileHistory.next();
     if (!commit) return;
+    this->lastLayerPaintTimer.invalidate();
 
     if (commit->isSwap) {
         swapMetatiles(commit->metatileId, commit->swapMetatileId);
-    } else if (commit->newMetatile) {
-        replaceMetatile(commit->metatileId, *commit->newMetatile, commit->newLabel);
+    } else {
+        applyMetatileHistoryItem(commit, false);
     }
     updateEditHistoryActions();
 }
 
+// Reverts or reapplies the changes in the given history item. Only the affected metatile is redrawn.
+void TilesetEditor::applyMetatileHistoryItem(const MetatileHistoryItem *item, bool undo) {
+    const Metatile *current = Tileset::getMetatile(item->metatileId, this->primaryTileset, this->secondaryTileset);
+    if (!current) return;
+
+    Metatile metatile = *current;
+    item->apply(&metatile, undo);
+
+    QString label;
+    if (item->labelChanged) {
+        label = undo ? item->prevLabel : item->newLabel;
+    } else {
+        label = Tileset::getOwnedMetatileLabel(item->metatileId, this->primaryTileset, this->secondaryTileset);
+    }
+    replaceMetatile(item->metatileId, metatile, label);
+}
+
 void TilesetEditor::on_actionCut_triggered()
 {
     this->copyMetatile(true);
@@ -1039,14 +1196,12 @@ void TilesetEditor::copyMetatile(bool cut) {
 void TilesetEditor::pasteMetatile(const Metatile &toPaste, QString newLabel) {
     if (!this->metatile) return;
 
-    Metatile *prevMetatile = new Metatile(*this->metatile);
+    const Metatile prevMetatile = *this->metatile;
     QString prevLabel = this->ui->lineEdit_MetatileLabel->text();
     if (newLabel.isNull()) newLabel = prevLabel; // Don't change the label if one wasn't copied
     uint16_t metatileId = this->getSelectedMetatileId();
-    if (!this->replaceMetatile(metatileId, toPaste, newLabel)) {
-        delete prevMetatile;
+    if (!this->replaceMetatile(metatileId, toPaste, newLabel))
         return;
-    }
 
     this->commitMetatileAndLabelChange(prevMetatile, prevLabel);
 }
@@ -1140,9 +1295,8 @@ void TilesetEditor::importAdvanceMapMetatiles(Tileset *tileset) {
 
         uint16_t metatileId = static_cast<uint16_t>(metatileIdBase + i);
         QString prevLabel = Tileset::getOwnedMetatileLabel(metatileId, this->primaryTileset, this->secondaryTileset);
-        Metatile *prevMetatile = new Metatile(*tileset->metatileAt(i));
         commit(new MetatileHistoryItem(metatileId,
-                                       prevMetatile, new Metatile(*metatiles.at(i)),
+                                       *tileset->metatileAt(i), *metatiles.at(i),
                                        prevLabel, prevLabel));
     }
 
@@ -2,6 +2,7 @@
 #include "imageproviders.h"
 #include "project.h"
 #include <QPainter>
+#include <QStyleOptionGraphicsItem>
 
 // TODO: This class has a decent bit of overlap with the MetatileSelector class.
 //       They should be refactored to inherit from a single parent class.
@@ -13,6 +14,7 @@ TilesetEditorMetatileSelector::TilesetEditorMetatileSelector(int numMetatilesWid
     this->secondaryTileset = secondaryTileset;
     this->layout = layout;
     setAcceptHoverEvents(true);
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
     this->usedMetatiles.resize(Project::getNumMetatilesTotal());
 }
 
@@ -35,13 +37,18 @@ int TilesetEditorMetatileSelector::numPrimaryMetatilesRounded() const {
     return Util::roundUpToMultiple(this->primaryTileset->numMetatiles(), this->numMetatilesWide);
 }
 
+// Redraw a single metatile's cell on the sheet, rather than rebuilding the whole sheet.
 void TilesetEditorMetatileSelector::drawMetatile(uint16_t metatileId) {
     bool ok;
     QPoint pos = metatileIdToPos(metatileId, &ok);
     if (!ok)
         return;
 
-    QPainter painter(&this->baseImage);
+    if (this->basePixmap.isNull()) {
+        draw();
+        return;
+    }
+
     QImage metatile_image = getMetatileImage(
                 metatileId,
                 this->primaryTileset,
@@ -50,11 +57,19 @@ void TilesetEditorMetatileSelector::drawMetatile(uint16_t metatileId) {
                 this->layout->metatileLayerOpacity(),
                 true)
             .scaled(this->cellWidth, this->cellHeight);
-    painter.drawImage(QPoint(pos.x() * this->cellWidth, pos.y() * this->cellHeight), metatile_image);
+
+    // Release the item's reference to the pixmap so that painting on it doesn't make a copy.
+    this->setPixmap(QPixmap());
+
+    const QRect cell(pos.x() * this->cellWidth, pos.y() * this->cellHeight, this->cellWidth, this->cellHeight);
+    QPainter painter(&this->basePixmap);
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
+    painter.fillRect(cell, getInvalidImageColor());
+    painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+    painter.drawImage(cell.topLeft(), metatile_image);
     painter.end();
 
-    this->basePixmap = QPixmap::fromImage(this->baseImage);
-    draw();
+    this->setPixmap(this->basePixmap);
 }
 
 void TilesetEditorMetatileSelector::drawSelectedMetatile() {
@@ -62,25 +77,35 @@ void TilesetEditorMetatileSelector::drawSelectedMetatile() {
 }
 
 void TilesetEditorMetatileSelector::updateBasePixmap() {
-    this->baseImage = getMetatileSheetImage(this->primaryTileset,
-                                            this->secondaryTileset,
-                                            this->numMetatilesWide,
-                                            this->layout->metatileLayerOrder(),
-                                            this->layout->metatileLayerOpacity(),
-                                            QSize(this->cellWidth, this->cellHeight),
-                                            true);
-    this->basePixmap = QPixmap::fromImage(this->baseImage);
+    this->basePixmap = QPixmap::fromImage(getMetatileSheetImage(this->primaryTileset,
+                                                                this->secondaryTileset,
+                                                                this->numMetatilesWide,
+                                                                this->layout->metatileLayerOrder(),
+                                                                this->layout->metatileLayerOpacity(),
+                                                                QSize(this->cellWidth, this->cellHeight),
+                                                                true));
+
+    // The overlays depend on the size of the sheet and on which metatiles exist.
+    clearLayers();
+}
+
+void TilesetEditorMetatileSelector::clearLayers() {
+    this->gridLayer = QPixmap();
+    this->unusedLayer = QPixmap();
+    this->countsLayer = QPixmap();
 }
 
+// Overlays and the selection are drawn in paint(). This only updates what's out of date.
 void TilesetEditorMetatileSelector::draw() {
     if (this->basePixmap.isNull())
         updateBasePixmap();
-    setPixmap(this->basePixmap);
+    if (this->pixmap().cacheKey() != this->basePixmap.cacheKey())
+        setPixmap(this->basePixmap);
 
     drawGrid();
-    drawDivider();
     drawFilters();
 
+    this->selectionRects.clear();
     if (this->inSwapMode) {
         QSet<uint16_t> metatileIds(this->swapMetatileIds.constBegin(), this->swapMetatileIds.constEnd());
         metatileIds.insert(this->lastHoveredMetatileId);
@@ -92,6 +117,38 @@ void TilesetEditorMetatileSelector::draw() {
     } else if (isValidMetatileId(this->selectedMetatileId)) {
         drawSelection();
     }
+    update();
+}
+
+void TilesetEditorMetatileSelector::drawSelectionRect(const QPoint &origin, const QSize &dimensions, Qt::PenStyle style) {
+    QRect rect(origin.x() * this->cellWidth, origin.y() * this->cellHeight, dimensions.width() * this->cellWidth, dimensions.height() * this->cellHeight);
+
+    // If a selection is fully outside the bounds of the selectable area, don't draw anything.
+    if (rect.intersects(this->basePixmap.rect()))
+        this->selectionRects.append(SelectionRect{rect, style});
+}
+
+void TilesetEditorMetatileSelector::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) {
+    QGraphicsPixmapItem::paint(painter, option, widget);
+
+    // Only compose the part of each layer that needs repainting.
+    const QRect exposedRect = option->exposedRect.toAlignedRect() & this->basePixmap.rect();
+    auto drawLayer = [painter, exposedRect](const QPixmap &layer) {
+        if (!layer.isNull())
+            painter->drawPixmap(exposedRect, layer, exposedRect);
+    };
+    if (this->showGrid)
+        drawLayer(this->gridLayer);
+    if (this->showDivider)
+        drawDivider(painter);
+    if (this->selectorShowUnused)
+        drawLayer(this->unusedLayer);
+    if (this->selectorShowCounts)
+        drawLayer(this->countsLayer);
+
+    for (const auto &selection : this->selectionRects) {
+        paintSelectionRect(painter, selection.rect, selection.style);
+    }
 }
 
 bool TilesetEditorMetatileSelector::select(uint16_t metatileId) {
@@ -269,11 +326,12 @@ QPoint TilesetEditorMetatileSelector::getMetatileIdCoordsOnWidget(uint16_t metat
 }
 
 void TilesetEditorMetatileSelector::drawGrid() {
-    if (!this->showGrid)
+    if (!this->showGrid || !this->gridLayer.isNull())
         return;
 
-    QPixmap pixmap = this->pixmap();
-    QPainter painter(&pixmap);
+    this->gridLayer = QPixmap(this->basePixmap.size());
+    this->gridLayer.fill(Qt::transparent);
+    QPainter painter(&this->gridLayer);
     const int numColumns = this->numMetatilesWide;
     const int numRows = this->numRows();
     for (int column = 1; column < numColumns; column++) {
@@ -285,28 +343,31 @@ void TilesetEditorMetatileSelector::drawGrid() {
         painter.drawLine(0, y, numColumns * this->cellWidth, y);
     }
     painter.end();
-    this->setPixmap(pixmap);
 }
 
-void TilesetEditorMetatileSelector::drawDivider() {
-    if (!this->showDivider)
-        return;
-
+void TilesetEditorMetatileSelector::drawDivider(QPainter *painter) const {
     const int y = this->numRows(this->numPrimaryMetatilesRounded()) * this->cellHeight;
 
-    QPixmap pixmap = this->pixmap();
-    QPainter painter(&pixmap);
-    painter.setPen(Qt::white);
-    painter.drawLine(0, y, this->numMetatilesWide * this->cellWidth, y);
-    painter.end();
-    this->setPixmap(pixmap);
+    painter->save();
+    painter->setPen(Qt::white);
+    painter->drawLine(0, y, this->numMetatilesWide * this->cellWidth, y);
+    painter->restore();
 }
 
 void TilesetEditorMetatileSelector::drawFilters() {
-    if (selectorShowUnused) {
+    if (!selectorShowUnused && !selectorShowCounts)
+        return;
+
+    // The usage counts are updated by the Tileset Editor, so check whether they changed since the layers were drawn.
+    if (this->layerUsage != this->usedMetatiles) {
+        this->layerUsage = this->usedMetatiles;
+        this->unusedLayer = QPixmap();
+        this->countsLayer = QPixmap();
+    }
+    if (selectorShowUnused && this->unusedLayer.isNull()) {
         drawUnused();
     }
-    if (selectorShowCounts) {
+    if (selectorShowCounts && this->countsLayer.isNull()) {
         drawCounts();
     }
 }
@@ -343,9 +404,10 @@ void TilesetEditorMetatileSelector::drawUnused() {
     oPainter.end();
 
     // draw symbol on unused metatiles
-    QPixmap metatilesPixmap = this->pixmap();
+    this->unusedLayer = QPixmap(this->basePixmap.size());
+    this->unusedLayer.fill(Qt::transparent);
 
-    QPainter unusedPainter(&metatilesPixmap);
+    QPainter unusedPainter(&this->unusedLayer);
     unusedPainter.setOpacity(0.5);
 
     for (int metatileId = 0; metatileId < this->usedMetatiles.size(); metatileId++) {
@@ -356,8 +418,6 @@ void TilesetEditorMetatileSelector::drawUnused() {
         unusedPainter.drawPixmap(pos.x(), pos.y(), redX);
     }
     unusedPainter.end();
-
-    this->setPixmap(metatilesPixmap);
 }
 
 void TilesetEditorMetatileSelector::drawCounts() {
@@ -366,8 +426,9 @@ void TilesetEditorMetatileSelector::drawCounts() {
     QPen whitePen(Qt::white);
     whitePen.setWidth(1);
 
-    QPixmap metatilesPixmap = this->pixmap();
-    QPainter countPainter(&metatilesPixmap);
+    this->countsLayer = QPixmap(this->basePixmap.size());
+    this->countsLayer.fill(Qt::transparent);
+    QPainter countPainter(&this->countsLayer);
 
     for (int metatileId = 0; metatileId < this->usedMetatiles.size(); metatileId++) {
         if (!Tileset::metatileIsValid(metatileId, this->primaryTileset, this->secondaryTileset))
@@ -386,8 +447,6 @@ void TilesetEditorMetatileSelector::drawCounts() {
         countPainter.drawText(pos.x() + 1, pos.y() - 1, countText);
     }
     countPainter.end();
-
-    this->setPixmap(metatilesPixmap);
 }
 
 void TilesetEditorMetatileSelector::setSwapMode(bool enabled) {
@@ -21,6 +21,8 @@ WildMonSearch::WildMonSearch(Project *project, QWidget *parent) :
     setAttribute(Qt::WA_DeleteOnClose);
     ui->setupUi(this);
 
+    project->preloadSpeciesIcons();
+
     // Set up species combo box
     ui->comboBox_Search->addItems(project->speciesNames);
     ui->comboBox_Search->setCurrentText(QString());
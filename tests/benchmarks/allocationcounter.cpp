@@ -0,0 +1,60 @@
+#include "allocationcounter.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib> // Defines __GLIBC__ when building against glibc
+
+static std::atomic<quint64> s_count(0);
+static std::atomic<quint64> s_bytes(0);
+
+static inline void recordAllocation(size_t size) {
+    s_count.fetch_add(1, std::memory_order_relaxed);
+    s_bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+// Only glibc exports its allocator under internal names that the replacements can forward to.
+// Other C libraries (e.g. musl, or the Windows and macOS runtimes) fall back to not counting allocations.
+#if defined(__GLIBC__)
+
+// glibc exports its allocator under these names, so the replacements below can forward to it.
+// The replacements must not allocate, and must be safe to call before any static initialization has run.
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+
+void *malloc(size_t size) {
+    recordAllocation(size);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) {
+    recordAllocation(count * size);
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+    recordAllocation(size);
+    return __libc_realloc(ptr, size);
+}
+}
+
+bool AllocationCounter::isSupported() {
+    return true;
+}
+
+#else
+
+bool AllocationCounter::isSupported() {
+    return false;
+}
+
+#endif
+
+quint64 AllocationCounter::count() {
+    return s_count.load(std::memory_order_relaxed);
+}
+
+quint64 AllocationCounter::bytes() {
+    return s_bytes.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,20 @@
+#pragma once
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+#include <QtGlobal>
+
+/*
+    Counts the heap allocations made by the process, so that benchmarks can report allocations per operation.
+
+    Allocations are counted by replacing malloc, calloc, and realloc, which every allocation in the process goes through
+    (including operator new and Qt's containers). This is only possible with glibc (i.e. on most Linux systems). Elsewhere, 'isSupported' returns false
+    and the counts are always 0. Allocations made by any thread are counted, including Porymap's background loading.
+*/
+namespace AllocationCounter {
+    bool isSupported();
+    quint64 count();
+    quint64 bytes();
+}
+
+#endif // ALLOCATIONCOUNTER_H
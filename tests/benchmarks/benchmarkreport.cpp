@@ -0,0 +1,90 @@
+#include "benchmarkreport.h"
+#include "allocationcounter.h"
+
+#include <QtTest>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSysInfo>
+
+BenchmarkReport &BenchmarkReport::instance() {
+    static BenchmarkReport report;
+    return report;
+}
+
+void BenchmarkReport::addSample(qint64 operations, qint64 nsecs, quint64 allocations, quint64 bytesAllocated) {
+    const QString function = QTest::currentTestFunction();
+    const QString dataTag = QTest::currentDataTag();
+
+    Result *result = nullptr;
+    for (auto &existing : m_results) {
+        if (existing.function == function && existing.dataTag == dataTag) {
+            result = &existing;
+            break;
+        }
+    }
+    if (!result) {
+        m_results.append(Result{function, dataTag});
+        result = &m_results.last();
+    }
+    result->operations += operations;
+    result->nsecs += nsecs;
+    result->allocations += allocations;
+    result->bytesAllocated += bytesAllocated;
+}
+
+QJsonObject BenchmarkReport::toJson() const {
+    QJsonArray results;
+    for (const auto &result : m_results) {
+        const double operations = qMax(static_cast<qint64>(1), result.operations);
+        QJsonObject obj;
+        obj["name"] = result.dataTag.isEmpty() ? result.function : QString("%1:%2").arg(result.function).arg(result.dataTag);
+        obj["function"] = result.function;
+        obj["dataTag"] = result.dataTag;
+        obj["operations"] = result.operations;
+        obj["totalNsecs"] = result.nsecs;
+        obj["nsecsPerOperation"] = result.nsecs / operations;
+        if (AllocationCounter::isSupported()) {
+            obj["allocationsPerOperation"] = result.allocations / operations;
+            obj["bytesAllocatedPerOperation"] = result.bytesAllocated / operations;
+        }
+        results.append(obj);
+    }
+
+    QJsonObject root;
+    root["porymapVersion"] = QStringLiteral(PORYMAP_VERSION);
+    root["commit"] = QStringLiteral(PORYMAP_LATEST_COMMIT);
+    root["qtVersion"] = QString(qVersion());
+    root["platform"] = QSysInfo::prettyProductName();
+    root["cpuArchitecture"] = QSysInfo::currentCpuArchitecture();
+    root["countsAllocations"] = AllocationCounter::isSupported();
+    root["fixture"] = m_fixture;
+    root["results"] = results;
+    return root;
+}
+
+bool BenchmarkReport::write(const QString &filepath, QString *error) const {
+    QFile file(filepath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        if (error) *error = file.errorString();
+        return false;
+    }
+    file.write(QJsonDocument(toJson()).toJson());
+    return true;
+}
+
+BenchmarkSample::BenchmarkSample(qint64 operations)
+  : m_operations(operations),
+    m_allocations(AllocationCounter::count()),
+    m_bytesAllocated(AllocationCounter::bytes())
+{
+    m_timer.start();
+}
+
+BenchmarkSample::~BenchmarkSample() {
+    const qint64 nsecs = m_timer.nsecsElapsed();
+    BenchmarkReport::instance().addSample(m_operations,
+                                          nsecs,
+                                          AllocationCounter::count() - m_allocations,
+                                          AllocationCounter::bytes() - m_bytesAllocated);
+}
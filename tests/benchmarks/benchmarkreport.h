@@ -0,0 +1,55 @@
+#pragma once
+#ifndef BENCHMARKREPORT_H
+#define BENCHMARKREPORT_H
+
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+
+/*
+    Collects the time and allocations of each benchmark, and writes them as JSON so that results can be compared between builds.
+
+    Qt Test's own benchmark output only reports time, so each benchmark also measures the passes of its QBENCHMARK loop
+    with a BenchmarkSample. Results are keyed by the test function and data tag that were running when they were added.
+*/
+class BenchmarkReport
+{
+public:
+    struct Result {
+        QString function;
+        QString dataTag;
+        qint64 operations = 0;
+        qint64 nsecs = 0;
+        quint64 allocations = 0;
+        quint64 bytesAllocated = 0;
+    };
+
+    static BenchmarkReport &instance();
+
+    void setFixture(const QJsonObject &fixture) { m_fixture = fixture; }
+    void addSample(qint64 operations, qint64 nsecs, quint64 allocations, quint64 bytesAllocated);
+
+    QJsonObject toJson() const;
+    bool write(const QString &filepath, QString *error) const;
+
+private:
+    QJsonObject m_fixture;
+    QList<Result> m_results;
+};
+
+// Measures one pass of a QBENCHMARK loop, which performs 'operations' of the operation being benchmarked.
+class BenchmarkSample
+{
+public:
+    explicit BenchmarkSample(qint64 operations = 1);
+    ~BenchmarkSample();
+
+private:
+    qint64 m_operations;
+    quint64 m_allocations;
+    quint64 m_bytesAllocated;
+    QElapsedTimer m_timer;
+};
+
+#endif // BENCHMARKREPORT_H
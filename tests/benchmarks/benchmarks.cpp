@@ -0,0 +1,446 @@
+#include "benchmarkreport.h"
+#include "allocationcounter.h"
+#include "projectgenerator.h"
+#include "project.h"
+#include "config.h"
+#include "loadingscreen.h"
+#include "layoutpixmapitem.h"
+#include "collisionpixmapitem.h"
+#include "editcommands.h"
+#include "imageproviders.h"
+#include "imageexport.h"
+#include "settings.h"
+
+#include <QtTest>
+#include <QApplication>
+#include <QBuffer>
+#include <QCommandLineParser>
+#include <QTemporaryDir>
+
+// Attaches pixmap items to a layout the way the editor does, so that edits to the layout redraw it.
+class LayoutItems
+{
+public:
+    LayoutItems(Layout *layout, Settings *settings)
+      : m_layout(layout),
+        m_layoutItem(layout, nullptr, settings),
+        m_collisionItem(layout, nullptr, nullptr, nullptr, settings, &m_collisionOpacity)
+    {
+        m_layoutItem.draw(true);
+        m_collisionItem.draw(true);
+    }
+    ~LayoutItems() {
+        m_layout->setLayoutItem(nullptr);
+        m_layout->setCollisionItem(nullptr);
+    }
+    LayoutPixmapItem *layoutItem() { return &m_layoutItem; }
+
+private:
+    Layout *m_layout;
+    qreal m_collisionOpacity = 1.0;
+    LayoutPixmapItem m_layoutItem;
+    CollisionPixmapItem m_collisionItem;
+};
+
+/*
+    Benchmarks for the operations that dominate Porymap's performance with large projects:
+    opening a project, loading maps, rendering layouts and metatiles, editing layouts, and exporting images.
+
+    They run against a synthetic project written by the project generator (see tools/projectgenerator),
+    or against an existing project given with --project.
+*/
+class Benchmarks : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Options {
+        QString projectDir;     // Use this project rather than generating one
+        double scale = 1;
+        quint32 seed = 1;
+    };
+    explicit Benchmarks(const Options &options) : m_options(options) {}
+
+private:
+    Options m_options;
+    QTemporaryDir m_fixtureDir;
+    QString m_root;
+    Project *m_project = nullptr;
+    Layout *m_smallLayout = nullptr;
+    Layout *m_largeLayout = nullptr;
+    Settings m_settings;
+
+    bool loadConfigs();
+    Project *openProject();
+    Layout *loadLayout(bool largest);
+    Layout *layoutForTag();
+    static void addLayoutRows();
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void loadProject();
+    void loadMaps();
+    void loadTileset();
+    void readCDefines();
+    void readCStructs();
+
+    void renderLayout_data() { addLayoutRows(); }
+    void renderLayout();
+    void renderCollision_data() { addLayoutRows(); }
+    void renderCollision();
+    void renderMetatiles();
+
+    void floodFill_data() { addLayoutRows(); }
+    void floodFill();
+    void magicFill_data() { addLayoutRows(); }
+    void magicFill();
+    void paintMetatileUndoRedo_data() { addLayoutRows(); }
+    void paintMetatileUndoRedo();
+
+    void exportLayoutImage_data() { addLayoutRows(); }
+    void exportLayoutImage();
+    void exportTilesImage();
+};
+
+bool Benchmarks::loadConfigs() {
+    return projectConfig.load(m_root) && userConfig.load(m_root);
+}
+
+Project *Benchmarks::openProject() {
+    auto project = new Project;
+    project->setRoot(m_root);
+    if (!project->load()) {
+        delete project;
+        return nullptr;
+    }
+    return project;
+}
+
+// Load either the largest layout in the project, or the first layout with a typical size.
+Layout *Benchmarks::loadLayout(bool largest) {
+    Layout *choice = nullptr;
+    for (const auto &layoutId : m_project->layoutIdsOrdered()) {
+        Layout *layout = m_project->getLayout(layoutId);
+        if (!layout)
+            continue;
+        const int area = layout->getWidth() * layout->getHeight();
+        if (largest) {
+            if (!choice || area > choice->getWidth() * choice->getHeight())
+                choice = layout;
+        } else if (area >= 20 * 20 && area <= 40 * 40) {
+            choice = layout;
+            break;
+        }
+    }
+    return choice ? m_project->loadLayout(choice->id) : nullptr;
+}
+
+void Benchmarks::addLayoutRows() {
+    QTest::addColumn<bool>("largest");
+    QTest::newRow("typical") << false;
+    QTest::newRow("largest") << true;
+}
+
+Layout *Benchmarks::layoutForTag() {
+    QFETCH(bool, largest);
+    return largest ? m_largeLayout : m_smallLayout;
+}
+
+void Benchmarks::initTestCase() {
+    if (m_options.projectDir.isEmpty()) {
+        QVERIFY(m_fixtureDir.isValid());
+        m_root = m_fixtureDir.path();
+
+        ProjectGenerator::Settings settings;
+        settings.scale(m_options.scale);
+        settings.seed = m_options.seed;
+        ProjectGenerator generator(settings);
+        QVERIFY2(generator.generate(m_root), qPrintable(generator.errorString()));
+
+        QJsonObject fixture;
+        fixture["generated"] = true;
+        fixture["scale"] = m_options.scale;
+        fixture["seed"] = static_cast<qint64>(m_options.seed);
+        fixture["maps"] = settings.numMaps;
+        fixture["layouts"] = settings.numLayouts;
+        fixture["secondaryTilesets"] = settings.numSecondaryTilesets;
+        fixture["maxMapSize"] = settings.maxMapSize;
+        fixture["files"] = generator.numFilesWritten();
+        fixture["bytes"] = generator.numBytesWritten();
+        BenchmarkReport::instance().setFixture(fixture);
+    } else {
+        m_root = QDir(m_options.projectDir).absolutePath();
+        QJsonObject fixture;
+        fixture["generated"] = false;
+        fixture["project"] = m_root;
+        BenchmarkReport::instance().setFixture(fixture);
+    }
+
+    QVERIFY(loadConfigs());
+    m_project = openProject();
+    QVERIFY2(m_project, qPrintable(QString("Failed to open project '%1'").arg(m_root)));
+
+    // Layouts must not be unloaded while they're being benchmarked.
+    m_project->blockCacheEviction();
+    m_smallLayout = loadLayout(false);
+    m_largeLayout = loadLayout(true);
+    QVERIFY(m_smallLayout && m_largeLayout);
+}
+
+void Benchmarks::cleanupTestCase() {
+    delete m_project;
+    m_project = nullptr;
+}
+
+void Benchmarks::loadProject() {
+    QBENCHMARK_ONCE {
+        BenchmarkSample sample;
+        Project *project = openProject();
+        QVERIFY(project);
+        delete project;
+    }
+}
+
+// Each map can only be loaded once, so this loads a batch of maps that haven't been loaded yet.
+// Tilesets stay cached between maps, as they would while the user is browsing maps.
+void Benchmarks::loadMaps() {
+    QStringList mapNames;
+    for (const auto &mapName : m_project->mapNames()) {
+        if (!m_project->isLoadedMap(mapName) && !m_project->isErroredMap(mapName))
+            mapNames.append(mapName);
+        if (mapNames.length() >= 100)
+            break;
+    }
+    if (mapNames.isEmpty())
+        QSKIP("Every map has already been loaded.");
+
+    QBENCHMARK_ONCE {
+        BenchmarkSample sample(mapNames.length());
+        for (const auto &mapName : mapNames) {
+            QVERIFY(m_project->loadMap(mapName));
+        }
+    }
+}
+
+void Benchmarks::loadTileset() {
+    const Tileset *tileset = m_largeLayout->tileset_secondary;
+    QVERIFY(tileset);
+    Tileset copy(*tileset);
+    QBENCHMARK {
+        BenchmarkSample sample;
+        QVERIFY(copy.load());
+    }
+}
+
+void Benchmarks::readCDefines() {
+    const QString filepath = projectConfig.getFilePath(ProjectFilePath::constants_flags);
+    const QString prefix = projectConfig.getIdentifier(ProjectIdentifier::regex_flags);
+    QBENCHMARK {
+        BenchmarkSample sample;
+        ParseUtil parser;
+        parser.setRoot(m_root);
+        QString error;
+        const auto defines = parser.readCDefinesByRegex(filepath, {prefix}, &error);
+        QVERIFY2(!defines.isEmpty(), qPrintable(error));
+    }
+}
+
+void Benchmarks::readCStructs() {
+    const QString filepath = projectConfig.getFilePath(ProjectFilePath::tilesets_headers);
+    QBENCHMARK {
+        BenchmarkSample sample;
+        ParseUtil parser;
+        parser.setRoot(m_root);
+        const auto structs = parser.readCStructs(filepath, "", Tileset::getHeaderMemberMap(m_project->usingAsmTilesets));
+        QVERIFY(!structs.isEmpty());
+    }
+}
+
+void Benchmarks::renderLayout() {
+    Layout *layout = layoutForTag();
+    QBENCHMARK {
+        BenchmarkSample sample;
+        layout->render(true);
+    }
+}
+
+void Benchmarks::renderCollision() {
+    Layout *layout = layoutForTag();
+    QBENCHMARK {
+        BenchmarkSample sample;
+        layout->renderCollision(true);
+    }
+}
+
+void Benchmarks::renderMetatiles() {
+    const Tileset *primary = m_largeLayout->tileset_primary;
+    const Tileset *secondary = m_largeLayout->tileset_secondary;
+    QVERIFY(primary && secondary);
+    QList<uint16_t> metatileIds;
+    for (int i = 0; i < primary->numMetatiles(); i++)
+        metatileIds.append(primary->firstMetatileId() + i);
+    for (int i = 0; i < secondary->numMetatiles(); i++)
+        metatileIds.append(secondary->firstMetatileId() + i);
+
+    QBENCHMARK {
+        BenchmarkSample sample(metatileIds.length());
+        for (const auto &metatileId : metatileIds) {
+            getMetatileImage(metatileId, primary, secondary);
+        }
+    }
+}
+
+// Fill the whole layout, alternating between two metatiles so that every fill changes every block.
+// The fills are pushed to the layout's edit history and redrawn, as they are in the editor. The layout's blocks are restored afterwards.
+void Benchmarks::floodFill() {
+    Layout *layout = layoutForTag();
+    const Blockdata original = layout->blockdata;
+    for (int y = 0; y < layout->getHeight(); y++)
+    for (int x = 0; x < layout->getWidth(); x++) {
+        Block block = layout->blockdata.at(y * layout->getWidth() + x);
+        block.setMetatileId(0);
+        layout->setBlock(x, y, block);
+    }
+
+    LayoutItems items(layout, &m_settings);
+    uint16_t metatileId = 0;
+    QBENCHMARK {
+        BenchmarkSample sample;
+        metatileId = (metatileId == 1) ? 2 : 1;
+        items.layoutItem()->floodFill(0, 0, metatileId);
+    }
+    layout->editHistory.clear();
+    layout->setBlockdata(original);
+}
+
+// Magic fill replaces every block using the first block's metatile, the other blocks keep their original metatiles.
+void Benchmarks::magicFill() {
+    Layout *layout = layoutForTag();
+    const Blockdata original = layout->blockdata;
+    Block first;
+    QVERIFY(layout->getBlock(0, 0, &first));
+    const uint16_t originalMetatileId = first.metatileId();
+    const uint16_t otherMetatileId = (originalMetatileId == 1) ? 2 : 1;
+
+    LayoutItems items(layout, &m_settings);
+    bool toggle = false;
+    QBENCHMARK {
+        BenchmarkSample sample;
+        toggle = !toggle;
+        items.layoutItem()->magicFill(0, 0, toggle ? otherMetatileId : originalMetatileId);
+    }
+    layout->editHistory.clear();
+    layout->setBlockdata(original);
+}
+
+// Undo and redo a paint stroke over a 16x16 area, including redrawing the layout and collision items.
+void Benchmarks::paintMetatileUndoRedo() {
+    Layout *layout = layoutForTag();
+    const Blockdata original = layout->blockdata;
+    Blockdata painted = original;
+    for (int y = 0; y < qMin(16, layout->getHeight()); y++)
+    for (int x = 0; x < qMin(16, layout->getWidth()); x++) {
+        Block &block = painted[y * layout->getWidth() + x];
+        block.setMetatileId(block.metatileId() == 1 ? 2 : 1);
+    }
+
+    LayoutItems items(layout, &m_settings);
+    PaintMetatile command(layout, original, painted, 0);
+    QBENCHMARK {
+        BenchmarkSample sample(2);
+        command.redo();
+        command.undo();
+    }
+}
+
+void Benchmarks::exportLayoutImage() {
+    Layout *layout = layoutForTag();
+    QByteArray data;
+    QBENCHMARK {
+        BenchmarkSample sample;
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::WriteOnly | QIODevice::Truncate);
+        QVERIFY(layout->render(true).save(&buffer, "PNG"));
+    }
+}
+
+void Benchmarks::exportTilesImage() {
+    const Tileset *tileset = m_largeLayout->tileset_primary;
+    QVERIFY(tileset);
+    const QImage image(QString("%1/%2").arg(m_root).arg(tileset->tilesImagePath));
+    QVERIFY(!image.isNull());
+    QByteArray data;
+    QBENCHMARK {
+        BenchmarkSample sample;
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::WriteOnly | QIODevice::Truncate);
+        QVERIFY(writeIndexed4BPPPng(image, &buffer));
+    }
+}
+
+int main(int argc, char *argv[]) {
+    // The benchmarks don't show any windows, so they can run on machines without a display.
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QApplication app(argc, argv);
+    QApplication::setApplicationName("porymap-benchmarks");
+    QStandardPaths::setTestModeEnabled(true);
+
+    // Options for the benchmarks are separated from Qt Test's options by '--'.
+    QStringList testArgs = app.arguments();
+    QStringList benchmarkArgs = {testArgs.first()};
+    const int separator = testArgs.indexOf("--");
+    if (separator >= 0) {
+        benchmarkArgs.append(testArgs.mid(separator + 1));
+        testArgs = testArgs.mid(0, separator);
+    }
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Benchmarks Porymap's performance-sensitive operations.\n"
+                                     "Usage: porymap-benchmarks [Qt Test options] [-- options]");
+    const QCommandLineOption jsonOption("json", "Write the results as JSON to <file>.", "file");
+    const QCommandLineOption projectOption("project", "Benchmark an existing project rather than a generated one.", "dir");
+    const QCommandLineOption scaleOption("scale", "Size of the generated project relative to pokeemerald (default 1).", "factor", "1");
+    const QCommandLineOption seedOption("seed", "Seed for the generated project (default 1).", "seed", "1");
+    parser.addOptions({jsonOption, projectOption, scaleOption, seedOption});
+    parser.addHelpOption();
+    parser.process(benchmarkArgs);
+
+    Benchmarks::Options options;
+    options.projectDir = parser.value(projectOption);
+    bool ok;
+    options.scale = parser.value(scaleOption).toDouble(&ok);
+    if (!ok || options.scale <= 0) {
+        qCritical().noquote() << QString("Invalid scale '%1'").arg(parser.value(scaleOption));
+        return 1;
+    }
+    options.seed = parser.value(seedOption).toUInt(&ok);
+    if (!ok) {
+        qCritical().noquote() << QString("Invalid seed '%1'").arg(parser.value(seedOption));
+        return 1;
+    }
+
+    porysplash = new PorymapLoadingScreen;
+
+    int result;
+    {
+        Benchmarks benchmarks(options);
+        result = QTest::qExec(&benchmarks, testArgs);
+    }
+
+    if (parser.isSet(jsonOption)) {
+        QString error;
+        if (!BenchmarkReport::instance().write(parser.value(jsonOption), &error)) {
+            qCritical().noquote() << QString("Failed to write '%1': %2").arg(parser.value(jsonOption)).arg(error);
+            result = 1;
+        }
+    }
+
+    delete porysplash;
+    return result;
+}
+
+#include "benchmarks.moc"
@@ -0,0 +1,27 @@
+#-------------------------------------------------
+#
+# Tests for writing 4bpp indexed PNGs.
+#
+#-------------------------------------------------
+
+QT       += core gui widgets concurrent testlib
+
+TARGET = tst_imageexport
+TEMPLATE = app
+CONFIG += console testcase
+CONFIG -= app_bundle
+QMAKE_CXXFLAGS += -std=c++17 -Wall
+
+!exists($$[QT_INSTALL_HEADERS]/QtZlib/zlib.h): LIBS += -lz
+
+PORYMAP_ROOT = $$PWD/../..
+
+INCLUDEPATH += $$PORYMAP_ROOT/include
+INCLUDEPATH += $$PORYMAP_ROOT/include/core
+
+SOURCES += tst_imageexport.cpp \
+    $$PORYMAP_ROOT/src/core/imageexport.cpp \
+    $$PORYMAP_ROOT/src/log.cpp
+
+HEADERS += $$PORYMAP_ROOT/include/core/imageexport.h \
+    $$PORYMAP_ROOT/include/log.h
@@ -0,0 +1,354 @@
+#include "imageexport.h"
+
+#include <QtTest>
+#include <QBuffer>
+#include <QImageReader>
+#include <QRandomGenerator>
+#include <QTemporaryDir>
+#include <QtEndian>
+
+Q_DECLARE_METATYPE(PngRowFilter)
+
+class TestImageExport : public QObject
+{
+    Q_OBJECT
+
+private:
+    static QImage createIndexedImage(int width, int height, quint32 seed);
+    static QImage readPng(const QByteArray &data, QString *error);
+    static void compareImages(const QImage &actual, const QImage &expected);
+    static QList<QByteArray> readIdatChunks(const QByteArray &png);
+    static QByteArray inflateIdatChunks(const QList<QByteArray> &chunks, int expectedSize);
+
+private slots:
+    void roundTrip_data();
+    void roundTrip();
+    void writesBitDepth4();
+    void rowFilters_data();
+    void rowFilters();
+    void compressionLevels_data();
+    void compressionLevels();
+    void boundsIdatChunks();
+    void convertsNonIndexedImages();
+    void exportsToFile();
+    void rejectsNullImage();
+    void rejectsUnwritableDevice();
+    void benchmarkWrite_data();
+    void benchmarkWrite();
+    void benchmarkFilter_data();
+    void benchmarkFilter();
+};
+
+// An indexed image with a 16-color palette and random pixels.
+QImage TestImageExport::createIndexedImage(int width, int height, quint32 seed) {
+    QRandomGenerator random(seed);
+    QImage image(width, height, QImage::Format_Indexed8);
+    QVector<QRgb> colorTable;
+    for (int i = 0; i < 16; i++) {
+        colorTable.append(qRgb(random.bounded(256), random.bounded(256), random.bounded(256)));
+    }
+    image.setColorTable(colorTable);
+    for (int y = 0; y < height; y++) {
+        uchar *line = image.scanLine(y);
+        for (int x = 0; x < width; x++) {
+            line[x] = random.bounded(16);
+        }
+    }
+    return image;
+}
+
+QImage TestImageExport::readPng(const QByteArray &data, QString *error) {
+    QBuffer buffer;
+    buffer.setData(data);
+    buffer.open(QIODevice::ReadOnly);
+    QImageReader reader(&buffer, "png");
+    const QImage image = reader.read();
+    if (image.isNull() && error) {
+        *error = reader.errorString();
+    }
+    return image;
+}
+
+// Compare the decoded image with the source pixel by pixel. Palette indices and colors must both match.
+void TestImageExport::compareImages(const QImage &actual, const QImage &expected) {
+    QCOMPARE(actual.size(), expected.size());
+    QCOMPARE(actual.format(), QImage::Format_Indexed8);
+    for (int y = 0; y < expected.height(); y++) {
+        for (int x = 0; x < expected.width(); x++) {
+            if (actual.pixelIndex(x, y) != expected.pixelIndex(x, y)) {
+                QFAIL(qPrintable(QString("Pixel (%1, %2) has index %3, expected %4")
+                                    .arg(x).arg(y).arg(actual.pixelIndex(x, y)).arg(expected.pixelIndex(x, y))));
+            }
+            if (actual.pixel(x, y) != expected.pixel(x, y)) {
+                QFAIL(qPrintable(QString("Pixel (%1, %2) has color %3, expected %4")
+                                    .arg(x).arg(y).arg(actual.pixel(x, y), 8, 16).arg(expected.pixel(x, y), 8, 16)));
+            }
+        }
+    }
+}
+
+// The data of each IDAT chunk in the PNG, in order.
+QList<QByteArray> TestImageExport::readIdatChunks(const QByteArray &png) {
+    QList<QByteArray> chunks;
+    int offset = 8; // Skip the signature
+    while (offset + 12 <= png.length()) {
+        const quint32 length = qFromBigEndian<quint32>(png.constData() + offset);
+        if (png.mid(offset + 4, 4) == "IDAT")
+            chunks.append(png.mid(offset + 8, length));
+        offset += 12 + length;
+    }
+    return chunks;
+}
+
+// Decompress the filtered rows from the IDAT chunks. qUncompress expects the zlib stream to be preceded by its decompressed size.
+QByteArray TestImageExport::inflateIdatChunks(const QList<QByteArray> &chunks, int expectedSize) {
+    QByteArray data(4, 0);
+    qToBigEndian<quint32>(expectedSize, data.data());
+    for (const auto &chunk : chunks)
+        data.append(chunk);
+    return qUncompress(data);
+}
+
+void TestImageExport::roundTrip_data() {
+    QTest::addColumn<int>("width");
+    QTest::addColumn<int>("height");
+
+    // Odd widths leave half of the last byte in each row unused.
+    QTest::newRow("1x1") << 1 << 1;
+    QTest::newRow("2x1") << 2 << 1;
+    QTest::newRow("3x5") << 3 << 5;
+    QTest::newRow("7x7") << 7 << 7;
+    QTest::newRow("8x8") << 8 << 8;
+    QTest::newRow("33x17") << 33 << 17;
+    QTest::newRow("128x512 (tileset)") << 128 << 512;
+    QTest::newRow("255x3") << 255 << 3;
+    // Large enough for the compressed data to span several IDAT chunks.
+    QTest::newRow("1025x1023") << 1025 << 1023;
+}
+
+void TestImageExport::roundTrip() {
+    QFETCH(int, width);
+    QFETCH(int, height);
+
+    const QImage source = createIndexedImage(width, height, width * 1000 + height);
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    QString error;
+    QVERIFY2(writeIndexed4BPPPng(source, &buffer, -1, PngRowFilter::None, &error), qPrintable(error));
+
+    const QImage decoded = readPng(buffer.data(), &error);
+    QVERIFY2(!decoded.isNull(), qPrintable(error));
+    compareImages(decoded, source);
+}
+
+void TestImageExport::writesBitDepth4() {
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    QVERIFY(writeIndexed4BPPPng(createIndexedImage(16, 16, 1), &buffer));
+
+    // The IHDR chunk immediately follows the 8-byte signature, and its data starts after the chunk's length and type.
+    const QByteArray data = buffer.data();
+    QVERIFY(data.length() > 26);
+    QCOMPARE(data.mid(12, 4), QByteArray("IHDR"));
+    QCOMPARE(static_cast<int>(data.at(24)), 4); // bit depth
+    QCOMPARE(static_cast<int>(data.at(25)), 3); // indexed color type
+}
+
+void TestImageExport::rowFilters_data() {
+    QTest::addColumn<PngRowFilter>("filter");
+    QTest::addColumn<int>("width");
+    QTest::addColumn<int>("height");
+
+    const QList<QPair<QString, PngRowFilter>> filters = {
+        {"none", PngRowFilter::None},
+        {"sub", PngRowFilter::Sub},
+        {"up", PngRowFilter::Up},
+        {"average", PngRowFilter::Average},
+        {"paeth", PngRowFilter::Paeth},
+        {"adaptive", PngRowFilter::Adaptive},
+    };
+    for (const auto &filter : filters) {
+        QTest::newRow(qPrintable(filter.first + " 1x1")) << filter.second << 1 << 1;
+        QTest::newRow(qPrintable(filter.first + " 33x17")) << filter.second << 33 << 17;
+        QTest::newRow(qPrintable(filter.first + " 1025x300")) << filter.second << 1025 << 300;
+    }
+}
+
+// Each filter must decode to the same pixels, and every row must be written with the requested filter type.
+void TestImageExport::rowFilters() {
+    QFETCH(PngRowFilter, filter);
+    QFETCH(int, width);
+    QFETCH(int, height);
+
+    const QImage source = createIndexedImage(width, height, width + height);
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    QString error;
+    QVERIFY2(writeIndexed4BPPPng(source, &buffer, -1, filter, &error), qPrintable(error));
+
+    const QImage decoded = readPng(buffer.data(), &error);
+    QVERIFY2(!decoded.isNull(), qPrintable(error));
+    compareImages(decoded, source);
+
+    const int filteredRowLength = (width + 1) / 2 + 1;
+    const QByteArray rows = inflateIdatChunks(readIdatChunks(buffer.data()), filteredRowLength * height);
+    QCOMPARE(rows.length(), filteredRowLength * height);
+    for (int y = 0; y < height; y++) {
+        const int type = static_cast<uchar>(rows.at(y * filteredRowLength));
+        if (filter == PngRowFilter::Adaptive) {
+            QVERIFY(type <= static_cast<int>(PngRowFilter::Paeth));
+        } else {
+            QCOMPARE(type, static_cast<int>(filter));
+        }
+    }
+}
+
+void TestImageExport::compressionLevels_data() {
+    QTest::addColumn<int>("level");
+
+    QTest::newRow("default") << -1;
+    for (int level = 0; level <= 9; level++) {
+        QTest::newRow(qPrintable(QString("level %1").arg(level))) << level;
+    }
+    // Levels outside 0-9 are clamped.
+    QTest::newRow("too low") << -5;
+    QTest::newRow("too high") << 20;
+}
+
+void TestImageExport::compressionLevels() {
+    QFETCH(int, level);
+
+    const QImage source = createIndexedImage(257, 129, 6);
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    QString error;
+    QVERIFY2(writeIndexed4BPPPng(source, &buffer, level, PngRowFilter::None, &error), qPrintable(error));
+
+    const QImage decoded = readPng(buffer.data(), &error);
+    QVERIFY2(!decoded.isNull(), qPrintable(error));
+    compareImages(decoded, source);
+
+    // Level 0 stores the data without compressing it, so it's larger than the filtered rows.
+    if (level == 0) {
+        int idatSize = 0;
+        for (const auto &chunk : readIdatChunks(buffer.data()))
+            idatSize += chunk.length();
+        QVERIFY(idatSize > ((257 + 1) / 2 + 1) * 129);
+    }
+}
+
+// Compressed data is written as it's produced, in IDAT chunks of at most 64 KiB.
+void TestImageExport::boundsIdatChunks() {
+    const QImage source = createIndexedImage(2048, 2048, 7);
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    QVERIFY(writeIndexed4BPPPng(source, &buffer, 0));
+
+    const QList<QByteArray> chunks = readIdatChunks(buffer.data());
+    QVERIFY(chunks.length() > 1);
+    for (const auto &chunk : chunks) {
+        QVERIFY(chunk.length() > 0);
+        QVERIFY(chunk.length() <= 0x10000);
+    }
+    QString error;
+    const QImage decoded = readPng(buffer.data(), &error);
+    QVERIFY2(!decoded.isNull(), qPrintable(error));
+    compareImages(decoded, source);
+}
+
+void TestImageExport::convertsNonIndexedImages() {
+    const QImage indexed = createIndexedImage(17, 9, 2);
+    const QImage rgb = indexed.convertToFormat(QImage::Format_RGB32);
+
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    QString error;
+    QVERIFY2(writeIndexed4BPPPng(rgb, &buffer, -1, PngRowFilter::None, &error), qPrintable(error));
+
+    // Converting may reorder the palette, so only the colors are compared.
+    const QImage decoded = readPng(buffer.data(), &error);
+    QVERIFY2(!decoded.isNull(), qPrintable(error));
+    QCOMPARE(decoded.size(), rgb.size());
+    for (int y = 0; y < rgb.height(); y++) {
+        for (int x = 0; x < rgb.width(); x++) {
+            QCOMPARE(decoded.pixel(x, y), rgb.pixel(x, y));
+        }
+    }
+}
+
+void TestImageExport::exportsToFile() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString filepath = dir.filePath("tiles.png");
+    const QImage source = createIndexedImage(129, 64, 3);
+
+    exportIndexed4BPPPng(source, filepath);
+
+    QImageReader reader(filepath);
+    const QImage decoded = reader.read();
+    QVERIFY2(!decoded.isNull(), qPrintable(reader.errorString()));
+    compareImages(decoded, source);
+}
+
+void TestImageExport::rejectsNullImage() {
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    QString error;
+    QVERIFY(!writeIndexed4BPPPng(QImage(), &buffer, -1, PngRowFilter::None, &error));
+    QVERIFY(!error.isEmpty());
+    QCOMPARE(buffer.size(), 0);
+}
+
+void TestImageExport::rejectsUnwritableDevice() {
+    QBuffer buffer;
+    buffer.open(QIODevice::ReadOnly);
+    QString error;
+    QVERIFY(!writeIndexed4BPPPng(createIndexedImage(8, 8, 4), &buffer, -1, PngRowFilter::None, &error));
+    QVERIFY(!error.isEmpty());
+}
+
+void TestImageExport::benchmarkWrite_data() {
+    QTest::addColumn<int>("width");
+    QTest::addColumn<int>("height");
+
+    QTest::newRow("tileset (128x512)") << 128 << 512;
+    QTest::newRow("large tileset (128x2048)") << 128 << 2048;
+    QTest::newRow("map-sized (2048x2048)") << 2048 << 2048;
+}
+
+void TestImageExport::benchmarkWrite() {
+    QFETCH(int, width);
+    QFETCH(int, height);
+
+    const QImage source = createIndexedImage(width, height, 5);
+    QByteArray data;
+    data.reserve(width * height);
+    QBENCHMARK {
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::WriteOnly | QIODevice::Truncate);
+        writeIndexed4BPPPng(source, &buffer);
+    }
+}
+
+void TestImageExport::benchmarkFilter_data() {
+    QTest::addColumn<PngRowFilter>("filter");
+
+    QTest::newRow("none") << PngRowFilter::None;
+    QTest::newRow("paeth") << PngRowFilter::Paeth;
+    QTest::newRow("adaptive") << PngRowFilter::Adaptive;
+}
+
+void TestImageExport::benchmarkFilter() {
+    QFETCH(PngRowFilter, filter);
+
+    const QImage source = createIndexedImage(128, 2048, 8);
+    QByteArray data;
+    QBENCHMARK {
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::WriteOnly | QIODevice::Truncate);
+        writeIndexed4BPPPng(source, &buffer, -1, filter);
+    }
+}
+
+QTEST_MAIN(TestImageExport)
+#include "tst_imageexport.moc"
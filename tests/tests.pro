@@ -0,0 +1,9 @@
+#-------------------------------------------------
+#
+# Porymap's tests. These are built separately from porymap, e.g. 'qmake tests && make && make check'
+#
+#-------------------------------------------------
+
+TEMPLATE = subdirs
+
+SUBDIRS += imageexport
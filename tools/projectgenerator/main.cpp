@@ -0,0 +1,84 @@
+#include "projectgenerator.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTextStream>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("porymap-projectgen");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Writes a synthetic pokeemerald-style project for testing porymap with large projects.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("output", "Directory to write the project to.");
+
+    const QCommandLineOption scaleOption("scale", "Size of the project relative to pokeemerald (default 10).", "factor", "10");
+    const QCommandLineOption seedOption("seed", "Seed for the random contents (default 1).", "seed", "1");
+    const QCommandLineOption mapsOption("maps", "Number of maps, overriding --scale.", "count");
+    const QCommandLineOption layoutsOption("layouts", "Number of layouts, overriding --scale.", "count");
+    const QCommandLineOption tilesetsOption("tilesets", "Number of secondary tilesets, overriding --scale.", "count");
+    const QCommandLineOption flagsOption("flags", "Number of flags, overriding --scale.", "count");
+    const QCommandLineOption maxMapSizeOption("max-map-size", "Largest map width/height in metatiles (default 80).", "size");
+    parser.addOptions({scaleOption, seedOption, mapsOption, layoutsOption, tilesetsOption, flagsOption, maxMapSizeOption});
+    parser.process(app);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    const QStringList args = parser.positionalArguments();
+    if (args.length() != 1) {
+        parser.showHelp(1);
+    }
+
+    bool ok;
+    ProjectGenerator::Settings settings;
+    const double scale = parser.value(scaleOption).toDouble(&ok);
+    if (!ok || scale <= 0) {
+        err << "Invalid scale '" << parser.value(scaleOption) << "'\n";
+        return 1;
+    }
+    settings.scale(scale);
+    settings.seed = parser.value(seedOption).toUInt(&ok);
+    if (!ok) {
+        err << "Invalid seed '" << parser.value(seedOption) << "'\n";
+        return 1;
+    }
+
+    auto readCount = [&](const QCommandLineOption &option, int *value) {
+        if (!parser.isSet(option))
+            return true;
+        bool valid;
+        const int count = parser.value(option).toInt(&valid);
+        if (!valid || count < 1) {
+            err << "Invalid value for --" << option.names().first() << ": '" << parser.value(option) << "'\n";
+            return false;
+        }
+        *value = count;
+        return true;
+    };
+    if (!readCount(mapsOption, &settings.numMaps)
+     || !readCount(layoutsOption, &settings.numLayouts)
+     || !readCount(tilesetsOption, &settings.numSecondaryTilesets)
+     || !readCount(flagsOption, &settings.numFlags)
+     || !readCount(maxMapSizeOption, &settings.maxMapSize))
+        return 1;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    ProjectGenerator generator(settings);
+    if (!generator.generate(args.first())) {
+        err << generator.errorString() << "\n";
+        return 1;
+    }
+
+    out << QString("Wrote %1 files (%2 MiB) to '%3' in %4 s\n")
+            .arg(generator.numFilesWritten())
+            .arg(generator.numBytesWritten() / (1024.0 * 1024.0), 0, 'f', 1)
+            .arg(args.first())
+            .arg(timer.elapsed() / 1000.0, 0, 'f', 1);
+    return 0;
+}
@@ -0,0 +1,678 @@
+#include "projectgenerator.h"
+
+#include <QColor>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QImage>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSize>
+#include <QtEndian>
+#include <cmath>
+
+static int scaled(int value, double factor) {
+    return qMax(1, static_cast<int>(std::lround(value * factor)));
+}
+
+void ProjectGenerator::Settings::scale(double factor) {
+    this->numMaps = scaled(this->numMaps, factor);
+    this->numLayouts = scaled(this->numLayouts, factor);
+    this->numPrimaryTilesets = scaled(this->numPrimaryTilesets, factor);
+    this->numSecondaryTilesets = scaled(this->numSecondaryTilesets, factor);
+    this->numMapSections = scaled(this->numMapSections, factor);
+    this->numFlags = scaled(this->numFlags, factor);
+    this->numVars = scaled(this->numVars, factor);
+    this->numItems = scaled(this->numItems, factor);
+    this->numSpecies = scaled(this->numSpecies, factor);
+    this->numSongs = scaled(this->numSongs, factor);
+    this->numObjEventGfx = scaled(this->numObjEventGfx, factor);
+    this->numCommonScriptFiles = scaled(this->numCommonScriptFiles, factor);
+}
+
+ProjectGenerator::ProjectGenerator(const Settings &settings) :
+    m_settings(settings),
+    m_random(settings.seed)
+{
+    m_settings.numLayouts = qBound(1, m_settings.numLayouts, qMax(1, m_settings.numMaps));
+    m_settings.mapsPerGroup = qMax(1, m_settings.mapsPerGroup);
+    m_settings.minMapSize = qMax(1, m_settings.minMapSize);
+    m_settings.maxMapSize = qMax(m_settings.minMapSize, m_settings.maxMapSize);
+    m_settings.numPrimaryTilesets = qMax(1, m_settings.numPrimaryTilesets);
+    m_settings.numSecondaryTilesets = qMax(1, m_settings.numSecondaryTilesets);
+    m_settings.numMapSections = qMax(1, m_settings.numMapSections);
+}
+
+bool ProjectGenerator::writeFile(const QString &path, const QByteArray &data) {
+    const QString filepath = QString("%1/%2").arg(m_root).arg(path);
+    const QString dir = QFileInfo(filepath).absolutePath();
+    if (!QDir().mkpath(dir)) {
+        m_error = QString("Failed to create directory '%1'").arg(dir);
+        return false;
+    }
+
+    QFile file(filepath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        m_error = QString("Failed to open '%1' for writing: %2").arg(filepath).arg(file.errorString());
+        return false;
+    }
+    if (file.write(data) != data.size()) {
+        m_error = QString("Failed to write '%1': %2").arg(filepath).arg(file.errorString());
+        return false;
+    }
+    m_numFilesWritten++;
+    m_numBytesWritten += data.size();
+    return true;
+}
+
+// e.g. 'gTileset_SynthSecondary12' -> 'synth_secondary12'
+QString ProjectGenerator::tilesetDirName(const QString &label) {
+    QString name = label.mid(QString("gTileset_").length());
+    QString dirName;
+    for (int i = 0; i < name.length(); i++) {
+        if (name.at(i).isUpper() && i > 0)
+            dirName.append('_');
+        dirName.append(name.at(i).toLower());
+    }
+    return dirName;
+}
+
+QString ProjectGenerator::tilesetDir(const QString &label, bool secondary) {
+    return QString("data/tilesets/%1/%2").arg(secondary ? "secondary" : "primary").arg(tilesetDirName(label));
+}
+
+bool ProjectGenerator::generate(const QString &root) {
+    m_root = root;
+    m_error.clear();
+    m_numFilesWritten = 0;
+    m_numBytesWritten = 0;
+
+    if (!QDir().mkpath(m_root)) {
+        m_error = QString("Failed to create directory '%1'").arg(m_root);
+        return false;
+    }
+
+    planMaps();
+    return writeConfig()
+        && writeConstants()
+        && writeTilesets()
+        && writeLayouts()
+        && writeMapGroups()
+        && writeMaps()
+        && writeRegionMapSections()
+        && writeHealLocations()
+        && writeWildEncounters()
+        && writeCommonScripts();
+}
+
+// Decide the names, layouts, and positions of every map up front, so that maps can refer to each other.
+void ProjectGenerator::planMaps() {
+    m_maps.clear();
+    m_groups.clear();
+
+    // Maps in each group are arranged in a grid, and connected to their neighbors.
+    const int gridWidth = qMax(1, static_cast<int>(std::ceil(std::sqrt(m_settings.mapsPerGroup))));
+
+    QList<QSize> layoutSizes;
+    for (int i = 0; i < m_settings.numLayouts; i++) {
+        layoutSizes.append(QSize(randomInt(m_settings.minMapSize, m_settings.maxMapSize),
+                                 randomInt(m_settings.minMapSize, m_settings.maxMapSize)));
+    }
+
+    for (int i = 0; i < m_settings.numMaps; i++) {
+        const int groupIndex = i / m_settings.mapsPerGroup;
+        const int indexInGroup = i % m_settings.mapsPerGroup;
+        if (indexInGroup == 0)
+            m_groups.append(QString("gMapGroup_Synth%1").arg(groupIndex));
+
+        MapInfo map;
+        map.index = i;
+        map.name = QString("Synth_%1").arg(i, 5, 10, QLatin1Char('0'));
+        map.constant = QString("MAP_SYNTH_%1").arg(i, 5, 10, QLatin1Char('0'));
+        const int layoutIndex = i % m_settings.numLayouts;
+        map.layoutId = QString("LAYOUT_SYNTH_%1").arg(layoutIndex, 5, 10, QLatin1Char('0'));
+        map.group = m_groups.last();
+        map.width = layoutSizes.at(layoutIndex).width();
+        map.height = layoutSizes.at(layoutIndex).height();
+        map.gridX = indexInGroup % gridWidth;
+        map.gridY = indexInGroup / gridWidth;
+        m_maps.append(map);
+    }
+}
+
+bool ProjectGenerator::writeConfig() {
+    return writeTextFile("porymap.project.cfg", "base_game_version=pokeemerald\n");
+}
+
+// Writes a header of #defines. Half of the values are written as expressions to exercise the parser's evaluation.
+QString ProjectGenerator::defines(const QString &guard, const QStringList &names, int start, bool useExpressions) {
+    QString text = QString("#ifndef GUARD_%1_H\n#define GUARD_%1_H\n\n").arg(guard);
+    const QString baseName = QString("%1_START").arg(guard);
+    if (useExpressions)
+        text.append(QString("#define %1 0x%2\n\n").arg(baseName).arg(start, 0, 16));
+    for (int i = 0; i < names.length(); i++) {
+        if (useExpressions && (i % 2)) {
+            text.append(QString("#define %1 (%2 + 0x%3)\n").arg(names.at(i)).arg(baseName).arg(i, 0, 16));
+        } else {
+            text.append(QString("#define %1 0x%2\n").arg(names.at(i)).arg(start + i, 0, 16));
+        }
+    }
+    text.append(QString("\n#endif // GUARD_%1_H\n").arg(guard));
+    return text;
+}
+
+static QStringList numberedNames(const QString &prefix, int count, const QStringList &first = QStringList()) {
+    QStringList names = first;
+    for (int i = 0; i < count; i++) {
+        names.append(QString("%1%2").arg(prefix).arg(i));
+    }
+    return names;
+}
+
+bool ProjectGenerator::writeConstants() {
+    m_flags = numberedNames("FLAG_SYNTH_", m_settings.numFlags);
+    m_vars = numberedNames("VAR_SYNTH_", m_settings.numVars);
+    m_items = numberedNames("ITEM_SYNTH_", m_settings.numItems, {"ITEM_NONE"});
+    m_species = numberedNames("SPECIES_SYNTH_", m_settings.numSpecies, {"SPECIES_NONE"});
+    m_songs = numberedNames("MUS_SYNTH_", m_settings.numSongs);
+    m_objEventGfx = numberedNames("OBJ_EVENT_GFX_SYNTH_", m_settings.numObjEventGfx);
+    m_mapSections = numberedNames("MAPSEC_SYNTH_", m_settings.numMapSections);
+    m_weathers = {"WEATHER_NONE", "WEATHER_SUNNY_CLOUDS", "WEATHER_SUNNY", "WEATHER_RAIN", "WEATHER_SNOW", "WEATHER_FOG_HORIZONTAL"};
+    m_mapTypes = {"MAP_TYPE_NONE", "MAP_TYPE_TOWN", "MAP_TYPE_CITY", "MAP_TYPE_ROUTE", "MAP_TYPE_UNDERGROUND", "MAP_TYPE_INDOOR"};
+    m_battleScenes = {"MAP_BATTLE_SCENE_NORMAL", "MAP_BATTLE_SCENE_GYM", "MAP_BATTLE_SCENE_MAGMA", "MAP_BATTLE_SCENE_AQUA"};
+    m_movementTypes = {"MOVEMENT_TYPE_NONE", "MOVEMENT_TYPE_LOOK_AROUND", "MOVEMENT_TYPE_WANDER_AROUND", "MOVEMENT_TYPE_FACE_UP",
+                       "MOVEMENT_TYPE_FACE_DOWN", "MOVEMENT_TYPE_FACE_LEFT", "MOVEMENT_TYPE_FACE_RIGHT"};
+
+    const QStringList facingDirections = {"BG_EVENT_PLAYER_FACING_ANY", "BG_EVENT_PLAYER_FACING_NORTH", "BG_EVENT_PLAYER_FACING_SOUTH",
+                                          "BG_EVENT_PLAYER_FACING_EAST", "BG_EVENT_PLAYER_FACING_WEST"};
+    const QStringList trainerTypes = {"TRAINER_TYPE_NONE", "TRAINER_TYPE_NORMAL", "TRAINER_TYPE_SEE_ALL_DIRECTIONS", "TRAINER_TYPE_BURIED"};
+    const QStringList coordWeathers = {"COORD_EVENT_WEATHER_SUNNY_CLOUDS", "COORD_EVENT_WEATHER_SUNNY", "COORD_EVENT_WEATHER_RAIN"};
+    const QStringList behaviors = numberedNames("MB_SYNTH_", numBehaviors - 1, {"MB_NORMAL"});
+
+    // The largest map's data (including the area around it) has to fit in MAX_MAP_DATA_SIZE.
+    const int maxMapDataSize = (m_settings.maxMapSize + 15) * (m_settings.maxMapSize + 14);
+
+    const QString fieldmap = QString(
+        "#ifndef GUARD_FIELDMAP_H\n#define GUARD_FIELDMAP_H\n\n"
+        "#define NUM_TILES_IN_PRIMARY %1\n"
+        "#define NUM_TILES_TOTAL %2\n"
+        "#define NUM_METATILES_IN_PRIMARY %3\n"
+        "#define NUM_METATILES_TOTAL %4\n"
+        "#define NUM_PALS_IN_PRIMARY %5\n"
+        "#define NUM_PALS_TOTAL %6\n"
+        "#define MAX_MAP_DATA_SIZE %7\n\n"
+        "#define NUM_TILES_PER_METATILE 8\n\n"
+        "#define MAP_OFFSET 7\n"
+        "#define MAP_OFFSET_W (MAP_OFFSET * 2 + 1)\n"
+        "#define MAP_OFFSET_H (MAP_OFFSET * 2)\n\n"
+        "#endif // GUARD_FIELDMAP_H\n")
+        .arg(numTilesPrimary).arg(numTilesPrimary * 2)
+        .arg(numMetatilesPrimary).arg(numMetatilesPrimary * 2)
+        .arg(numPalettesPrimary).arg(numPalettesTotal)
+        .arg(maxMapDataSize);
+
+    const QString globalFieldmap =
+        "#ifndef GUARD_GLOBAL_FIELDMAP_H\n#define GUARD_GLOBAL_FIELDMAP_H\n\n"
+        "#define MAPGRID_METATILE_ID_MASK 0x03FF\n"
+        "#define MAPGRID_COLLISION_MASK   0x0C00\n"
+        "#define MAPGRID_ELEVATION_MASK   0xF000\n\n"
+        "#define METATILE_ATTR_BEHAVIOR_MASK 0x00FF\n"
+        "#define METATILE_ATTR_LAYER_MASK    0xF000\n\n"
+        "#endif // GUARD_GLOBAL_FIELDMAP_H\n";
+
+    return writeTextFile("include/fieldmap.h", fieldmap)
+        && writeTextFile("include/global.fieldmap.h", globalFieldmap)
+        && writeTextFile("include/constants/global.h", "#define OBJECT_EVENT_TEMPLATES_COUNT 64\n")
+        && writeTextFile("include/constants/pokemon.h", "#define MIN_LEVEL 1\n#define MAX_LEVEL 100\n")
+        && writeTextFile("src/wild_encounter.c", "#define MAX_ENCOUNTER_RATE 2880\n")
+        && writeTextFile("include/constants/flags.h", defines("FLAGS", m_flags, 0x20, true))
+        && writeTextFile("include/constants/vars.h", defines("VARS", m_vars, 0x4000, true))
+        && writeTextFile("include/constants/items.h", defines("ITEMS", m_items, 0))
+        && writeTextFile("include/constants/species.h", defines("SPECIES", m_species, 0))
+        && writeTextFile("include/constants/songs.h", defines("SONGS", m_songs, 0x15E))
+        && writeTextFile("include/constants/event_objects.h", defines("EVENT_OBJECTS", m_objEventGfx, 0))
+        && writeTextFile("include/constants/event_object_movement.h", defines("EVENT_OBJECT_MOVEMENT", m_movementTypes, 0))
+        && writeTextFile("include/constants/trainer_types.h", defines("TRAINER_TYPES", trainerTypes, 0))
+        && writeTextFile("include/constants/event_bg.h", defines("EVENT_BG", facingDirections, 0))
+        && writeTextFile("include/constants/metatile_behaviors.h", defines("METATILE_BEHAVIORS", behaviors, 0))
+        && writeTextFile("include/constants/map_types.h", defines("MAP_TYPES", m_mapTypes, 0) + defines("BATTLE_SCENES", m_battleScenes, 0))
+        && writeTextFile("include/constants/weather.h", defines("WEATHER", m_weathers, 0) + defines("COORD_EVENT_WEATHER", coordWeathers, 1));
+}
+
+bool ProjectGenerator::writeTilesets() {
+    m_primaryTilesets = numberedNames("gTileset_SynthPrimary", m_settings.numPrimaryTilesets);
+    m_secondaryTilesets = numberedNames("gTileset_SynthSecondary", m_settings.numSecondaryTilesets);
+
+    QString headers;
+    QString graphics;
+    QString metatiles;
+    auto appendTileset = [&](const QString &label, bool secondary) {
+        const QString name = label.mid(QString("gTileset_").length());
+        const QString dir = tilesetDir(label, secondary);
+        headers.append(QString("const struct Tileset %1 =\n{\n"
+                               "    .isCompressed = TRUE,\n"
+                               "    .isSecondary = %2,\n"
+                               "    .tiles = gTilesetTiles_%3,\n"
+                               "    .palettes = gTilesetPalettes_%3,\n"
+                               "    .metatiles = gMetatiles_%3,\n"
+                               "    .metatileAttributes = gMetatileAttributes_%3,\n"
+                               "    .callback = NULL,\n"
+                               "};\n\n").arg(label).arg(secondary ? "TRUE" : "FALSE").arg(name));
+
+        graphics.append(QString("const u32 gTilesetTiles_%1[] = INCBIN_U32(\"%2/tiles.4bpp.lz\");\n\n").arg(name).arg(dir));
+        graphics.append(QString("const u16 gTilesetPalettes_%1[][16] =\n{\n").arg(name));
+        for (int i = 0; i < 16; i++) {
+            graphics.append(QString("    INCBIN_U16(\"%1/palettes/%2.gbapal\"),\n").arg(dir).arg(i, 2, 10, QLatin1Char('0')));
+        }
+        graphics.append("};\n\n");
+
+        metatiles.append(QString("const u16 gMetatiles_%1[] = INCBIN_U16(\"%2/metatiles.bin\");\n").arg(name).arg(dir));
+        metatiles.append(QString("const u16 gMetatileAttributes_%1[] = INCBIN_U16(\"%2/metatile_attributes.bin\");\n\n").arg(name).arg(dir));
+    };
+
+    for (int i = 0; i < m_primaryTilesets.length(); i++) {
+        appendTileset(m_primaryTilesets.at(i), false);
+        if (!writeTileset(m_primaryTilesets.at(i), false, i))
+            return false;
+    }
+    for (int i = 0; i < m_secondaryTilesets.length(); i++) {
+        appendTileset(m_secondaryTilesets.at(i), true);
+        if (!writeTileset(m_secondaryTilesets.at(i), true, i))
+            return false;
+    }
+
+    return writeTextFile("src/data/tilesets/headers.h", headers)
+        && writeTextFile("src/data/tilesets/graphics.h", graphics)
+        && writeTextFile("src/data/tilesets/metatiles.h", metatiles);
+}
+
+// Writes a tileset with a full sheet of tiles and metatiles.
+bool ProjectGenerator::writeTileset(const QString &label, bool secondary, int index) {
+    const QString dir = tilesetDir(label, secondary);
+
+    // Tiles image. Each tile is a simple pattern of two colors so that the rendered maps have some detail.
+    const int numTiles = numTilesPrimary;
+    QImage tiles(16 * 8, (numTiles / 16) * 8, QImage::Format_Indexed8);
+    QVector<QRgb> grayscale;
+    for (int i = 0; i < 16; i++) {
+        grayscale.append(qRgb(i * 16, i * 16, i * 16));
+    }
+    tiles.setColorTable(grayscale);
+    for (int tile = 0; tile < numTiles; tile++) {
+        const int colorA = randomInt(1, 15);
+        const int colorB = randomInt(1, 15);
+        const int pattern = m_random.bounded(4);
+        const int tileX = (tile % 16) * 8;
+        const int tileY = (tile / 16) * 8;
+        for (int y = 0; y < 8; y++)
+        for (int x = 0; x < 8; x++) {
+            bool useA;
+            switch (pattern) {
+            case 0:  useA = ((x + y) % 2) == 0; break;
+            case 1:  useA = x < 4; break;
+            case 2:  useA = (x * x + y * y) < 25; break;
+            default: useA = ((x / 2 + y / 2) % 2) == 0; break;
+            }
+            tiles.setPixel(tileX + x, tileY + y, useA ? colorA : colorB);
+        }
+    }
+    const QString tilesPath = QString("%1/%2/tiles.png").arg(m_root).arg(dir);
+    if (!QDir().mkpath(QFileInfo(tilesPath).absolutePath()) || !tiles.save(tilesPath, "PNG")) {
+        m_error = QString("Failed to write '%1'").arg(tilesPath);
+        return false;
+    }
+    m_numFilesWritten++;
+
+    // Palettes, in JASC format. Each tileset gets its own hue so they're easy to tell apart.
+    for (int palette = 0; palette < 16; palette++) {
+        QString text = "JASC-PAL\r\n0100\r\n16\r\n";
+        const int hue = (index * 37 + palette * 23) % 360;
+        for (int i = 0; i < 16; i++) {
+            const QColor color = QColor::fromHsv(hue, 40 + i * 12, 40 + i * 13);
+            // Colors are stored in 15-bit on the GBA.
+            text.append(QString("%1 %2 %3\r\n").arg(color.red() & 0xF8).arg(color.green() & 0xF8).arg(color.blue() & 0xF8));
+        }
+        if (!writeTextFile(QString("%1/palettes/%2.pal").arg(dir).arg(palette, 2, 10, QLatin1Char('0')), text))
+            return false;
+    }
+
+    // Metatiles. Secondary tilesets use tiles and palettes from both the primary and secondary tilesets.
+    const int tileIdOffset = secondary ? numTilesPrimary : 0;
+    const int maxPalette = secondary ? numPalettesTotal - 1 : numPalettesPrimary - 1;
+    QByteArray metatiles;
+    QByteArray attributes;
+    for (int i = 0; i < numMetatilesPrimary; i++) {
+        for (int j = 0; j < 8; j++) {
+            int tileId = randomInt(0, numTiles - 1);
+            if (!secondary || randomChance(70))
+                tileId += tileIdOffset;
+            const quint16 tile = tileId
+                               | (randomChance(10) ? (1 << 10) : 0)  // xflip
+                               | (randomChance(10) ? (1 << 11) : 0)  // yflip
+                               | (randomInt(0, maxPalette) << 12);
+            const quint16 value = qToLittleEndian(tile);
+            metatiles.append(reinterpret_cast<const char*>(&value), sizeof(value));
+        }
+        const quint16 behavior = randomChance(80) ? 0 : randomInt(1, numBehaviors - 1);
+        const quint16 layerType = randomInt(0, 2);
+        const quint16 attribute = qToLittleEndian(static_cast<quint16>(behavior | (layerType << 12)));
+        attributes.append(reinterpret_cast<const char*>(&attribute), sizeof(attribute));
+    }
+
+    return writeFile(dir + "/metatiles.bin", metatiles)
+        && writeFile(dir + "/metatile_attributes.bin", attributes);
+}
+
+static QByteArray blockdata(QRandomGenerator &random, int width, int height) {
+    // Regions of similar metatiles, so the maps look somewhat like real maps rather than noise.
+    QByteArray data;
+    data.reserve(width * height * 2);
+    const int regionSize = 6;
+    for (int y = 0; y < height; y++)
+    for (int x = 0; x < width; x++) {
+        const int region = (x / regionSize) * 31 + (y / regionSize) * 17;
+        const bool useSecondary = (region % 3) == 0;
+        quint16 metatileId = (region * 7 + random.bounded(4)) % 512;
+        if (useSecondary)
+            metatileId += 512;
+        const quint16 collision = (random.bounded(100) < 15) ? 1 : 0;
+        const quint16 elevation = 3;
+        const quint16 block = qToLittleEndian(static_cast<quint16>(metatileId | (collision << 10) | (elevation << 12)));
+        data.append(reinterpret_cast<const char*>(&block), sizeof(block));
+    }
+    return data;
+}
+
+bool ProjectGenerator::writeLayouts() {
+    QJsonArray layouts;
+    for (int i = 0; i < m_settings.numLayouts && i < m_maps.length(); i++) {
+        const MapInfo &map = m_maps.at(i);
+        const QString dir = QString("data/layouts/%1").arg(map.name);
+
+        QJsonObject layout;
+        layout["id"] = map.layoutId;
+        layout["name"] = QString("%1_Layout").arg(map.name);
+        layout["width"] = map.width;
+        layout["height"] = map.height;
+        layout["primary_tileset"] = m_primaryTilesets.at(i % m_primaryTilesets.length());
+        layout["secondary_tileset"] = m_secondaryTilesets.at(i % m_secondaryTilesets.length());
+        layout["border_filepath"] = dir + "/border.bin";
+        layout["blockdata_filepath"] = dir + "/map.bin";
+        layouts.append(layout);
+
+        if (!writeFile(dir + "/map.bin", blockdata(m_random, map.width, map.height))
+         || !writeFile(dir + "/border.bin", blockdata(m_random, 2, 2)))
+            return false;
+    }
+
+    QJsonObject root;
+    root["layouts_table_label"] = "gMapLayouts";
+    root["layouts"] = layouts;
+    return writeFile("data/layouts/layouts.json", QJsonDocument(root).toJson());
+}
+
+bool ProjectGenerator::writeMapGroups() {
+    QJsonObject root;
+    QJsonArray groupOrder;
+    for (const auto &group : m_groups) {
+        groupOrder.append(group);
+    }
+    root["group_order"] = groupOrder;
+
+    QHash<QString, QJsonArray> groupMaps;
+    for (const auto &map : m_maps) {
+        groupMaps[map.group].append(map.name);
+    }
+    for (const auto &group : m_groups) {
+        root[group] = groupMaps.value(group);
+    }
+    return writeFile("data/maps/map_groups.json", QJsonDocument(root).toJson());
+}
+
+bool ProjectGenerator::writeMaps() {
+    QString eventScripts;
+    for (const auto &map : m_maps) {
+        if (!writeMap(map))
+            return false;
+        eventScripts.append(QString("\t.include \"data/maps/%1/scripts.inc\"\n").arg(map.name));
+    }
+    return writeTextFile("data/event_scripts.s", eventScripts);
+}
+
+bool ProjectGenerator::writeMap(const MapInfo &map) {
+    QString scripts = QString("%1_MapScripts::\n\t.byte 0\n\n").arg(map.name);
+    int numScripts = 0;
+    auto newScript = [&]() {
+        const QString label = QString("%1_EventScript_%2").arg(map.name).arg(numScripts);
+        const QString textLabel = QString("%1_Text_%2").arg(map.name).arg(numScripts);
+        scripts.append(QString("%1::\n\tlock\n\tfaceplayer\n\tmsgbox %2, MSGBOX_DEFAULT\n\trelease\n\tend\n\n").arg(label).arg(textLabel));
+        scripts.append(QString("%1:\n\t.string \"This is message %2 of %3.\\n\"\n\t.string \"It exists to make the scripts file larger.$\"\n\n")
+                        .arg(textLabel).arg(numScripts).arg(map.name));
+        numScripts++;
+        return label;
+    };
+    auto randomPosition = [&](QJsonObject *event) {
+        (*event)["x"] = randomInt(0, map.width - 1);
+        (*event)["y"] = randomInt(0, map.height - 1);
+        (*event)["elevation"] = 3;
+    };
+
+    QJsonObject obj;
+    obj["id"] = map.constant;
+    obj["name"] = map.name;
+    obj["layout"] = map.layoutId;
+    obj["music"] = pick(m_songs);
+    obj["region_map_section"] = m_mapSections.at(m_groups.indexOf(map.group) % m_mapSections.length());
+    obj["requires_flash"] = false;
+    obj["weather"] = pick(m_weathers);
+    obj["map_type"] = pick(m_mapTypes);
+    obj["allow_cycling"] = true;
+    obj["allow_escaping"] = false;
+    obj["allow_running"] = true;
+    obj["show_map_name"] = true;
+    obj["battle_scene"] = pick(m_battleScenes);
+
+    // Connect each map to its right and bottom neighbors in the group's grid (and they connect back).
+    const int gridWidth = qMax(1, static_cast<int>(std::ceil(std::sqrt(m_settings.mapsPerGroup))));
+    const int mapIndex = map.index;
+    QJsonArray connections;
+    auto addConnection = [&](int neighborIndex, const QString &direction) {
+        if (neighborIndex < 0 || neighborIndex >= m_maps.length() || m_maps.at(neighborIndex).group != map.group)
+            return;
+        QJsonObject connection;
+        connection["map"] = m_maps.at(neighborIndex).constant;
+        connection["offset"] = 0;
+        connection["direction"] = direction;
+        connections.append(connection);
+    };
+    if (map.gridX + 1 < gridWidth) addConnection(mapIndex + 1, "right");
+    if (map.gridX > 0)             addConnection(mapIndex - 1, "left");
+    addConnection(mapIndex + gridWidth, "down");
+    if (map.gridY > 0)             addConnection(mapIndex - gridWidth, "up");
+    obj["connections"] = connections;
+
+    QJsonArray objects;
+    for (int i = 0; i < m_settings.objectEventsPerMap; i++) {
+        QJsonObject event;
+        event["type"] = "object";
+        event["graphics_id"] = pick(m_objEventGfx);
+        randomPosition(&event);
+        event["movement_type"] = pick(m_movementTypes);
+        event["movement_range_x"] = randomInt(0, 3);
+        event["movement_range_y"] = randomInt(0, 3);
+        event["trainer_type"] = "TRAINER_TYPE_NONE";
+        event["trainer_sight_or_berry_tree_id"] = "0";
+        event["script"] = newScript();
+        event["flag"] = randomChance(30) ? pick(m_flags) : QString("0");
+        objects.append(event);
+    }
+    obj["object_events"] = objects;
+
+    QJsonArray warps;
+    for (int i = 0; i < m_settings.warpsPerMap; i++) {
+        QJsonObject event;
+        randomPosition(&event);
+        event["dest_map"] = pick(m_maps).constant;
+        event["dest_warp_id"] = QString::number(randomInt(0, qMax(0, m_settings.warpsPerMap - 1)));
+        warps.append(event);
+    }
+    obj["warp_events"] = warps;
+
+    QJsonArray triggers;
+    for (int i = 0; i < m_settings.triggersPerMap; i++) {
+        QJsonObject event;
+        event["type"] = "trigger";
+        randomPosition(&event);
+        event["var"] = pick(m_vars);
+        event["var_value"] = QString::number(randomInt(0, 5));
+        event["script"] = newScript();
+        triggers.append(event);
+    }
+    obj["coord_events"] = triggers;
+
+    QJsonArray signs;
+    for (int i = 0; i < m_settings.signsPerMap; i++) {
+        QJsonObject event;
+        if (randomChance(25)) {
+            event["type"] = "hidden_item";
+            randomPosition(&event);
+            event["item"] = pick(m_items);
+            event["flag"] = pick(m_flags);
+        } else {
+            event["type"] = "sign";
+            randomPosition(&event);
+            event["player_facing_dir"] = "BG_EVENT_PLAYER_FACING_ANY";
+            event["script"] = newScript();
+        }
+        signs.append(event);
+    }
+    obj["bg_events"] = signs;
+
+    const QString dir = QString("data/maps/%1").arg(map.name);
+    return writeFile(dir + "/map.json", QJsonDocument(obj).toJson())
+        && writeTextFile(dir + "/scripts.inc", scripts);
+}
+
+bool ProjectGenerator::writeRegionMapSections() {
+    QJsonArray sections;
+    for (int i = 0; i < m_mapSections.length(); i++) {
+        QJsonObject section;
+        section["id"] = m_mapSections.at(i);
+        section["name"] = QString("SYNTH %1").arg(i);
+        section["x"] = i % 28;
+        section["y"] = (i / 28) % 15;
+        section["width"] = 1;
+        section["height"] = 1;
+        sections.append(section);
+    }
+    QJsonObject root;
+    root["map_sections"] = sections;
+    return writeFile("src/data/region_map/region_map_sections.json", QJsonDocument(root).toJson());
+}
+
+// The first map of each group gets a heal location.
+bool ProjectGenerator::writeHealLocations() {
+    QJsonArray healLocations;
+    for (const auto &map : m_maps) {
+        if (map.gridX != 0 || map.gridY != 0)
+            continue;
+        QJsonObject healLocation;
+        healLocation["id"] = QString("HEAL_LOCATION_%1").arg(map.constant.mid(4));
+        healLocation["map"] = map.constant;
+        healLocation["x"] = map.width / 2;
+        healLocation["y"] = map.height / 2;
+        healLocation["respawn_map"] = map.constant;
+        healLocation["respawn_npc"] = "1";
+        healLocations.append(healLocation);
+    }
+    QJsonObject root;
+    root["heal_locations"] = healLocations;
+    return writeFile("src/data/heal_locations.json", QJsonDocument(root).toJson());
+}
+
+bool ProjectGenerator::writeWildEncounters() {
+    struct Field {
+        QString name;
+        QList<int> rates;
+    };
+    const QList<Field> fields = {
+        {"land_mons",       {20, 20, 10, 10, 10, 10, 5, 5, 4, 4, 1, 1}},
+        {"water_mons",      {60, 30, 5, 4, 1}},
+        {"rock_smash_mons", {60, 30, 5, 4, 1}},
+        {"fishing_mons",    {70, 30, 60, 20, 20, 40, 40, 15, 4, 1}},
+    };
+
+    QJsonArray fieldsJson;
+    for (const auto &field : fields) {
+        QJsonObject fieldJson;
+        fieldJson["type"] = field.name;
+        QJsonArray rates;
+        for (const auto &rate : field.rates) {
+            rates.append(rate);
+        }
+        fieldJson["encounter_rates"] = rates;
+        if (field.name == "fishing_mons") {
+            QJsonObject groups;
+            groups["old_rod"] = QJsonArray{0, 1};
+            groups["good_rod"] = QJsonArray{2, 3, 4};
+            groups["super_rod"] = QJsonArray{5, 6, 7, 8, 9};
+            fieldJson["groups"] = groups;
+        }
+        fieldsJson.append(fieldJson);
+    }
+
+    QJsonArray encounters;
+    for (const auto &map : m_maps) {
+        if (!randomChance(m_settings.wildEncounterPercent))
+            continue;
+        QJsonObject encounter;
+        encounter["map"] = map.constant;
+        encounter["base_label"] = QString("g%1").arg(map.name);
+        for (const auto &field : fields) {
+            if (field.name != "land_mons" && !randomChance(40))
+                continue;
+            QJsonArray mons;
+            for (int i = 0; i < field.rates.length(); i++) {
+                const int level = randomInt(2, 60);
+                QJsonObject mon;
+                mon["min_level"] = level;
+                mon["max_level"] = level + randomInt(0, 5);
+                mon["species"] = m_species.at(randomInt(1, m_species.length() - 1));
+                mons.append(mon);
+            }
+            QJsonObject fieldJson;
+            fieldJson["encounter_rate"] = randomInt(1, 30);
+            fieldJson["mons"] = mons;
+            encounter[field.name] = fieldJson;
+        }
+        encounters.append(encounter);
+    }
+
+    QJsonObject group;
+    group["label"] = "gWildMonHeaders";
+    group["for_maps"] = true;
+    group["fields"] = fieldsJson;
+    group["encounters"] = encounters;
+
+    QJsonObject root;
+    root["wild_encounter_groups"] = QJsonArray{group};
+    return writeFile("src/data/wild_encounters.json", QJsonDocument(root).toJson());
+}
+
+bool ProjectGenerator::writeCommonScripts() {
+    for (int i = 0; i < m_settings.numCommonScriptFiles; i++) {
+        QString text;
+        for (int j = 0; j < m_settings.labelsPerCommonScriptFile; j++) {
+            text.append(QString("Common_EventScript_Synth%1_%2::\n\tsetflag %3\n\tsetvar %4, %5\n\treturn\n\n")
+                            .arg(i).arg(j)
+                            .arg(pick(m_flags))
+                            .arg(pick(m_vars))
+                            .arg(j));
+        }
+        if (!writeTextFile(QString("data/scripts/synth_%1.inc").arg(i), text))
+            return false;
+    }
+    return true;
+}
@@ -0,0 +1,125 @@
+#pragma once
+#ifndef PROJECTGENERATOR_H
+#define PROJECTGENERATOR_H
+
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QRandomGenerator>
+
+/*
+    ProjectGenerator writes a synthetic pokeemerald-style project that porymap can open.
+
+    The project's contents are random but reproducible: the same settings and seed always produce the same project.
+    Its size is configured relative to pokeemerald, so a scale of 10 produces a project with roughly 10 times
+    as many maps, layouts, tilesets, constants, and scripts.
+*/
+class ProjectGenerator
+{
+public:
+    struct Settings {
+        int numMaps = 518;
+        int mapsPerGroup = 30;
+        int numLayouts = 442;           // Maps beyond this number share layouts
+        int minMapSize = 10;            // Dimensions in metatiles
+        int maxMapSize = 80;
+        int numPrimaryTilesets = 2;
+        int numSecondaryTilesets = 70;
+        int numMapSections = 213;
+        int numFlags = 2400;
+        int numVars = 256;
+        int numItems = 377;
+        int numSpecies = 412;
+        int numSongs = 600;
+        int numObjEventGfx = 239;
+        int numCommonScriptFiles = 20;
+        int labelsPerCommonScriptFile = 100;
+        int objectEventsPerMap = 8;
+        int warpsPerMap = 4;
+        int triggersPerMap = 2;
+        int signsPerMap = 3;
+        int wildEncounterPercent = 50;  // Percentage of maps with wild encounters
+        quint32 seed = 1;
+
+        // Multiplies the pokeemerald-sized defaults above (except for per-map counts and sizes).
+        void scale(double factor);
+    };
+
+    explicit ProjectGenerator(const Settings &settings);
+
+    bool generate(const QString &root);
+    QString errorString() const { return m_error; }
+    int numFilesWritten() const { return m_numFilesWritten; }
+    qint64 numBytesWritten() const { return m_numBytesWritten; }
+
+private:
+    struct MapInfo {
+        int index = 0;
+        QString name;
+        QString constant;
+        QString layoutId;
+        QString group;
+        int width = 0;
+        int height = 0;
+        int gridX = 0;
+        int gridY = 0;
+    };
+
+    Settings m_settings;
+    QRandomGenerator m_random;
+    QString m_root;
+    QString m_error;
+    int m_numFilesWritten = 0;
+    qint64 m_numBytesWritten = 0;
+
+    QList<MapInfo> m_maps;
+    QStringList m_groups;
+    QStringList m_primaryTilesets;
+    QStringList m_secondaryTilesets;
+
+    QStringList m_flags;
+    QStringList m_vars;
+    QStringList m_items;
+    QStringList m_species;
+    QStringList m_songs;
+    QStringList m_objEventGfx;
+    QStringList m_mapSections;
+    QStringList m_weathers;
+    QStringList m_mapTypes;
+    QStringList m_battleScenes;
+    QStringList m_movementTypes;
+
+    static const int numTilesPrimary = 512;
+    static const int numMetatilesPrimary = 512;
+    static const int numPalettesPrimary = 6;
+    static const int numPalettesTotal = 13;
+    static const int numBehaviors = 0xF0;
+
+    bool writeFile(const QString &path, const QByteArray &data);
+    bool writeTextFile(const QString &path, const QString &text) { return writeFile(path, text.toUtf8()); }
+    int randomInt(int min, int max) { return m_random.bounded(min, max + 1); }
+    bool randomChance(int percent) { return m_random.bounded(100) < percent; }
+    template <typename T>
+    const T &pick(const QList<T> &list) { return list.at(m_random.bounded(list.size())); }
+
+    QString defines(const QString &guard, const QStringList &names, int start, bool useExpressions = false);
+
+    void planMaps();
+    bool writeConfig();
+    bool writeConstants();
+    bool writeTilesets();
+    bool writeTileset(const QString &label, bool secondary, int index);
+    bool writeLayouts();
+    bool writeMaps();
+    bool writeMap(const MapInfo &map);
+    bool writeMapGroups();
+    bool writeRegionMapSections();
+    bool writeHealLocations();
+    bool writeWildEncounters();
+    bool writeCommonScripts();
+
+    static QString tilesetDirName(const QString &label);
+    static QString tilesetDir(const QString &label, bool secondary);
+};
+
+#endif // PROJECTGENERATOR_H
@@ -0,0 +1,20 @@
+#-------------------------------------------------
+#
+# Generates large synthetic decomp projects for testing porymap's performance.
+# This is built separately from porymap, e.g. 'qmake tools/projectgenerator && make'
+#
+#-------------------------------------------------
+
+QT       += core gui
+QT       -= widgets
+
+TARGET = porymap-projectgen
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+QMAKE_CXXFLAGS += -std=c++17 -Wall
+
+SOURCES += main.cpp \
+    projectgenerator.cpp
+
+HEADERS += projectgenerator.h